@@ -58,6 +58,7 @@ struct xdr_enum_entry {
 struct xdr_struct_member {
     struct xdr_type          *type;
     char                     *name;
+    int                       hash;  /* %xdrzcc hash: store a hash of the value when decoded */
     struct xdr_struct_member *prev;
     struct xdr_struct_member *next;
 };
@@ -65,6 +66,8 @@ struct xdr_struct_member {
 struct xdr_struct {
     char                     *name;
     int                       linkedlist;
+    int                       table;  /* coded by the table-driven interpreter (-t, -T) */
+    int                       message; /* program argument or result, or named by -M */
     const char               *nextmember;
     struct xdr_struct_member *members;
     struct xdr_struct        *prev;
@@ -87,6 +90,7 @@ struct xdr_union {
     struct xdr_union_case *cases;
     struct xdr_union_case *default_case;
     int                    opaque;  /* opaque_union: length prefix for wire compatibility */
+    int                    message; /* program argument or result, or named by -M */
     struct xdr_union      *prev;
     struct xdr_union      *next;
 
@@ -59,6 +59,7 @@ void yyerror(const char *s) {
 %token VOID STRING OPAQUE ZCOPAQUE UNION OPAQUE_UNION SWITCH CASE DEFAULT CONST
 %token LBRACE RBRACE LPAREN RPAREN SEMICOLON COLON EQUALS
 %token LBRACKET RBRACKET STAR LANGLE RANGLE COMMA PROGRAM VERSION
+%token PRAGMA_HASH
 
 %type <xdr_struct> struct_def
 %type <xdr_struct_member> struct_member struct_body
@@ -286,7 +287,12 @@ struct_body:
     ;
 
 struct_member:
-    type IDENTIFIER SEMICOLON
+    PRAGMA_HASH struct_member
+    {
+        $$ = $2;
+        $$->hash = 1;
+    }
+    | type IDENTIFIER SEMICOLON
     {
         $$ = xdr_alloc(sizeof(*$$));
         $$->type = $1;
@@ -23,12 +23,17 @@
 #define unlikely(x) __builtin_expect(!!(x), 0)
 #define FORCE_INLINE __attribute__((always_inline)) inline
 
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(XDR_SIMD_DISABLE)
+#define XDR_SIMD_X86 1
+#include <immintrin.h>
+#endif /* if (defined(__x86_64__) || defined(__i386__)) && !defined(XDR_SIMD_DISABLE) */
+
 static FORCE_INLINE int WARN_UNUSED_RESULT
 xdr_iovec_add_offset(
     xdr_iovec *iov,
     int        offset)
 {
-    if (unlikely(xdr_iovec_len(iov) <= offset)) {
+    if (unlikely(xdr_iovec_len(iov) <= (uint32_t) offset)) {
         return -1;
     }
 
@@ -84,95 +89,276 @@ xdr_pad(uint32_t length)
     return (4 - (length & 0x3)) & 0x3;
 } /* xdr_pad */
 
-struct xdr_read_cursor {
-    xdr_iovec                   *cur;
-    xdr_iovec                   *last;
-    unsigned int                 iov_offset;
-    unsigned int                 offset;
-    struct evpl_rpc2_rdma_chunk *read_chunk;
-};
+/*
+ * Bulk byte-swap kernels used for arrays and vectors of 4 and 8 byte
+ * scalars.  The widest implementation supported by the running CPU is
+ * selected on first use, with a portable scalar loop as the fallback.
+ */
 
-struct xdr_write_cursor {
-    xdr_iovec                   *iov;
-    int                          niov;
-    int                          maxiov;
-    xdr_iovec                   *scratch_iov;
-    void                        *scratch_data;
-    int                          scratch_size;
-    int                          scratch_used;
-    int                          scratch_reserved;
-    int                          total;
-    struct evpl_rpc2_rdma_chunk *rdma_chunk;
-};
+#define XDR_SIMD_UNKNOWN 0
+#define XDR_SIMD_SCALAR  1
+#define XDR_SIMD_SSE41   2
+#define XDR_SIMD_AVX2    3
+#define XDR_SIMD_AVX512  4
+
+static int xdr_simd_level = XDR_SIMD_UNKNOWN;
+
+static inline int
+xdr_simd_detect(void)
+{
+    int level = __atomic_load_n(&xdr_simd_level, __ATOMIC_RELAXED);
+
+    if (level != XDR_SIMD_UNKNOWN) {
+        return level;
+    }
+
+    level = XDR_SIMD_SCALAR;
+
+#ifdef XDR_SIMD_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512bw")) {
+        level = XDR_SIMD_AVX512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        level = XDR_SIMD_AVX2;
+    } else if (__builtin_cpu_supports("sse4.1")) {
+        level = XDR_SIMD_SSE41;
+    }
+#endif /* ifdef XDR_SIMD_X86 */
+
+    __atomic_store_n(&xdr_simd_level, level, __ATOMIC_RELAXED);
+
+    return level;
+} /* xdr_simd_detect */
 
 static FORCE_INLINE void
-xdr_read_cursor_vector_init(
-    struct xdr_read_cursor      *cursor,
-    xdr_iovec                   *iov,
-    int                          niov,
-    struct evpl_rpc2_rdma_chunk *read_chunk)
+xdr_bswap32_copy_scalar(
+    void       *dst,
+    const void *src,
+    uint32_t    n)
 {
-    cursor->cur        = iov;
-    cursor->last       = iov + (niov - 1);
-    cursor->iov_offset = 0;
-    cursor->offset     = 0;
-    cursor->read_chunk = read_chunk;
-} /* xdr_read_cursor_vector_init */
+    uint32_t i, v;
+
+    for (i = 0; i < n; i++) {
+        memcpy(&v, (const char *) src + (i << 2), 4);
+        v = __builtin_bswap32(v);
+        memcpy((char *) dst + (i << 2), &v, 4);
+    }
+} /* xdr_bswap32_copy_scalar */
 
 static FORCE_INLINE void
-xdr_write_cursor_init(
-    struct xdr_write_cursor     *cursor,
-    xdr_iovec                   *scratch_iov,
-    xdr_iovec                   *out_iov,
-    int                          out_niov,
-    struct evpl_rpc2_rdma_chunk *rdma_chunk,
-    int                          out_offset)
-{
-    cursor->iov              = out_iov;
-    cursor->niov             = 0;
-    cursor->maxiov           = out_niov;
-    cursor->scratch_iov      = scratch_iov;
-    cursor->rdma_chunk       = rdma_chunk;
-    cursor->scratch_used     = out_offset;
-    cursor->scratch_reserved = out_offset;
-    cursor->scratch_data     = xdr_iovec_data(scratch_iov);
-    cursor->scratch_size     = xdr_iovec_len(scratch_iov);
-
-    xdr_iovec_set_len(scratch_iov, 0);
-
-    cursor->total = 0;
-
-} /* xdr_write_cursor_init */
+xdr_bswap64_copy_scalar(
+    void       *dst,
+    const void *src,
+    uint32_t    n)
+{
+    uint32_t i;
+    uint64_t v;
 
-static FORCE_INLINE int WARN_UNUSED_RESULT
-xdr_write_cursor_flush(struct xdr_write_cursor *cursor)
+    for (i = 0; i < n; i++) {
+        memcpy(&v, (const char *) src + (i << 3), 8);
+        v = __builtin_bswap64(v);
+        memcpy((char *) dst + (i << 3), &v, 8);
+    }
+} /* xdr_bswap64_copy_scalar */
+
+#ifdef XDR_SIMD_X86
+
+#define XDR_BSWAP32_SHUFFLE 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+#define XDR_BSWAP64_SHUFFLE 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+
+__attribute__((target("sse4.1"))) static void
+xdr_bswap_copy_sse41(
+    void       *dst,
+    const void *src,
+    uint32_t    bytes,
+    __m128i     mask)
 {
-    xdr_iovec *iov;
+    uint32_t i;
+    __m128i  v;
 
-    if (cursor->scratch_used) {
+    for (i = 0; i + 16 <= bytes; i += 16) {
+        v = _mm_loadu_si128((const __m128i *) ((const char *) src + i));
+        _mm_storeu_si128((__m128i *) ((char *) dst + i), _mm_shuffle_epi8(v, mask));
+    }
+} /* xdr_bswap_copy_sse41 */
+
+__attribute__((target("avx2"))) static void
+xdr_bswap_copy_avx2(
+    void       *dst,
+    const void *src,
+    uint32_t    bytes,
+    __m128i     mask)
+{
+    uint32_t i;
+    __m256i  v, mask256 = _mm256_broadcastsi128_si256(mask);
 
-        if (unlikely(cursor->niov + 1 > cursor->maxiov)) {
-            return -1;
-        }
+    for (i = 0; i + 32 <= bytes; i += 32) {
+        v = _mm256_loadu_si256((const __m256i *) ((const char *) src + i));
+        _mm256_storeu_si256((__m256i *) ((char *) dst + i), _mm256_shuffle_epi8(v, mask256));
+    }
 
-        iov = &cursor->iov[cursor->niov++];
+    for (; i + 16 <= bytes; i += 16) {
+        _mm_storeu_si128((__m128i *) ((char *) dst + i),
+                         _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) ((const char *) src + i)), mask));
+    }
+} /* xdr_bswap_copy_avx2 */
+
+__attribute__((target("avx512f,avx512bw"))) static void
+xdr_bswap_copy_avx512(
+    void       *dst,
+    const void *src,
+    uint32_t    bytes,
+    __m128i     mask)
+{
+    uint32_t i;
+    __m512i  v, mask512;
+
+    /*
+     * The unmasked _mm512_broadcast_i32x4() merges into an
+     * uninitialized vector, which trips -Werror=uninitialized when
+     * this file is built as optimized C++; the zero-masked form with
+     * every lane selected produces the same broadcast without it.
+     */
+    mask512 = _mm512_maskz_broadcast_i32x4(0xffff, mask);
+
+    for (i = 0; i + 64 <= bytes; i += 64) {
+        v = _mm512_loadu_si512((const void *) ((const char *) src + i));
+        _mm512_storeu_si512((void *) ((char *) dst + i), _mm512_shuffle_epi8(v, mask512));
+    }
+
+    for (; i + 16 <= bytes; i += 16) {
+        _mm_storeu_si128((__m128i *) ((char *) dst + i),
+                         _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) ((const char *) src + i)), mask));
+    }
+} /* xdr_bswap_copy_avx512 */
+
+/*
+ * Runs the widest available kernel over the 16 byte aligned prefix
+ * of the input and returns the number of bytes it converted.
+ */
+static inline uint32_t
+xdr_bswap_copy_simd(
+    void       *dst,
+    const void *src,
+    uint32_t    bytes,
+    __m128i     mask)
+{
+    switch (xdr_simd_detect()) {
+        case XDR_SIMD_AVX512:
+            xdr_bswap_copy_avx512(dst, src, bytes, mask);
+            break;
+        case XDR_SIMD_AVX2:
+            xdr_bswap_copy_avx2(dst, src, bytes, mask);
+            break;
+        case XDR_SIMD_SSE41:
+            xdr_bswap_copy_sse41(dst, src, bytes, mask);
+            break;
+        default:
+            return 0;
+    } /* switch */
 
-        xdr_iovec_copy_private(iov, cursor->scratch_iov);
-        xdr_iovec_set_data(iov, cursor->scratch_data);
-        xdr_iovec_set_len(iov, cursor->scratch_used);
+    return bytes & ~15U;
+} /* xdr_bswap_copy_simd */
 
-        xdr_iovec_set_len(cursor->scratch_iov, xdr_iovec_len(cursor->scratch_iov) + cursor->scratch_used);
+#endif /* ifdef XDR_SIMD_X86 */
+
+static inline void
+xdr_bswap32_copy(
+    void       *dst,
+    const void *src,
+    uint32_t    n)
+{
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+    uint32_t done = 0;
 
-        cursor->scratch_data += cursor->scratch_used;
-        cursor->scratch_size -= cursor->scratch_used;
-        cursor->total        += cursor->scratch_used;
-        cursor->scratch_used  = 0;
+#ifdef XDR_SIMD_X86
+    if (n >= 8) {
+        done = xdr_bswap_copy_simd(dst, src, n << 2,
+                                   _mm_setr_epi8(XDR_BSWAP32_SHUFFLE)) >> 2;
     }
+#endif /* ifdef XDR_SIMD_X86 */
 
-    return 0;
-} /* xdr_write_cursor_flush */
+    xdr_bswap32_copy_scalar((char *) dst + (done << 2),
+                            (const char *) src + (done << 2),
+                            n - done);
+#else  /* if __BYTE_ORDER == __LITTLE_ENDIAN */
+    memcpy(dst, src, (size_t) n << 2);
+#endif /* if __BYTE_ORDER == __LITTLE_ENDIAN */
+} /* xdr_bswap32_copy */
 
-static inline int
+static inline void
+xdr_bswap64_copy(
+    void       *dst,
+    const void *src,
+    uint32_t    n)
+{
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+    uint32_t done = 0;
+
+#ifdef XDR_SIMD_X86
+    if (n >= 4) {
+        done = xdr_bswap_copy_simd(dst, src, n << 3,
+                                   _mm_setr_epi8(XDR_BSWAP64_SHUFFLE)) >> 3;
+    }
+#endif /* ifdef XDR_SIMD_X86 */
+
+    xdr_bswap64_copy_scalar((char *) dst + (done << 3),
+                            (const char *) src + (done << 3),
+                            n - done);
+#else  /* if __BYTE_ORDER == __LITTLE_ENDIAN */
+    memcpy(dst, src, (size_t) n << 3);
+#endif /* if __BYTE_ORDER == __LITTLE_ENDIAN */
+} /* xdr_bswap64_copy */
+
+/*
+ * Copy n elements of the given width between host and wire order.
+ * Floating point values are carried in native format (see README),
+ * so only the integer types request a swap.
+ */
+static FORCE_INLINE void
+xdr_bulk_copy(
+    void       *dst,
+    const void *src,
+    uint32_t    n,
+    uint32_t    width,
+    int         swap)
+{
+    if (!swap) {
+        memcpy(dst, src, (size_t) n * width);
+    } else if (width == 4) {
+        xdr_bswap32_copy(dst, src, n);
+    } else {
+        xdr_bswap64_copy(dst, src, n);
+    }
+} /* xdr_bulk_copy */
+
+/*
+ * The vector read cursor never moves past the last iovec.  Once the
+ * current segment is exhausted it is advanced eagerly, so that the
+ * bytes of cursor->cur up to cursor->end always describe the next
+ * bytes of the stream and the contig primitives can be used whenever
+ * a field fits within them.
+ */
+static FORCE_INLINE void
+xdr_read_cursor_vector_consume(
+    struct xdr_read_cursor *cursor,
+    unsigned int            bytes)
+{
+    cursor->iov_offset += bytes;
+    cursor->offset     += bytes;
+
+    if (cursor->iov_offset == cursor->end) {
+        (void) xdr_read_cursor_vector_next(cursor);
+    }
+} /* xdr_read_cursor_vector_consume */
+
+/*
+ * Gather a value that straddles segments.  Values that fit the current
+ * segment are read in place by the callers, so this is out of line to
+ * keep the unmarshall_X vector path compact.
+ */
+static __attribute__((noinline, cold, unused)) int
 xdr_read_cursor_vector_extract(
     struct xdr_read_cursor *cursor,
     void                   *out,
@@ -183,11 +369,15 @@ xdr_read_cursor_vector_extract(
     left = bytes;
 
     while (left) {
-        if (unlikely(cursor->cur > cursor->last)) {
-            return -1;
+        chunk = cursor->end - cursor->iov_offset;
+
+        if (chunk == 0) {
+            if (unlikely(xdr_read_cursor_vector_next(cursor) < 0)) {
+                return -1;
+            }
+            continue;
         }
 
-        chunk = xdr_iovec_len(cursor->cur) - cursor->iov_offset;
         if (left < chunk) {
             chunk = left;
         }
@@ -196,27 +386,60 @@ xdr_read_cursor_vector_extract(
                xdr_iovec_data(cursor->cur) + cursor->iov_offset,
                chunk);
 
-        left               -= chunk;
-        out                 = (char *) out + chunk;
-        cursor->iov_offset += chunk;
-        cursor->offset     += chunk;
+        left -= chunk;
+        out   = (char *) out + chunk;
 
-        if (cursor->iov_offset == xdr_iovec_len(cursor->cur)) {
-            cursor->cur++;
-            cursor->iov_offset = 0;
-        }
+        xdr_read_cursor_vector_consume(cursor, chunk);
     }
 
     return bytes;
 } /* xdr_read_cursor_vector_extract */
 
+/*
+ * Copy up to bytes from the cursor, stopping early at the end of the
+ * data available.  Returns the number of bytes copied.
+ */
+static inline unsigned int
+xdr_read_cursor_vector_extract_partial(
+    struct xdr_read_cursor *cursor,
+    void                   *out,
+    unsigned int            bytes)
+{
+    unsigned int done = 0, chunk;
+
+    while (done < bytes) {
+        chunk = cursor->end - cursor->iov_offset;
+
+        if (chunk == 0) {
+            if (xdr_read_cursor_vector_next(cursor) < 0) {
+                break;
+            }
+            continue;
+        }
+
+        if (chunk > bytes - done) {
+            chunk = bytes - done;
+        }
+
+        memcpy((char *) out + done,
+               xdr_iovec_data(cursor->cur) + cursor->iov_offset,
+               chunk);
+
+        done += chunk;
+
+        xdr_read_cursor_vector_consume(cursor, chunk);
+    }
+
+    return done;
+} /* xdr_read_cursor_vector_extract_partial */
+
 static inline int WARN_UNUSED_RESULT
 xdr_write_cursor_append(
     struct xdr_write_cursor *cursor,
     const void              *in,
     unsigned int             bytes)
 {
-    if (unlikely(cursor->scratch_used + bytes > cursor->scratch_size)) {
+    if (unlikely(xdr_write_cursor_reserve(cursor, bytes) < 0)) {
         return -1;
     }
 
@@ -226,54 +449,147 @@ xdr_write_cursor_append(
     return 0;
 } /* xdr_write_cursor_append */
 
-static inline int
-xdr_read_cursor_vector_skip(
+static __attribute__((noinline, cold, unused)) int
+xdr_read_cursor_vector_skip_split(
     struct xdr_read_cursor *cursor,
     unsigned int            bytes)
 {
-    unsigned int done, chunk;
+    unsigned int left, chunk;
 
-    if (cursor->iov_offset + bytes <= xdr_iovec_len(cursor->cur)) {
-        cursor->iov_offset += bytes;
-        cursor->offset     += bytes;
-    } else {
-        done = 0;
-        while (done < bytes) {
-            chunk = xdr_iovec_len(cursor->cur) - cursor->iov_offset;
-            if (chunk > bytes - done) {
-                chunk = bytes - done;
-            }
+    left = bytes;
 
-            done               += chunk;
-            cursor->iov_offset += chunk;
-            cursor->offset     += chunk;
+    while (left) {
+        chunk = cursor->end - cursor->iov_offset;
 
-            if (done < bytes && cursor->cur == cursor->last) {
+        if (chunk == 0) {
+            if (unlikely(xdr_read_cursor_vector_next(cursor) < 0)) {
                 return -1;
             }
+            continue;
+        }
 
-            if (cursor->iov_offset == xdr_iovec_len(cursor->cur)) {
-                cursor->cur++;
-                cursor->iov_offset = 0;
-            }
+        if (chunk > left) {
+            chunk = left;
         }
+
+        left -= chunk;
+
+        xdr_read_cursor_vector_consume(cursor, chunk);
+    }
+
+    return bytes;
+} /* xdr_read_cursor_vector_skip_split */
+
+static FORCE_INLINE int
+xdr_read_cursor_vector_skip(
+    struct xdr_read_cursor *cursor,
+    unsigned int            bytes)
+{
+    if (unlikely(cursor->iov_offset + bytes >= cursor->end)) {
+        return xdr_read_cursor_vector_skip_split(cursor, bytes);
     }
 
+    cursor->iov_offset += bytes;
+    cursor->offset     += bytes;
+
     return bytes;
 } /* xdr_read_cursor_vector_skip */
 
-static FORCE_INLINE void
-xdr_read_cursor_contig_init(
-    struct xdr_read_cursor      *cursor,
-    xdr_iovec                   *iov,
-    struct evpl_rpc2_rdma_chunk *read_chunk)
+/*
+ * Number of segments the next bytes of the stream are spread over,
+ * used to size zero-copy iovec arrays.  Fragment boundaries can split
+ * an iovec, so a record marked stream is walked with a copy of the
+ * cursor.
+ */
+static inline int
+xdr_read_cursor_vector_segments(
+    const struct xdr_read_cursor *cursor,
+    unsigned int                  bytes)
+{
+    struct xdr_read_cursor probe;
+    unsigned int           chunk;
+    int                    n = 1;
+
+    if (!cursor->record) {
+        return (cursor->last - cursor->cur) + 1;
+    }
+
+    probe        = *cursor;
+    probe.digest = 0;
+
+    for (;;) {
+        chunk = probe.end - probe.iov_offset;
+
+        if (chunk >= bytes) {
+            return n;
+        }
+
+        bytes           -= chunk;
+        probe.iov_offset = probe.end;
+
+        if (xdr_read_cursor_vector_next(&probe) < 0) {
+            return n;
+        }
+
+        n++;
+    }
+} /* xdr_read_cursor_vector_segments */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+xdr_read_cursor_contig_skip(
+    struct xdr_read_cursor *cursor,
+    unsigned int            bytes)
+{
+    if (unlikely(cursor->iov_offset + bytes > cursor->end)) {
+        return -1;
+    }
+
+    cursor->iov_offset += bytes;
+    cursor->offset     += bytes;
+
+    return bytes;
+} /* xdr_read_cursor_contig_skip */
+
+/*
+ * Position a vector read cursor at the given offset of a view.
+ */
+static inline int WARN_UNUSED_RESULT
+xdr_view_seek(
+    const struct xdr_view  *view,
+    struct xdr_read_cursor *cursor,
+    uint32_t                offset)
+{
+    xdr_read_cursor_vector_init(cursor, view->iov, view->niov, NULL);
+
+    if (unlikely(xdr_read_cursor_vector_skip(cursor, view->offset + offset) < 0)) {
+        return -1;
+    }
+
+    return 0;
+} /* xdr_view_seek */
+
+/*
+ * Start a view of the value at the given offset of another view,
+ * rebased on the iovec holding its first byte.
+ */
+static inline int WARN_UNUSED_RESULT
+xdr_view_sub(
+    const struct xdr_view *view,
+    struct xdr_view       *sub,
+    uint32_t               offset)
 {
-    cursor->cur        = iov;
-    cursor->last       = iov;
-    cursor->iov_offset = 0;
-    cursor->offset     = 0;
-    cursor->read_chunk = read_chunk;
-} /* xdr_read_cursor_contig_init */
+    struct xdr_read_cursor cursor;
+
+    if (unlikely(xdr_view_seek(view, &cursor, offset) < 0)) {
+        return -1;
+    }
+
+    sub->iov    = cursor.cur;
+    sub->niov   = view->niov - (cursor.cur - view->iov);
+    sub->offset = cursor.iov_offset;
+
+    return 0;
+} /* xdr_view_sub */
 
 static FORCE_INLINE uint32_t
 __marshall_length_uint32_t(const uint32_t *v)
@@ -322,7 +638,7 @@ __marshall_uint32_t(
     const uint32_t          *v,
     struct xdr_write_cursor *cursor)
 {
-    if (unlikely(cursor->scratch_used + 4 > cursor->scratch_size)) {
+    if (unlikely(xdr_write_cursor_reserve(cursor, 4) < 0)) {
         return -1;
     }
 
@@ -333,25 +649,48 @@ __marshall_uint32_t(
     return 0;
 } /* __marshall_uint32_t */
 
+/*
+ * Reserve a length word to be filled in once the bytes following it
+ * have been encoded.  Scratch space is never reused once written, so
+ * the slot stays valid when the body spills into later scratch runs or
+ * buffers supplied by a refill.
+ */
 static FORCE_INLINE int WARN_UNUSED_RESULT
-__unmarshall_uint32_t_vector(
-    uint32_t               *v,
-    struct xdr_read_cursor *cursor,
-    xdr_dbuf               *dbuf)
+xdr_write_cursor_length_slot(
+    struct xdr_write_cursor *cursor,
+    uint32_t               **slot,
+    uint32_t                *start)
 {
-    uint32_t tmp;
-    int      rc;
+    if (unlikely(xdr_write_cursor_reserve(cursor, 4) < 0)) {
+        return -1;
+    }
 
-    rc = xdr_read_cursor_vector_extract(cursor, &tmp, 4);
+    *slot = (uint32_t *) (cursor->scratch_data + cursor->scratch_used);
 
-    if (unlikely(rc < 0)) {
-        return rc;
-    }
+    cursor->scratch_used += 4;
 
-    *v = xdr_ntoh32(tmp);
+    *start = cursor->total + cursor->scratch_used;
 
-    return 4;
-} /* __unmarshall_uint32_t_vector */
+    return 0;
+} /* xdr_write_cursor_length_slot */
+
+static FORCE_INLINE void
+xdr_write_cursor_length_patch(
+    struct xdr_write_cursor *cursor,
+    uint32_t                *slot,
+    uint32_t                 start)
+{
+    uint32_t value = xdr_hton32(cursor->total + cursor->scratch_used - start);
+    uint32_t delta;
+
+    /* The slot was already digested if its scratch run has been flushed */
+    if (unlikely(cursor->digest) && (uint32_t) cursor->total >= start) {
+        delta        = *slot ^ value;
+        cursor->crc ^= xdr_crc32c_shift(~xdr_crc32c(~0U, &delta, 4), cursor->total - start);
+    }
+
+    *slot = value;
+} /* xdr_write_cursor_length_patch */
 
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __unmarshall_uint32_t_contig(
@@ -359,7 +698,7 @@ __unmarshall_uint32_t_contig(
     struct xdr_read_cursor *cursor,
     xdr_dbuf               *dbuf)
 {
-    if (unlikely(cursor->iov_offset + 4 > xdr_iovec_len(cursor->cur))) {
+    if (unlikely(cursor->iov_offset + 4 > cursor->end)) {
         return -1;
     }
 
@@ -369,6 +708,30 @@ __unmarshall_uint32_t_contig(
     return 4;
 } /* __unmarshall_uint32_t_contig */
 
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__unmarshall_uint32_t_vector(
+    uint32_t               *v,
+    struct xdr_read_cursor *cursor,
+    xdr_dbuf               *dbuf)
+{
+    uint32_t tmp;
+    int      rc;
+
+    if (cursor->iov_offset + 4 < cursor->end) {
+        return __unmarshall_uint32_t_contig(v, cursor, dbuf);
+    }
+
+    rc = xdr_read_cursor_vector_extract(cursor, &tmp, 4);
+
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    *v = xdr_ntoh32(tmp);
+
+    return 4;
+} /* __unmarshall_uint32_t_vector */
+
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __marshall_xdr_bool(
     const xdr_bool          *v,
@@ -417,7 +780,7 @@ __marshall_int32_t(
     const int32_t           *v,
     struct xdr_write_cursor *cursor)
 {
-    if (unlikely(cursor->scratch_used + 4 > cursor->scratch_size)) {
+    if (unlikely(xdr_write_cursor_reserve(cursor, 4) < 0)) {
         return -1;
     }
 
@@ -427,6 +790,22 @@ __marshall_int32_t(
     return 0;
 } /* __marshall_int32_t */
 
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__unmarshall_int32_t_contig(
+    int32_t                *v,
+    struct xdr_read_cursor *cursor,
+    xdr_dbuf               *dbuf)
+{
+    if (unlikely(cursor->iov_offset + 4 > cursor->end)) {
+        return -1;
+    }
+
+    *v                  = xdr_ntoh32(*(const int32_t *) (xdr_iovec_data(cursor->cur) + cursor->iov_offset));
+    cursor->iov_offset += 4;
+    cursor->offset     += 4;
+    return 4;
+} /* __unmarshall_int32_t_contig */
+
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __unmarshall_int32_t_vector(
     int32_t                *v,
@@ -436,6 +815,10 @@ __unmarshall_int32_t_vector(
     int32_t tmp;
     int     rc;
 
+    if (cursor->iov_offset + 4 < cursor->end) {
+        return __unmarshall_int32_t_contig(v, cursor, dbuf);
+    }
+
     rc = xdr_read_cursor_vector_extract(cursor, &tmp, 4);
 
     if (unlikely(rc < 0)) {
@@ -447,28 +830,12 @@ __unmarshall_int32_t_vector(
     return 4;
 } /* __unmarshall_int32_t_vector */
 
-static FORCE_INLINE int WARN_UNUSED_RESULT
-__unmarshall_int32_t_contig(
-    int32_t                *v,
-    struct xdr_read_cursor *cursor,
-    xdr_dbuf               *dbuf)
-{
-    if (unlikely(cursor->iov_offset + 4 > xdr_iovec_len(cursor->cur))) {
-        return -1;
-    }
-
-    *v                  = xdr_ntoh32(*(const int32_t *) (xdr_iovec_data(cursor->cur) + cursor->iov_offset));
-    cursor->iov_offset += 4;
-    cursor->offset     += 4;
-    return 4;
-} /* __unmarshall_int32_t_contig */
-
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __marshall_uint64_t(
     const uint64_t          *v,
     struct xdr_write_cursor *cursor)
 {
-    if (unlikely(cursor->scratch_used + 8 > cursor->scratch_size)) {
+    if (unlikely(xdr_write_cursor_reserve(cursor, 8) < 0)) {
         return -1;
     }
 
@@ -478,6 +845,22 @@ __marshall_uint64_t(
     return 0;
 } /* __marshall_uint64_t */
 
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__unmarshall_uint64_t_contig(
+    uint64_t               *v,
+    struct xdr_read_cursor *cursor,
+    xdr_dbuf               *dbuf)
+{
+    if (unlikely(cursor->iov_offset + 8 > cursor->end)) {
+        return -1;
+    }
+
+    *v                  = xdr_ntoh64(*(const uint64_t *) (xdr_iovec_data(cursor->cur) + cursor->iov_offset));
+    cursor->iov_offset += 8;
+    cursor->offset     += 8;
+    return 8;
+} /* __unmarshall_uint64_t_contig */
+
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __unmarshall_uint64_t_vector(
     uint64_t               *v,
@@ -487,6 +870,10 @@ __unmarshall_uint64_t_vector(
     uint64_t tmp;
     int      rc;
 
+    if (cursor->iov_offset + 8 < cursor->end) {
+        return __unmarshall_uint64_t_contig(v, cursor, dbuf);
+    }
+
     rc = xdr_read_cursor_vector_extract(cursor, &tmp, 8);
 
     if (unlikely(rc < 0)) {
@@ -499,35 +886,35 @@ __unmarshall_uint64_t_vector(
 } /* __unmarshall_uint64_t_vector */
 
 static FORCE_INLINE int WARN_UNUSED_RESULT
-__unmarshall_uint64_t_contig(
-    uint64_t               *v,
-    struct xdr_read_cursor *cursor,
-    xdr_dbuf               *dbuf)
+__marshall_int64_t(
+    const int64_t           *v,
+    struct xdr_write_cursor *cursor)
 {
-    if (unlikely(cursor->iov_offset + 8 > xdr_iovec_len(cursor->cur))) {
+    if (unlikely(xdr_write_cursor_reserve(cursor, 8) < 0)) {
         return -1;
     }
 
-    *v                  = xdr_ntoh64(*(const uint64_t *) (xdr_iovec_data(cursor->cur) + cursor->iov_offset));
-    cursor->iov_offset += 8;
-    cursor->offset     += 8;
-    return 8;
-} /* __unmarshall_uint64_t_contig */
+    *(int64_t *) (cursor->scratch_data + cursor->scratch_used) = xdr_hton64(*v);
+
+    cursor->scratch_used += 8;
+    return 0;
+} /* __marshall_int64_t */
 
 static FORCE_INLINE int WARN_UNUSED_RESULT
-__marshall_int64_t(
-    const int64_t           *v,
-    struct xdr_write_cursor *cursor)
+__unmarshall_int64_t_contig(
+    int64_t                *v,
+    struct xdr_read_cursor *cursor,
+    xdr_dbuf               *dbuf)
 {
-    if (unlikely(cursor->scratch_used + 8 > cursor->scratch_size)) {
+    if (unlikely(cursor->iov_offset + 8 > cursor->end)) {
         return -1;
     }
 
-    *(int64_t *) (cursor->scratch_data + cursor->scratch_used) = xdr_hton64(*v);
-
-    cursor->scratch_used += 8;
-    return 0;
-} /* __marshall_int64_t */
+    *v                  = xdr_ntoh64(*(const int64_t *) (xdr_iovec_data(cursor->cur) + cursor->iov_offset));
+    cursor->iov_offset += 8;
+    cursor->offset     += 8;
+    return 8;
+} /* __unmarshall_int64_t_contig */
 
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __unmarshall_int64_t_vector(
@@ -538,6 +925,10 @@ __unmarshall_int64_t_vector(
     int64_t tmp;
     int     rc;
 
+    if (cursor->iov_offset + 8 < cursor->end) {
+        return __unmarshall_int64_t_contig(v, cursor, dbuf);
+    }
+
     rc = xdr_read_cursor_vector_extract(cursor, &tmp, 8);
 
     if (unlikely(rc < 0)) {
@@ -549,22 +940,6 @@ __unmarshall_int64_t_vector(
     return 8;
 } /* __unmarshall_int64_t_vector */
 
-static FORCE_INLINE int WARN_UNUSED_RESULT
-__unmarshall_int64_t_contig(
-    int64_t                *v,
-    struct xdr_read_cursor *cursor,
-    xdr_dbuf               *dbuf)
-{
-    if (unlikely(cursor->iov_offset + 8 > xdr_iovec_len(cursor->cur))) {
-        return -1;
-    }
-
-    *v                  = xdr_ntoh64(*(const int64_t *) (xdr_iovec_data(cursor->cur) + cursor->iov_offset));
-    cursor->iov_offset += 8;
-    cursor->offset     += 8;
-    return 8;
-} /* __unmarshall_int64_t_contig */
-
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __marshall_float(
     const float             *v,
@@ -573,22 +948,13 @@ __marshall_float(
     return xdr_write_cursor_append(cursor, v, 4);
 } /* __marshall_float */
 
-static FORCE_INLINE int WARN_UNUSED_RESULT
-__unmarshall_float_vector(
-    float                  *v,
-    struct xdr_read_cursor *cursor,
-    xdr_dbuf               *dbuf)
-{
-    return xdr_read_cursor_vector_extract(cursor, v, 4);
-} /* __unmarshall_float_vector */
-
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __unmarshall_float_contig(
     float                  *v,
     struct xdr_read_cursor *cursor,
     xdr_dbuf               *dbuf)
 {
-    if (unlikely(cursor->iov_offset + 4 > xdr_iovec_len(cursor->cur))) {
+    if (unlikely(cursor->iov_offset + 4 > cursor->end)) {
         return -1;
     }
 
@@ -598,6 +964,19 @@ __unmarshall_float_contig(
     return 4;
 } /* __unmarshall_float_contig */
 
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__unmarshall_float_vector(
+    float                  *v,
+    struct xdr_read_cursor *cursor,
+    xdr_dbuf               *dbuf)
+{
+    if (cursor->iov_offset + 4 < cursor->end) {
+        return __unmarshall_float_contig(v, cursor, dbuf);
+    }
+
+    return xdr_read_cursor_vector_extract(cursor, v, 4);
+} /* __unmarshall_float_vector */
+
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __marshall_double(
     const double            *v,
@@ -606,22 +985,13 @@ __marshall_double(
     return xdr_write_cursor_append(cursor, v, 8);
 } /* __marshall_double */
 
-static FORCE_INLINE int WARN_UNUSED_RESULT
-__unmarshall_double_vector(
-    double                 *v,
-    struct xdr_read_cursor *cursor,
-    xdr_dbuf               *dbuf)
-{
-    return xdr_read_cursor_vector_extract(cursor, v, 8);
-} /* __unmarshall_double_vector */
-
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __unmarshall_double_contig(
     double                 *v,
     struct xdr_read_cursor *cursor,
     xdr_dbuf               *dbuf)
 {
-    if (unlikely(cursor->iov_offset + 8 > xdr_iovec_len(cursor->cur))) {
+    if (unlikely(cursor->iov_offset + 8 > cursor->end)) {
         return -1;
     }
 
@@ -631,6 +1001,317 @@ __unmarshall_double_contig(
     return 8;
 } /* __unmarshall_double_contig */
 
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__unmarshall_double_vector(
+    double                 *v,
+    struct xdr_read_cursor *cursor,
+    xdr_dbuf               *dbuf)
+{
+    if (cursor->iov_offset + 8 < cursor->end) {
+        return __unmarshall_double_contig(v, cursor, dbuf);
+    }
+
+    return xdr_read_cursor_vector_extract(cursor, v, 8);
+} /* __unmarshall_double_vector */
+
+/*
+ * Runs of fixed-size members are bounds checked once, then encoded or
+ * decoded with the unchecked __pack_X()/__unpack_X() helpers at
+ * constant offsets from the returned pointer.
+ */
+static FORCE_INLINE char *
+xdr_write_cursor_run(
+    struct xdr_write_cursor *cursor,
+    unsigned int             bytes)
+{
+    char *p;
+
+    if (unlikely(xdr_write_cursor_reserve(cursor, bytes) < 0)) {
+        return NULL;
+    }
+
+    p = (char *) cursor->scratch_data + cursor->scratch_used;
+
+    cursor->scratch_used += bytes;
+
+    return p;
+} /* xdr_write_cursor_run */
+
+static FORCE_INLINE const char *
+xdr_read_cursor_contig_run(
+    struct xdr_read_cursor *cursor,
+    unsigned int            bytes)
+{
+    const char *p;
+
+    if (unlikely(cursor->iov_offset + bytes > cursor->end)) {
+        return NULL;
+    }
+
+    p = (const char *) xdr_iovec_data(cursor->cur) + cursor->iov_offset;
+
+    cursor->iov_offset += bytes;
+    cursor->offset     += bytes;
+
+    return p;
+} /* xdr_read_cursor_contig_run */
+
+/* A run split across iovecs is gathered into tmp first */
+static FORCE_INLINE const char *
+xdr_read_cursor_vector_run(
+    struct xdr_read_cursor *cursor,
+    void                   *tmp,
+    unsigned int            bytes)
+{
+    if (cursor->iov_offset + bytes < cursor->end) {
+        return xdr_read_cursor_contig_run(cursor, bytes);
+    }
+
+    if (unlikely(xdr_read_cursor_vector_extract(cursor, tmp, bytes) < 0)) {
+        return NULL;
+    }
+
+    return (const char *) tmp;
+} /* xdr_read_cursor_vector_run */
+
+static FORCE_INLINE void
+__pack_uint32_t(
+    const uint32_t *v,
+    char           *p)
+{
+    *(uint32_t *) p = xdr_hton32(*v);
+} /* __pack_uint32_t */
+
+static FORCE_INLINE void
+__unpack_uint32_t(
+    uint32_t   *v,
+    const char *p)
+{
+    *v = xdr_ntoh32(*(const uint32_t *) p);
+} /* __unpack_uint32_t */
+
+static FORCE_INLINE void
+__pack_int32_t(
+    const int32_t *v,
+    char          *p)
+{
+    *(int32_t *) p = xdr_hton32(*v);
+} /* __pack_int32_t */
+
+static FORCE_INLINE void
+__unpack_int32_t(
+    int32_t    *v,
+    const char *p)
+{
+    *v = xdr_ntoh32(*(const int32_t *) p);
+} /* __unpack_int32_t */
+
+static FORCE_INLINE void
+__pack_uint64_t(
+    const uint64_t *v,
+    char           *p)
+{
+    *(uint64_t *) p = xdr_hton64(*v);
+} /* __pack_uint64_t */
+
+static FORCE_INLINE void
+__unpack_uint64_t(
+    uint64_t   *v,
+    const char *p)
+{
+    *v = xdr_ntoh64(*(const uint64_t *) p);
+} /* __unpack_uint64_t */
+
+static FORCE_INLINE void
+__pack_int64_t(
+    const int64_t *v,
+    char          *p)
+{
+    *(int64_t *) p = xdr_hton64(*v);
+} /* __pack_int64_t */
+
+static FORCE_INLINE void
+__unpack_int64_t(
+    int64_t    *v,
+    const char *p)
+{
+    *v = xdr_ntoh64(*(const int64_t *) p);
+} /* __unpack_int64_t */
+
+static FORCE_INLINE void
+__pack_xdr_bool(
+    const xdr_bool *v,
+    char           *p)
+{
+    *(uint32_t *) p = xdr_hton32(*v ? 1 : 0);
+} /* __pack_xdr_bool */
+
+static FORCE_INLINE void
+__unpack_xdr_bool(
+    xdr_bool   *v,
+    const char *p)
+{
+    *v = xdr_ntoh32(*(const uint32_t *) p);
+} /* __unpack_xdr_bool */
+
+static FORCE_INLINE void
+__pack_float(
+    const float *v,
+    char        *p)
+{
+    memcpy(p, v, 4);
+} /* __pack_float */
+
+static FORCE_INLINE void
+__unpack_float(
+    float      *v,
+    const char *p)
+{
+    memcpy(v, p, 4);
+} /* __unpack_float */
+
+static FORCE_INLINE void
+__pack_double(
+    const double *v,
+    char         *p)
+{
+    memcpy(p, v, 8);
+} /* __pack_double */
+
+static FORCE_INLINE void
+__unpack_double(
+    double     *v,
+    const char *p)
+{
+    memcpy(v, p, 8);
+} /* __unpack_double */
+
+/*
+ * Bulk encode/decode of n consecutive scalars of the given width, used
+ * for arrays and vectors of builtin numeric types.  The whole run is
+ * bounds checked once and then converted with xdr_bulk_copy().
+ */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__marshall_bulk(
+    const void              *v,
+    uint32_t                 n,
+    uint32_t                 width,
+    int                      swap,
+    struct xdr_write_cursor *cursor)
+{
+    uint64_t bytes = (uint64_t) n * width;
+
+    if (unlikely(bytes > INT32_MAX || xdr_write_cursor_reserve(cursor, bytes) < 0)) {
+        return -1;
+    }
+
+    xdr_bulk_copy(cursor->scratch_data + cursor->scratch_used, v, n, width, swap);
+
+    cursor->scratch_used += bytes;
+
+    return 0;
+} /* __marshall_bulk */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__unmarshall_bulk_contig(
+    void                   *v,
+    uint32_t                n,
+    uint32_t                width,
+    int                     swap,
+    struct xdr_read_cursor *cursor)
+{
+    uint64_t bytes = (uint64_t) n * width;
+
+    if (unlikely(cursor->iov_offset + bytes > cursor->end)) {
+        return -1;
+    }
+
+    xdr_bulk_copy(v, xdr_iovec_data(cursor->cur) + cursor->iov_offset, n, width, swap);
+
+    cursor->iov_offset += bytes;
+    cursor->offset     += bytes;
+
+    return bytes;
+} /* __unmarshall_bulk_contig */
+
+static inline int WARN_UNUSED_RESULT
+__unmarshall_bulk_vector(
+    void                   *v,
+    uint32_t                n,
+    uint32_t                width,
+    int                     swap,
+    struct xdr_read_cursor *cursor)
+{
+    uint32_t left = n, chunk;
+    uint64_t tmp;
+    char    *out = (char *) v;
+    int      rc;
+
+    while (left) {
+        chunk = (cursor->end - cursor->iov_offset) / width;
+
+        if (chunk) {
+            if (chunk > left) {
+                chunk = left;
+            }
+
+            xdr_bulk_copy(out, xdr_iovec_data(cursor->cur) + cursor->iov_offset, chunk, width, swap);
+
+            xdr_read_cursor_vector_consume(cursor, chunk * width);
+        } else {
+            /* Element straddles a segment boundary */
+            chunk = 1;
+
+            rc = xdr_read_cursor_vector_extract(cursor, &tmp, width);
+
+            if (unlikely(rc < 0)) {
+                return rc;
+            }
+
+            xdr_bulk_copy(out, &tmp, 1, width, swap);
+        }
+
+        out  += chunk * width;
+        left -= chunk;
+    }
+
+    return (uint64_t) n * width;
+} /* __unmarshall_bulk_vector */
+
+#define XDR_BULK_SCALAR(type, width, swap) \
+        static FORCE_INLINE int WARN_UNUSED_RESULT \
+        __marshall_ ## type ## _bulk( \
+            const type * v, \
+            uint32_t n, \
+            struct xdr_write_cursor * cursor) \
+        { \
+            return __marshall_bulk(v, n, width, swap, cursor); \
+        } \
+        static FORCE_INLINE int WARN_UNUSED_RESULT \
+        __unmarshall_ ## type ## _bulk_vector( \
+            type * v, \
+            uint32_t n, \
+            struct xdr_read_cursor * cursor) \
+        { \
+            return __unmarshall_bulk_vector(v, n, width, swap, cursor); \
+        } \
+        static FORCE_INLINE int WARN_UNUSED_RESULT \
+        __unmarshall_ ## type ## _bulk_contig( \
+            type * v, \
+            uint32_t n, \
+            struct xdr_read_cursor * cursor) \
+        { \
+            return __unmarshall_bulk_contig(v, n, width, swap, cursor); \
+        }
+
+XDR_BULK_SCALAR(uint32_t, 4, 1)
+XDR_BULK_SCALAR(int32_t, 4, 1)
+XDR_BULK_SCALAR(uint64_t, 8, 1)
+XDR_BULK_SCALAR(int64_t, 8, 1)
+XDR_BULK_SCALAR(float, 4, 0)
+XDR_BULK_SCALAR(double, 8, 0)
+
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __marshall_xdr_string(
     const xdr_string        *str,
@@ -665,6 +1346,7 @@ __marshall_xdr_string(
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __unmarshall_xdr_string_vector(
     xdr_string             *str,
+    uint32_t                bound,
     struct xdr_read_cursor *cursor,
     xdr_dbuf               *dbuf)
 {
@@ -676,20 +1358,18 @@ __unmarshall_xdr_string_vector(
         return rc;
     }
 
-    len += rc;
+    if (unlikely(bound && str->len > bound)) {
+        return -1;
+    }
 
-    if (xdr_iovec_len(cursor->cur) - cursor->iov_offset >= str->len) {
-        str->str            = xdr_iovec_data(cursor->cur) + cursor->iov_offset;
-        cursor->iov_offset += str->len;
-        cursor->offset     += str->len;
+    len += rc;
 
-        if (cursor->iov_offset == xdr_iovec_len(cursor->cur)) {
-            cursor->cur++;
-            cursor->iov_offset = 0;
-        }
+    if (cursor->end - cursor->iov_offset >= str->len) {
+        str->str = (char *) xdr_iovec_data(cursor->cur) + cursor->iov_offset;
 
+        xdr_read_cursor_vector_consume(cursor, str->len);
     } else {
-        str->str = xdr_dbuf_alloc_space(str->len, dbuf);
+        str->str = (char *) xdr_dbuf_alloc_space(str->len, dbuf);
         if (unlikely(str->str == NULL)) {
             return -1;
         }
@@ -721,6 +1401,7 @@ __unmarshall_xdr_string_vector(
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __unmarshall_xdr_string_contig(
     xdr_string             *str,
+    uint32_t                bound,
     struct xdr_read_cursor *cursor,
     xdr_dbuf               *dbuf)
 {
@@ -732,8 +1413,12 @@ __unmarshall_xdr_string_contig(
     }
     len += rc;
 
+    if (unlikely(bound && str->len > bound)) {
+        return -1;
+    }
+
     pad = (4 - (str->len & 0x3)) & 0x3;
-    if (unlikely(cursor->iov_offset + str->len + pad > xdr_iovec_len(cursor->cur))) {
+    if (unlikely(str->len > INT32_MAX - 8 || str->len + pad > cursor->end - cursor->iov_offset)) {
         return -1;
     }
 
@@ -764,7 +1449,7 @@ __unmarshall_opaque_fixed_vector(
 {
     int pad, chunk, left = size;
 
-    v->iov = xdr_dbuf_alloc_space(sizeof(*v->iov) * ((cursor->last - cursor->cur) + 1), dbuf);
+    v->iov = (xdr_iovec *) xdr_dbuf_alloc_space(sizeof(*v->iov) * xdr_read_cursor_vector_segments(cursor, size), dbuf);
     if (unlikely(v->iov == NULL)) {
         return -1;
     }
@@ -773,16 +1458,19 @@ __unmarshall_opaque_fixed_vector(
     v->niov   = 0;
 
     do {
-        if (unlikely(cursor->cur > cursor->last)) {
-            return -1;
+        chunk = cursor->end - cursor->iov_offset;
+
+        if (left && chunk == 0) {
+            if (unlikely(xdr_read_cursor_vector_next(cursor) < 0)) {
+                return -1;
+            }
+            continue;
         }
 
         xdr_iovec_copy_private(&v->iov[v->niov], cursor->cur);
         xdr_iovec_set_data(&v->iov[v->niov], xdr_iovec_data(cursor->cur) +
                            cursor->iov_offset);
 
-        chunk = xdr_iovec_len(cursor->cur) - cursor->iov_offset;
-
         if (left < chunk) {
             chunk = left;
         }
@@ -791,12 +1479,7 @@ __unmarshall_opaque_fixed_vector(
 
         left -= chunk;
 
-        cursor->iov_offset += chunk;
-        cursor->offset     += chunk;
-        if (cursor->iov_offset == xdr_iovec_len(cursor->cur)) {
-            cursor->cur++;
-            cursor->iov_offset = 0;
-        }
+        xdr_read_cursor_vector_consume(cursor, chunk);
 
         v->niov++;
 
@@ -804,7 +1487,9 @@ __unmarshall_opaque_fixed_vector(
 
     pad = (4 - (size & 0x3)) & 0x3;
 
-    xdr_read_cursor_vector_skip(cursor, pad);
+    if (pad && unlikely(xdr_read_cursor_vector_skip(cursor, pad) < 0)) {
+        return -1;
+    }
 
     return size + pad;
 } /* __unmarshall_opaque_fixed_vector */
@@ -819,13 +1504,13 @@ __unmarshall_opaque_fixed_contig(
     int pad;
 
     pad = (4 - (size & 0x3)) & 0x3;
-    if (unlikely(cursor->iov_offset + size + pad > xdr_iovec_len(cursor->cur))) {
+    if (unlikely(size > INT32_MAX - 8 || size + pad > cursor->end - cursor->iov_offset)) {
         return -1;
     }
 
     v->length = size;
     v->niov   = 1;
-    v->iov    = xdr_dbuf_alloc_space(sizeof(*v->iov), dbuf);
+    v->iov    = (xdr_iovec *) xdr_dbuf_alloc_space(sizeof(*v->iov), dbuf);
     if (unlikely(v->iov == NULL)) {
         return -1;
     }
@@ -876,13 +1561,57 @@ __marshall_opaque(
     return 0;
 } /* __marshall_opaque */
 
+/*
+ * Zero-copy payloads smaller than the cursor's inline threshold are
+ * copied into the current scratch run rather than emitted as separate
+ * iovecs by reference.
+ */
+static inline int WARN_UNUSED_RESULT
+__marshall_opaque_zerocopy_inline(
+    xdr_iovecr              *v,
+    struct xdr_write_cursor *cursor)
+{
+    char    *out;
+    uint32_t chunk, left = v->length, pad = xdr_pad(v->length);
+    int      i;
+
+    if (unlikely(xdr_write_cursor_reserve(cursor, left + pad) < 0)) {
+        return -1;
+    }
+
+    out = (char *) cursor->scratch_data + cursor->scratch_used;
+
+    for (i = 0; i < v->niov && left; ++i) {
+        chunk = xdr_iovec_len32(&v->iov[i]);
+
+        if (chunk > left) {
+            chunk = left;
+        }
+
+        memcpy(out, xdr_iovec_data(&v->iov[i]), chunk);
+
+        out  += chunk;
+        left -= chunk;
+    }
+
+    if (unlikely(left)) {
+        return -1;
+    }
+
+    memset(out, 0, pad);
+
+    cursor->scratch_used += v->length + pad;
+
+    return 0;
+} /* __marshall_opaque_zerocopy_inline */
+
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __marshall_opaque_zerocopy(
     xdr_iovecr              *v,
     struct xdr_write_cursor *cursor)
 {
     const uint32_t zero = 0;
-    xdr_iovec     *iov;
+    xdr_iovec     *iov, tmp;
     int            i, pad, left = v->length;
     int            rc;
 
@@ -896,11 +1625,15 @@ __marshall_opaque_zerocopy(
         cursor->rdma_chunk->iov          = v->iov;
         cursor->rdma_chunk->niov         = v->niov;
         cursor->rdma_chunk->length       = v->length;
-        cursor->rdma_chunk->xdr_position = cursor->scratch_used - cursor->scratch_reserved;
+        cursor->rdma_chunk->xdr_position = cursor->total + cursor->scratch_used - cursor->scratch_reserved;
         return 0;
     }
  #endif /* if EVPL_RPC2 */
 
+    if (v->length < cursor->zc_inline_threshold) {
+        return __marshall_opaque_zerocopy_inline(v, cursor);
+    }
+
     rc = xdr_write_cursor_flush(cursor);
     if (unlikely(rc < 0)) {
         return rc;
@@ -908,19 +1641,44 @@ __marshall_opaque_zerocopy(
 
     for (i = 0; i < v->niov && left; ++i) {
 
+        if (cursor->coalesce) {
+            xdr_write_cursor_ref(cursor, &tmp, &v->iov[i], xdr_iovec_move_private);
+
+            if (xdr_iovec_len(&tmp) > (uint32_t) left) {
+                xdr_iovec_set_len(&tmp, left);
+            }
+
+            left -= xdr_iovec_len(&tmp);
+
+            if (cursor->digest) {
+                cursor->crc = xdr_crc32c(cursor->crc, xdr_iovec_data(&tmp), xdr_iovec_len(&tmp));
+            }
+
+            if (unlikely(xdr_write_cursor_emit(cursor, &tmp) < 0)) {
+                return -1;
+            }
+            continue;
+        }
+
         if (unlikely(cursor->niov + 1 > cursor->maxiov)) {
-            return -1;
+            if (unlikely(xdr_write_cursor_refill(cursor, 0, v->niov - i) < 0)) {
+                return -1;
+            }
         }
 
         iov = &cursor->iov[cursor->niov++];
 
-        xdr_iovec_move_private(iov, &v->iov[i]);
+        xdr_write_cursor_ref(cursor, iov, &v->iov[i], xdr_iovec_move_private);
 
-        if (xdr_iovec_len(iov) > left) {
+        if (xdr_iovec_len(iov) > (uint32_t) left) {
             xdr_iovec_set_len(iov, left);
         }
 
         left -= xdr_iovec_len(iov);
+
+        if (cursor->digest) {
+            cursor->crc = xdr_crc32c(cursor->crc, xdr_iovec_data(iov), xdr_iovec_len(iov));
+        }
     }
 
     if (unlikely(left)) {
@@ -936,6 +1694,7 @@ __marshall_opaque_zerocopy(
         if (unlikely(rc < 0)) {
             return rc;
         }
+        cursor->pad_pending = pad;
     }
 
     return 0;
@@ -956,15 +1715,14 @@ __unmarshall_opaque_vector(
         return rc;
     }
 
-    if (xdr_iovec_len(cursor->cur) - cursor->iov_offset >= v->len) {
-        v->data             = xdr_iovec_data(cursor->cur) + cursor->iov_offset;
-        cursor->iov_offset += v->len;
-        cursor->offset     += v->len;
-        if (cursor->iov_offset == xdr_iovec_len(cursor->cur)) {
-            cursor->cur++;
-            cursor->iov_offset = 0;
-        }
+    if (unlikely(bound && v->len > bound)) {
+        return -1;
+    }
+
+    if (cursor->end - cursor->iov_offset >= v->len) {
+        v->data = xdr_iovec_data(cursor->cur) + cursor->iov_offset;
 
+        xdr_read_cursor_vector_consume(cursor, v->len);
     } else {
         v->data = xdr_dbuf_alloc_space(v->len, dbuf);
         if (unlikely(v->data == NULL)) {
@@ -1006,8 +1764,12 @@ __unmarshall_opaque_contig(
     }
     len += rc;
 
+    if (unlikely(bound && v->len > bound)) {
+        return -1;
+    }
+
     pad = (4 - (v->len & 0x3)) & 0x3;
-    if (unlikely(cursor->iov_offset + v->len + pad > xdr_iovec_len(cursor->cur))) {
+    if (unlikely(v->len > INT32_MAX - 8 || v->len + pad > cursor->end - cursor->iov_offset)) {
         return -1;
     }
 
@@ -1028,6 +1790,7 @@ __unmarshall_opaque_contig(
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __unmarshall_opaque_zerocopy_vector(
     xdr_iovecr             *v,
+    uint32_t                bound,
     struct xdr_read_cursor *cursor,
     xdr_dbuf               *dbuf)
 {
@@ -1041,6 +1804,10 @@ __unmarshall_opaque_zerocopy_vector(
         return rc;
     }
 
+    if (unlikely(bound && size > bound)) {
+        return -1;
+    }
+
 #if EVPL_RPC2
     if (cursor->read_chunk && cursor->read_chunk->length) {
         chunk = cursor->read_chunk;
@@ -1066,6 +1833,7 @@ __unmarshall_opaque_zerocopy_vector(
 static FORCE_INLINE int WARN_UNUSED_RESULT
 __unmarshall_opaque_zerocopy_contig(
     xdr_iovecr             *v,
+    uint32_t                bound,
     struct xdr_read_cursor *cursor,
     xdr_dbuf               *dbuf)
 {
@@ -1076,6 +1844,10 @@ __unmarshall_opaque_zerocopy_contig(
     if (unlikely(rc < 0)) {
         return rc;
     }
+
+    if (unlikely(bound && size > bound)) {
+        return -1;
+    }
     len += rc;
 
 #if EVPL_RPC2
@@ -1100,6 +1872,902 @@ __unmarshall_opaque_zerocopy_contig(
     return len;
 } /* __unmarshall_opaque_zerocopy_contig */
 
+/*
+ * Skip a length-prefixed string or opaque without copying it.
+ */
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__skip_opaque_vector(struct xdr_read_cursor *cursor)
+{
+    int      rc;
+    uint32_t size;
+
+    rc = __unmarshall_uint32_t_vector(&size, cursor, NULL);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    if (unlikely(size > INT32_MAX - 8)) {
+        return -1;
+    }
+
+    rc = xdr_read_cursor_vector_skip(cursor, size + xdr_pad(size));
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    return 4 + rc;
+} /* __skip_opaque_vector */
+
+/*
+ * Resumable decoding of a string or opaque whose body has not fully
+ * arrived.  The length is decoded into *len and the body is copied into
+ * the dbuf as it arrives: frame->phase is 0 before the length, 1 while
+ * copying and 2 waiting for the padding, and frame->index counts the
+ * bytes copied so far.  Returns 0 once the body and its padding are
+ * consumed, 1 to wait for more data, or -1 on error.
+ */
+static __attribute__((noinline, unused)) int
+xdr_resume_opaque(
+    struct xdr_resume_frame *frame,
+    struct xdr_read_cursor  *cursor,
+    uint32_t                *len,
+    void                   **data,
+    uint32_t                 bound,
+    xdr_dbuf                *dbuf)
+{
+    struct xdr_read_cursor probe;
+
+    switch (frame->phase) {
+        case 0:
+            probe = *cursor;
+
+            if (xdr_read_cursor_vector_skip(&probe, 4) < 0) {
+                return 1;
+            }
+
+            if (unlikely(__unmarshall_uint32_t_vector(len, cursor, dbuf) < 0)) {
+                return -1;
+            }
+
+            if (unlikely(bound && *len > bound)) {
+                return -1;
+            }
+
+            *data = xdr_dbuf_alloc_space(*len, dbuf);
+
+            if (unlikely(*data == NULL)) {
+                return -1;
+            }
+
+            frame->phase = 1;
+            frame->index = 0;
+        /* fallthrough */
+        case 1:
+            frame->index += xdr_read_cursor_vector_extract_partial(cursor, (char *) *data + frame->index,
+                                                                   *len - frame->index);
+
+            if (frame->index < *len) {
+                return 1;
+            }
+
+            frame->phase = 2;
+        /* fallthrough */
+        default:
+            probe = *cursor;
+
+            if (xdr_read_cursor_vector_skip(&probe, xdr_pad(*len)) < 0) {
+                return 1;
+            }
+
+            *cursor = probe;
+    } /* switch */
+
+    return 0;
+} /* xdr_resume_opaque */
+
+/*
+ * Resumable encoding of a string or opaque body, which is split when it
+ * does not fit the scratch space left.  counted selects a variable length
+ * opaque, whose length and padding are written around the body, over a
+ * fixed one.  frame->phase is 0 before the length and 1 once it has been
+ * written, and frame->index counts the body bytes written so far.
+ * Returns 0 when complete.  Otherwise it returns -1 with mark moved past
+ * whatever was written, so the caller's rewind keeps it.
+ */
+static __attribute__((noinline, unused)) int
+xdr_marshall_resume_opaque(
+    struct xdr_resume_frame *frame,
+    struct xdr_write_cursor *cursor,
+    struct xdr_write_mark   *mark,
+    const void              *data,
+    uint32_t                 len,
+    int                      counted)
+{
+    const uint32_t zero = 0;
+    uint32_t       room, chunk;
+
+    if (frame->phase == 0) {
+        if (counted && unlikely(__marshall_uint32_t(&len, cursor) < 0)) {
+            return -1;
+        }
+
+        frame->phase = 1;
+        frame->index = 0;
+    }
+
+    room  = cursor->scratch_size - cursor->scratch_used;
+    chunk = len - frame->index;
+
+    if (chunk > room) {
+        chunk = room;
+    }
+
+    memcpy((char *) cursor->scratch_data + cursor->scratch_used, (const char *) data + frame->index, chunk);
+
+    cursor->scratch_used += chunk;
+    frame->index         += chunk;
+
+    if (frame->index < len ||
+        (counted && unlikely(xdr_write_cursor_append(cursor, &zero, xdr_pad(len)) < 0))) {
+        xdr_write_cursor_mark(cursor, mark);
+        return -1;
+    }
+
+    return 0;
+} /* xdr_marshall_resume_opaque */
+
+/*
+ * Skip a counted vector of elements that are each width bytes on the wire.
+ */
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__skip_fixed_vector(
+    struct xdr_read_cursor *cursor,
+    uint32_t                width)
+{
+    int      rc;
+    uint32_t count;
+
+    rc = __unmarshall_uint32_t_vector(&count, cursor, NULL);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    if (unlikely(count > (INT32_MAX - 4) / width)) {
+        return -1;
+    }
+
+    rc = xdr_read_cursor_vector_skip(cursor, count * width);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    return 4 + rc;
+} /* __skip_fixed_vector */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__skip_opaque_contig(struct xdr_read_cursor *cursor)
+{
+    int      rc;
+    uint32_t size;
+
+    rc = __unmarshall_uint32_t_contig(&size, cursor, NULL);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    if (unlikely(size > INT32_MAX - 8)) {
+        return -1;
+    }
+
+    rc = xdr_read_cursor_contig_skip(cursor, size + xdr_pad(size));
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    return 4 + rc;
+} /* __skip_opaque_contig */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__skip_fixed_contig(
+    struct xdr_read_cursor *cursor,
+    uint32_t                width)
+{
+    int      rc;
+    uint32_t count;
+
+    rc = __unmarshall_uint32_t_contig(&count, cursor, NULL);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    if (unlikely(count > (INT32_MAX - 4) / width)) {
+        return -1;
+    }
+
+    rc = xdr_read_cursor_contig_skip(cursor, count * width);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    return 4 + rc;
+} /* __skip_fixed_contig */
+
+/*
+ * The validate helpers walk the wire format like skip, but also reject
+ * lengths and counts beyond a declared bound (0 means unbounded) and
+ * optional or list markers that are not a boolean.
+ */
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__validate_count_vector(
+    uint32_t               *count,
+    uint32_t                bound,
+    struct xdr_read_cursor *cursor)
+{
+    int rc;
+
+    rc = __unmarshall_uint32_t_vector(count, cursor, NULL);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    if (unlikely(bound && *count > bound)) {
+        return -1;
+    }
+
+    return rc;
+} /* __validate_count_vector */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__validate_bool_vector(
+    uint32_t               *value,
+    struct xdr_read_cursor *cursor)
+{
+    int rc;
+
+    rc = __unmarshall_uint32_t_vector(value, cursor, NULL);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    if (unlikely(*value > 1)) {
+        return -1;
+    }
+
+    return rc;
+} /* __validate_bool_vector */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__validate_opaque_vector(
+    uint32_t                bound,
+    struct xdr_read_cursor *cursor)
+{
+    int      rc;
+    uint32_t size;
+
+    rc = __validate_count_vector(&size, bound, cursor);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    if (unlikely(size > INT32_MAX - 8)) {
+        return -1;
+    }
+
+    rc = xdr_read_cursor_vector_skip(cursor, size + xdr_pad(size));
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    return 4 + rc;
+} /* __validate_opaque_vector */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__validate_fixed_vector(
+    uint32_t                width,
+    uint32_t                bound,
+    struct xdr_read_cursor *cursor)
+{
+    int      rc;
+    uint32_t count;
+
+    rc = __validate_count_vector(&count, bound, cursor);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    if (unlikely(count > (INT32_MAX - 4) / width)) {
+        return -1;
+    }
+
+    rc = xdr_read_cursor_vector_skip(cursor, count * width);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    return 4 + rc;
+} /* __validate_fixed_vector */
+
+/*
+ * The footprint helpers step over a field as unmarshall would decode it
+ * from the same cursor, adding the dbuf bytes it would allocate.  Every
+ * allocation is rounded up as xdr_dbuf_alloc_space() rounds it.
+ */
+static FORCE_INLINE uint64_t
+xdr_dbuf_footprint(uint64_t bytes)
+{
+    return (bytes + 7) & ~(uint64_t) 7;
+} /* xdr_dbuf_footprint */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__footprint_opaque_vector(
+    uint32_t                bound,
+    struct xdr_read_cursor *cursor,
+    uint64_t               *bytes)
+{
+    int      rc;
+    uint32_t size;
+
+    rc = __unmarshall_uint32_t_vector(&size, cursor, NULL);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    if (unlikely((bound && size > bound) || size > INT32_MAX - 8)) {
+        return -1;
+    }
+
+    /* Only values spanning a segment boundary are copied into the dbuf */
+    if (cursor->end - cursor->iov_offset < size) {
+        *bytes += xdr_dbuf_footprint(size);
+    }
+
+    rc = xdr_read_cursor_vector_skip(cursor, size + xdr_pad(size));
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    return 4 + rc;
+} /* __footprint_opaque_vector */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__footprint_opaque_contig(
+    uint32_t                bound,
+    struct xdr_read_cursor *cursor,
+    uint64_t               *bytes)
+{
+    int      rc;
+    uint32_t size;
+
+    rc = __unmarshall_uint32_t_contig(&size, cursor, NULL);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    if (unlikely((bound && size > bound) || size > INT32_MAX - 8)) {
+        return -1;
+    }
+
+    rc = xdr_read_cursor_contig_skip(cursor, size + xdr_pad(size));
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    return 4 + rc;
+} /* __footprint_opaque_contig */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__footprint_zerocopy_vector(
+    uint32_t                bound,
+    struct xdr_read_cursor *cursor,
+    uint64_t               *bytes)
+{
+    int      rc;
+    uint32_t size;
+
+    rc = __unmarshall_uint32_t_vector(&size, cursor, NULL);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    if (unlikely((bound && size > bound) || size > INT32_MAX - 8)) {
+        return -1;
+    }
+
+#if EVPL_RPC2
+    if (cursor->read_chunk && cursor->read_chunk->length &&
+        (cursor->read_chunk->xdr_position == cursor->offset ||
+         cursor->read_chunk->xdr_position == UINT32_MAX)) {
+        return 4;
+    }
+#endif /* if EVPL_RPC2 */
+
+    *bytes += xdr_dbuf_footprint(sizeof(xdr_iovec) * xdr_read_cursor_vector_segments(cursor, size));
+
+    rc = xdr_read_cursor_vector_skip(cursor, size + xdr_pad(size));
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    return 4 + rc;
+} /* __footprint_zerocopy_vector */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+__footprint_zerocopy_contig(
+    uint32_t                bound,
+    struct xdr_read_cursor *cursor,
+    uint64_t               *bytes)
+{
+    int      rc;
+    uint32_t size;
+
+    rc = __unmarshall_uint32_t_contig(&size, cursor, NULL);
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    if (unlikely((bound && size > bound) || size > INT32_MAX - 8)) {
+        return -1;
+    }
+
+#if EVPL_RPC2
+    if (cursor->read_chunk && cursor->read_chunk->length &&
+        (cursor->read_chunk->xdr_position == cursor->offset ||
+         cursor->read_chunk->xdr_position == UINT32_MAX)) {
+        return 4;
+    }
+#endif /* if EVPL_RPC2 */
+
+    rc = xdr_read_cursor_contig_skip(cursor, size + xdr_pad(size));
+    if (unlikely(rc < 0)) {
+        return rc;
+    }
+
+    *bytes += xdr_dbuf_footprint(sizeof(xdr_iovec));
+
+    return 4 + rc;
+} /* __footprint_zerocopy_contig */
+
+/*
+ * Table-driven codec.  Structs compiled with -t or -T are described by an
+ * array of field descriptors, walked by the shared interpreter below in
+ * place of inlined per-type code.  Nested types either have a table of
+ * their own or are reached through a codec of out-of-line thunks.
+ */
+enum xdr_table_kind {
+    XDR_TABLE_SCALAR,
+    XDR_TABLE_STRING,
+    XDR_TABLE_OPAQUE,
+    XDR_TABLE_ZCOPAQUE,
+    XDR_TABLE_FIXED,
+    XDR_TABLE_TYPE
+};
+
+enum xdr_table_shape {
+    XDR_TABLE_PLAIN,
+    XDR_TABLE_ARRAY,
+    XDR_TABLE_VECTOR,
+    XDR_TABLE_OPTIONAL,
+    XDR_TABLE_LIST
+};
+
+struct xdr_table_codec {
+    int (*marshall)(
+        const void              *in,
+        struct xdr_write_cursor *cursor);
+    int (*unmarshall_vector)(
+        void                   *out,
+        struct xdr_read_cursor *cursor,
+        xdr_dbuf               *dbuf);
+    int (*unmarshall_contig)(
+        void                   *out,
+        struct xdr_read_cursor *cursor,
+        xdr_dbuf               *dbuf);
+    int (*length)(
+        const void *in);
+};
+
+struct xdr_table_type;
+
+/*
+ * bound is the declared bound of a string, opaque or vector, the element
+ * count of an array or the size of a fixed opaque.  aux is the offset of
+ * the count of a vector, the hash of a hashed member or the next pointer
+ * within a list element.  size is the size of one element; for scalars
+ * swap says whether it is byte swapped on the wire.
+ */
+struct xdr_table_field {
+    uint8_t                       kind;
+    uint8_t                       shape;
+    uint8_t                       swap;
+    uint8_t                       hash;
+    uint32_t                      offset;
+    uint32_t                      aux;
+    uint32_t                      bound;
+    uint32_t                      size;
+    const struct xdr_table_type  *table;
+    const struct xdr_table_codec *codec;
+};
+
+struct xdr_table_type {
+    const struct xdr_table_field *fields;
+    uint32_t                      nfields;
+};
+
+static int
+xdr_table_marshall(
+    const struct xdr_table_type *type,
+    const void                  *in,
+    struct xdr_write_cursor     *cursor);
+
+static int
+xdr_table_unmarshall(
+    const struct xdr_table_type *type,
+    void                        *out,
+    struct xdr_read_cursor      *cursor,
+    xdr_dbuf                    *dbuf,
+    int                          contig);
+
+static int
+xdr_table_length(
+    const struct xdr_table_type *type,
+    const void                  *in);
+
+static FORCE_INLINE void
+xdr_table_copy_scalar(
+    void       *dst,
+    const void *src,
+    uint32_t    width,
+    int         swap)
+{
+    uint32_t v32;
+    uint64_t v64;
+
+    if (width == 4) {
+        memcpy(&v32, src, 4);
+        v32 = swap ? xdr_hton32(v32) : v32;
+        memcpy(dst, &v32, 4);
+    } else {
+        memcpy(&v64, src, 8);
+        v64 = swap ? xdr_hton64(v64) : v64;
+        memcpy(dst, &v64, 8);
+    }
+} /* xdr_table_copy_scalar */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+xdr_table_read_uint32(
+    uint32_t               *v,
+    struct xdr_read_cursor *cursor,
+    int                     contig)
+{
+    return contig ? __unmarshall_uint32_t_contig(v, cursor, NULL) :
+           __unmarshall_uint32_t_vector(v, cursor, NULL);
+} /* xdr_table_read_uint32 */
+
+/* Encode n consecutive elements of a field starting at p */
+static FORCE_INLINE int WARN_UNUSED_RESULT
+xdr_table_marshall_elements(
+    const struct xdr_table_field *f,
+    const char                   *p,
+    uint32_t                      n,
+    struct xdr_write_cursor      *cursor)
+{
+    uint32_t i;
+
+    switch (f->kind) {
+        case XDR_TABLE_SCALAR:
+            if (n == 1) {
+                if (unlikely(xdr_write_cursor_reserve(cursor, f->size) < 0)) {
+                    return -1;
+                }
+
+                xdr_table_copy_scalar(cursor->scratch_data + cursor->scratch_used, p, f->size, f->swap);
+                cursor->scratch_used += f->size;
+                return 0;
+            }
+            return __marshall_bulk(p, n, f->size, f->swap, cursor);
+        case XDR_TABLE_STRING:
+            return __marshall_xdr_string((const xdr_string *) p, cursor);
+        case XDR_TABLE_OPAQUE:
+            return __marshall_opaque((xdr_opaque *) p, f->bound, cursor);
+        case XDR_TABLE_ZCOPAQUE:
+            return __marshall_opaque_zerocopy((xdr_iovecr *) p, cursor);
+        case XDR_TABLE_FIXED:
+            return xdr_write_cursor_append(cursor, p, f->bound);
+        default:
+            for (i = 0; i < n; i++, p += f->size) {
+                if (unlikely((f->table ? xdr_table_marshall(f->table, p, cursor) :
+                              f->codec->marshall(p, cursor)) < 0)) {
+                    return -1;
+                }
+            }
+            return 0;
+    } /* switch */
+} /* xdr_table_marshall_elements */
+
+/* Decode n consecutive elements of a field into p, returning bytes consumed */
+static FORCE_INLINE int WARN_UNUSED_RESULT
+xdr_table_unmarshall_elements(
+    const struct xdr_table_field *f,
+    char                         *p,
+    uint32_t                      n,
+    struct xdr_read_cursor       *cursor,
+    xdr_dbuf                     *dbuf,
+    int                           contig)
+{
+    uint64_t tmp;
+    uint32_t i;
+    int      rc, len = 0;
+
+    switch (f->kind) {
+        case XDR_TABLE_SCALAR:
+            if (n == 1 && cursor->end - cursor->iov_offset >= f->size) {
+                xdr_table_copy_scalar(p, xdr_iovec_data(cursor->cur) + cursor->iov_offset, f->size, f->swap);
+                cursor->iov_offset += f->size;
+                cursor->offset     += f->size;
+                return f->size;
+            }
+
+            if (n == 1 && !contig) {
+                rc = xdr_read_cursor_vector_extract(cursor, &tmp, f->size);
+                if (unlikely(rc < 0)) {
+                    return rc;
+                }
+                xdr_table_copy_scalar(p, &tmp, f->size, f->swap);
+                return rc;
+            }
+
+            return contig ? __unmarshall_bulk_contig(p, n, f->size, f->swap, cursor) :
+                   __unmarshall_bulk_vector(p, n, f->size, f->swap, cursor);
+        case XDR_TABLE_STRING:
+            return contig ? __unmarshall_xdr_string_contig((xdr_string *) p, f->bound, cursor, dbuf) :
+                   __unmarshall_xdr_string_vector((xdr_string *) p, f->bound, cursor, dbuf);
+        case XDR_TABLE_OPAQUE:
+            return contig ? __unmarshall_opaque_contig((xdr_opaque *) p, f->bound, cursor, dbuf) :
+                   __unmarshall_opaque_vector((xdr_opaque *) p, f->bound, cursor, dbuf);
+        case XDR_TABLE_ZCOPAQUE:
+            return contig ? __unmarshall_opaque_zerocopy_contig((xdr_iovecr *) p, f->bound, cursor, dbuf) :
+                   __unmarshall_opaque_zerocopy_vector((xdr_iovecr *) p, f->bound, cursor, dbuf);
+        case XDR_TABLE_FIXED:
+            if (!contig) {
+                return xdr_read_cursor_vector_extract(cursor, p, f->bound);
+            }
+
+            if (unlikely(f->bound > cursor->end - cursor->iov_offset)) {
+                return -1;
+            }
+
+            memcpy(p, xdr_iovec_data(cursor->cur) + cursor->iov_offset, f->bound);
+            cursor->iov_offset += f->bound;
+            cursor->offset     += f->bound;
+            return f->bound;
+        default:
+            for (i = 0; i < n; i++, p += f->size) {
+                if (f->table) {
+                    rc = xdr_table_unmarshall(f->table, p, cursor, dbuf, contig);
+                } else if (contig) {
+                    rc = f->codec->unmarshall_contig(p, cursor, dbuf);
+                } else {
+                    rc = f->codec->unmarshall_vector(p, cursor, dbuf);
+                }
+
+                if (unlikely(rc < 0)) {
+                    return rc;
+                }
+
+                len += rc;
+            }
+            return len;
+    } /* switch */
+} /* xdr_table_unmarshall_elements */
+
+static FORCE_INLINE int
+xdr_table_length_elements(
+    const struct xdr_table_field *f,
+    const char                   *p,
+    uint32_t                      n)
+{
+    uint32_t i, len = 0;
+
+    switch (f->kind) {
+        case XDR_TABLE_SCALAR:
+            return n * f->size;
+        case XDR_TABLE_STRING:
+            return 4 + ((const xdr_string *) p)->len + xdr_pad(((const xdr_string *) p)->len);
+        case XDR_TABLE_OPAQUE:
+            return 4 + ((const xdr_opaque *) p)->len + xdr_pad(((const xdr_opaque *) p)->len);
+        case XDR_TABLE_ZCOPAQUE:
+            return 4 + ((const xdr_iovecr *) p)->length + xdr_pad(((const xdr_iovecr *) p)->length);
+        case XDR_TABLE_FIXED:
+            return f->bound;
+        default:
+            for (i = 0; i < n; i++, p += f->size) {
+                len += f->table ? xdr_table_length(f->table, p) : f->codec->length(p);
+            }
+            return len;
+    } /* switch */
+} /* xdr_table_length_elements */
+
+static __attribute__((noinline, unused)) int
+xdr_table_marshall(
+    const struct xdr_table_type *type,
+    const void                  *in,
+    struct xdr_write_cursor     *cursor)
+{
+    const struct xdr_table_field *f;
+    const char                   *p;
+    uint32_t                      n, more;
+
+    for (f = type->fields; f < type->fields + type->nfields; f++) {
+        p = (const char *) in + f->offset;
+        n = 1;
+
+        switch (f->shape) {
+            case XDR_TABLE_ARRAY:
+                n = f->bound;
+                break;
+            case XDR_TABLE_VECTOR:
+                n = *(const uint32_t *) ((const char *) in + f->aux);
+                p = *(const char * const *) p;
+
+                if (unlikely(__marshall_uint32_t(&n, cursor) < 0)) {
+                    return -1;
+                }
+                break;
+            case XDR_TABLE_OPTIONAL:
+            case XDR_TABLE_LIST:
+                for (p = *(const char * const *) p; ; p = *(const char * const *) (p + f->aux)) {
+                    more = p != NULL;
+
+                    if (unlikely(__marshall_uint32_t(&more, cursor) < 0)) {
+                        return -1;
+                    }
+
+                    if (!more) {
+                        break;
+                    }
+
+                    if (unlikely(xdr_table_marshall_elements(f, p, 1, cursor) < 0)) {
+                        return -1;
+                    }
+
+                    if (f->shape == XDR_TABLE_OPTIONAL) {
+                        break;
+                    }
+                }
+                continue;
+        } /* switch */
+
+        if (unlikely(xdr_table_marshall_elements(f, p, n, cursor) < 0)) {
+            return -1;
+        }
+    }
+
+    return 0;
+} /* xdr_table_marshall */
+
+static __attribute__((noinline, unused)) int
+xdr_table_unmarshall(
+    const struct xdr_table_type *type,
+    void                        *out,
+    struct xdr_read_cursor      *cursor,
+    xdr_dbuf                    *dbuf,
+    int                          contig)
+{
+    const struct xdr_table_field *f;
+    char                         *p, **link;
+    uint32_t                      n, more;
+    int                           rc, len = 0;
+
+    for (f = type->fields; f < type->fields + type->nfields; f++) {
+        p = (char *) out + f->offset;
+        n = 1;
+
+        switch (f->shape) {
+            case XDR_TABLE_ARRAY:
+                n = f->bound;
+                break;
+            case XDR_TABLE_VECTOR:
+                rc = xdr_table_read_uint32(&n, cursor, contig);
+                if (unlikely(rc < 0)) {
+                    return rc;
+                }
+                len += rc;
+
+                if (unlikely((f->bound && n > f->bound) || n > INT32_MAX / f->size)) {
+                    return -1;
+                }
+
+                *(uint32_t *) ((char *) out + f->aux) = n;
+                *(void **) p = xdr_dbuf_alloc_space(n * f->size, dbuf);
+                p            = *(char **) p;
+
+                if (unlikely(p == NULL)) {
+                    return -1;
+                }
+                break;
+            case XDR_TABLE_OPTIONAL:
+            case XDR_TABLE_LIST:
+                for (link = (char **) p; ; link = (char **) (*link + f->aux)) {
+                    *link = NULL;
+
+                    rc = xdr_table_read_uint32(&more, cursor, contig);
+                    if (unlikely(rc < 0)) {
+                        return rc;
+                    }
+                    len += rc;
+
+                    if (!more) {
+                        break;
+                    }
+
+                    *link = (char *) xdr_dbuf_alloc_space(f->size, dbuf);
+                    if (unlikely(*link == NULL)) {
+                        return -1;
+                    }
+
+                    rc = xdr_table_unmarshall_elements(f, *link, 1, cursor, dbuf, contig);
+                    if (unlikely(rc < 0)) {
+                        return rc;
+                    }
+                    len += rc;
+
+                    if (f->shape == XDR_TABLE_OPTIONAL) {
+                        break;
+                    }
+                }
+                continue;
+        } /* switch */
+
+        rc = xdr_table_unmarshall_elements(f, p, n, cursor, dbuf, contig);
+        if (unlikely(rc < 0)) {
+            return rc;
+        }
+        len += rc;
+
+        if (f->hash) {
+            *(uint32_t *) ((char *) out + f->aux) = xdr_hash(((xdr_opaque *) p)->data, ((xdr_opaque *) p)->len);
+        }
+    }
+
+    return len;
+} /* xdr_table_unmarshall */
+
+static __attribute__((noinline, unused)) int
+xdr_table_length(
+    const struct xdr_table_type *type,
+    const void                  *in)
+{
+    const struct xdr_table_field *f;
+    const char                   *p;
+    uint32_t                      n, len = 0;
+
+    for (f = type->fields; f < type->fields + type->nfields; f++) {
+        p = (const char *) in + f->offset;
+        n = 1;
+
+        switch (f->shape) {
+            case XDR_TABLE_ARRAY:
+                n = f->bound;
+                break;
+            case XDR_TABLE_VECTOR:
+                n    = *(const uint32_t *) ((const char *) in + f->aux);
+                p    = *(const char * const *) p;
+                len += 4;
+                break;
+            case XDR_TABLE_OPTIONAL:
+            case XDR_TABLE_LIST:
+                /* The length of a list element covers the rest of the list */
+                p    = *(const char * const *) p;
+                len += 4 + (p ? xdr_table_length_elements(f, p, 1) : 0);
+                continue;
+        } /* switch */
+
+        len += xdr_table_length_elements(f, p, n);
+    }
+
+    return len;
+} /* xdr_table_length */
+
 static FORCE_INLINE int
 is_ascii(
     const char *s,
@@ -1130,7 +2798,7 @@ dump_opaque(
 {
     int i;
 
-    if (is_ascii(v, length)) {
+    if (is_ascii((const char *) v, length)) {
         snprintf(out, outlen, "'%.*s' [%u bytes]", length, (const char *) v,
                  length);
         return;
@@ -1141,7 +2809,7 @@ dump_opaque(
         return;
     }
 
-    for (i = 0; i < length; ++i) {
+    for (i = 0; i < (int) length; ++i) {
         snprintf(out, outlen, "%02x", ((const uint8_t *) v)[i]);
         out    += 2;
         outlen -= 2;
@@ -1151,6 +2819,10 @@ dump_opaque(
 } /* dump_opaque */
 
 #ifndef XDR_CUSTOM_DUMP
+#ifdef __cplusplus
+/* With -x c++ this is in the header, so every unit that includes it has a copy */
+inline
+#endif /* ifdef __cplusplus */
 void
 dump_output(
     const char *format,
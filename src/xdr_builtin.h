@@ -10,6 +10,7 @@
 #include <string.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <stddef.h>
 
 typedef uint32_t xdr_bool;
 
@@ -41,15 +42,217 @@ typedef struct {
     void    *data;
 } xdr_opaque;
 
-#ifndef XDR_DBUF_DEFINED
+/*
+ * A dbuf is a bump allocator over a single buffer.  Optionally it may
+ * chain additional chunks obtained from an allocator callback when the
+ * buffer is exhausted, see xdr_dbuf_set_chunk_allocator().  Memory in
+ * earlier chunks is never moved, so pointers handed out stay valid
+ * until the dbuf is reset.
+ */
+
+typedef void *(*xdr_dbuf_chunk_alloc_t)(
+    int   bytes,
+    void *private_data);
+
+typedef void (*xdr_dbuf_chunk_free_t)(
+    void *chunk,
+    int   bytes,
+    void *private_data);
+
+struct xdr_dbuf_chunk {
+    struct xdr_dbuf_chunk *next;
+    int                    size;
+    int                    pad;
+};
+
+/*
+ * An application may supply its own struct xdr_dbuf, typically to embed
+ * extra fields, by defining it and XDR_DBUF_DEFINED before including the
+ * generated header, identically in every translation unit including the
+ * generated source.
+ *
+ * A definition with only buffer, size and used gets the single arena
+ * dbuf: allocations fail once the buffer is exhausted, and chaining, the
+ * quota and the dbuf cache are not available.  To use those as well the
+ * definition must contain every field of the one below with the same
+ * types, in any order, and set XDR_DBUF_LAYOUT to XDR_DBUF_LAYOUT_VERSION.
+ * first_buffer/first_size and chunk_* support chaining, quota/quota_left
+ * the quota and pooled the dbuf cache, and all are initialized by
+ * xdr_dbuf_init().  The version is bumped whenever this field list
+ * changes, so that an outdated definition fails with a clear message
+ * rather than a missing member error deep in the inline helpers.
+ *
+ * XDR_DBUF_EXTENDED is 1 when the full field list is available.
+ */
+#define XDR_DBUF_LAYOUT_VERSION 2
+
+#ifdef XDR_DBUF_DEFINED
+#ifdef XDR_DBUF_LAYOUT
+#if XDR_DBUF_LAYOUT != XDR_DBUF_LAYOUT_VERSION
+#error "struct xdr_dbuf supplied via XDR_DBUF_DEFINED sets an outdated XDR_DBUF_LAYOUT, see the field list documented above"
+#endif /* if XDR_DBUF_LAYOUT != XDR_DBUF_LAYOUT_VERSION */
+#define XDR_DBUF_EXTENDED       1
+#else /* ifdef XDR_DBUF_LAYOUT */
+#define XDR_DBUF_EXTENDED       0
+#endif /* ifdef XDR_DBUF_LAYOUT */
+#else /* ifdef XDR_DBUF_DEFINED */
 #define XDR_DBUF_DEFINED
+#define XDR_DBUF_LAYOUT         XDR_DBUF_LAYOUT_VERSION
+#define XDR_DBUF_EXTENDED       1
 struct xdr_dbuf {
-    void *buffer;
-    int   size;
-    int   used;
+    void                  *buffer;
+    int                    size;
+    int                    used;
+    void                  *first_buffer;
+    int                    first_size;
+    int                    chunk_size;
+    struct xdr_dbuf_chunk *chunks;
+    xdr_dbuf_chunk_alloc_t chunk_alloc;
+    xdr_dbuf_chunk_free_t  chunk_free;
+    void                  *chunk_private;
+    int                    quota;
+    int                    quota_left;
+    int                    pooled;
 };
 typedef struct xdr_dbuf xdr_dbuf;
-#endif // ifndef XDR_DBUF_DEFINED
+#endif /* ifdef XDR_DBUF_DEFINED */
+
+#if XDR_DBUF_EXTENDED
+
+/*
+ * Return the chunk allocator and quota to their defaults: no chaining
+ * and no limit.  Any chained chunks must already have been released.
+ */
+static inline void
+xdr_dbuf_clear_settings(xdr_dbuf *dbuf)
+{
+    dbuf->size          = dbuf->first_size;
+    dbuf->chunk_size    = 0;
+    dbuf->chunks        = NULL;
+    dbuf->chunk_alloc   = NULL;
+    dbuf->chunk_free    = NULL;
+    dbuf->chunk_private = NULL;
+    dbuf->quota         = 0;
+    dbuf->quota_left    = INT32_MAX;
+} /* xdr_dbuf_clear_settings */
+
+static inline void
+xdr_dbuf_init(
+    xdr_dbuf *dbuf,
+    int       bytes)
+{
+    dbuf->buffer       = malloc(bytes);
+    dbuf->used         = 0;
+    dbuf->size         = bytes;
+    dbuf->first_buffer = dbuf->buffer;
+    dbuf->first_size   = bytes;
+    dbuf->pooled       = 0;
+    xdr_dbuf_clear_settings(dbuf);
+} /* xdr_dbuf_init */
+
+static inline void *
+xdr_dbuf_chunk_malloc(
+    int   bytes,
+    void *private_data)
+{
+    return malloc(bytes);
+} /* xdr_dbuf_chunk_malloc */
+
+static inline void
+xdr_dbuf_chunk_mfree(
+    void *chunk,
+    int   bytes,
+    void *private_data)
+{
+    free(chunk);
+} /* xdr_dbuf_chunk_mfree */
+
+/*
+ * Enable chaining on an existing dbuf.  Extra chunks are at least
+ * chunk_size bytes.  Passing NULL callbacks uses malloc and free.
+ */
+static inline void
+xdr_dbuf_set_chunk_allocator(
+    xdr_dbuf              *dbuf,
+    int                    chunk_size,
+    xdr_dbuf_chunk_alloc_t chunk_alloc,
+    xdr_dbuf_chunk_free_t  chunk_free,
+    void                  *private_data)
+{
+    dbuf->chunk_size    = chunk_size;
+    dbuf->chunk_alloc   = chunk_alloc ? chunk_alloc : xdr_dbuf_chunk_malloc;
+    dbuf->chunk_free    = chunk_free ? chunk_free : xdr_dbuf_chunk_mfree;
+    dbuf->chunk_private = private_data;
+} /* xdr_dbuf_set_chunk_allocator */
+
+/*
+ * Capacity of the buffer allocations are currently carved from, which
+ * is the most recently chained chunk if there is one.
+ */
+static inline int
+xdr_dbuf_buffer_size(const xdr_dbuf *dbuf)
+{
+    if (dbuf->chunks) {
+        return dbuf->chunks->size - (int) sizeof(*dbuf->chunks);
+    }
+
+    return dbuf->first_size;
+} /* xdr_dbuf_buffer_size */
+
+/*
+ * While a quota is set, quota_left is the quota remaining as measured
+ * from the start of the current buffer, and size is the buffer capacity
+ * clamped to it.  The bump allocator's single bounds check then also
+ * enforces the quota, and only the out of line path does any accounting.
+ */
+static inline void
+xdr_dbuf_clamp_size(xdr_dbuf *dbuf)
+{
+    dbuf->size = xdr_dbuf_buffer_size(dbuf);
+
+    if (dbuf->quota && dbuf->quota_left < dbuf->size) {
+        dbuf->size = dbuf->quota_left;
+    }
+} /* xdr_dbuf_clamp_size */
+
+/*
+ * Limit the bytes handed out between resets, so that one message claiming
+ * huge lengths cannot consume the whole dbuf or its chained chunks.
+ * Allocations beyond the quota fail, which fails the unmarshall.  Padding
+ * that aligns one allocation to the next counts against the quota.  A
+ * quota of 0 removes the limit.
+ */
+static inline void
+xdr_dbuf_set_quota(
+    xdr_dbuf *dbuf,
+    int       bytes)
+{
+    dbuf->quota      = bytes;
+    dbuf->quota_left = INT32_MAX;
+
+    if (bytes && bytes <= INT32_MAX - dbuf->used) {
+        dbuf->quota_left = dbuf->used + bytes;
+    }
+
+    xdr_dbuf_clamp_size(dbuf);
+} /* xdr_dbuf_set_quota */
+
+static inline void
+xdr_dbuf_release_chunks(xdr_dbuf *dbuf)
+{
+    struct xdr_dbuf_chunk *chunk;
+
+    while (dbuf->chunks) {
+        chunk        = dbuf->chunks;
+        dbuf->chunks = chunk->next;
+        dbuf->chunk_free(chunk, chunk->size, dbuf->chunk_private);
+    }
+
+    dbuf->buffer = dbuf->first_buffer;
+    dbuf->size   = dbuf->first_size;
+} /* xdr_dbuf_release_chunks */
+
+#else /* if XDR_DBUF_EXTENDED */
 
 static inline void
 xdr_dbuf_init(
@@ -61,10 +264,30 @@ xdr_dbuf_init(
     dbuf->size   = bytes;
 } /* xdr_dbuf_init */
 
+#endif /* if XDR_DBUF_EXTENDED */
+
+static __attribute__((noinline, cold, noreturn, unused)) void
+xdr_dbuf_misuse(const char *msg)
+{
+    fprintf(stderr, "xdr_dbuf: %s\n", msg);
+    abort();
+} /* xdr_dbuf_misuse */
+
 static inline void
 xdr_dbuf_destroy(xdr_dbuf *dbuf)
 {
+#if XDR_DBUF_EXTENDED
+    if (unlikely(dbuf->pooled)) {
+        xdr_dbuf_misuse("pooled dbufs must be returned with xdr_dbuf_cache_put()");
+    }
+
+    xdr_dbuf_release_chunks(dbuf);
+    free(dbuf->first_buffer);
+    dbuf->first_buffer = NULL;
+    dbuf->first_size   = 0;
+#else /* if XDR_DBUF_EXTENDED */
     free(dbuf->buffer);
+#endif /* if XDR_DBUF_EXTENDED */
     dbuf->buffer = NULL;
     dbuf->size   = 0;
     dbuf->used   = 0;
@@ -91,9 +314,93 @@ xdr_dbuf_free(xdr_dbuf *dbuf)
 static inline void
 xdr_dbuf_reset(xdr_dbuf *dbuf)
 {
+#if XDR_DBUF_EXTENDED
+    if (unlikely(dbuf->chunks != NULL)) {
+        xdr_dbuf_release_chunks(dbuf);
+    }
+#endif /* if XDR_DBUF_EXTENDED */
     dbuf->used = 0;
+
+#if XDR_DBUF_EXTENDED
+    if (unlikely(dbuf->quota)) {
+        dbuf->quota_left = dbuf->quota;
+        xdr_dbuf_clamp_size(dbuf);
+    }
+#endif /* if XDR_DBUF_EXTENDED */
 } /* xdr_dbuf_reset */
 
+/*
+ * Out of line half of xdr_dbuf_alloc_space(), reached when an allocation
+ * does not fit below dbuf->size.  Fails allocations over the quota and
+ * otherwise chains a new chunk, if a chunk allocator is set.  A single
+ * arena dbuf simply fails.
+ */
+static __attribute__((noinline, cold, unused)) void *
+xdr_dbuf_alloc_space_chained(
+    int       isize,
+    xdr_dbuf *dbuf)
+{
+#if XDR_DBUF_EXTENDED
+    struct xdr_dbuf_chunk *chunk;
+    void                  *ptr;
+    int                    bytes;
+
+    if (isize < 0) {
+        return NULL;
+    }
+
+    if (dbuf->quota && isize > 0 && isize > dbuf->quota_left - dbuf->used) {
+        return NULL;
+    }
+
+    /* Only zero byte requests still fit, after rounding carried used past size */
+    if (isize <= xdr_dbuf_buffer_size(dbuf) - dbuf->used) {
+        ptr        = (char *) dbuf->buffer + dbuf->used;
+        dbuf->used = (dbuf->used + isize + 7) & ~7;
+        return ptr;
+    }
+
+    if (dbuf->chunk_alloc == NULL) {
+        return NULL;
+    }
+
+    bytes = dbuf->chunk_size;
+
+    if (bytes < isize) {
+        bytes = isize;
+    }
+
+    if (unlikely(bytes > INT32_MAX - (int) sizeof(*chunk))) {
+        return NULL;
+    }
+
+    bytes += sizeof(*chunk);
+
+    chunk = (struct xdr_dbuf_chunk *) dbuf->chunk_alloc(bytes, dbuf->chunk_private);
+
+    if (unlikely(chunk == NULL)) {
+        return NULL;
+    }
+
+    if (dbuf->quota) {
+        dbuf->quota_left -= dbuf->used;
+    }
+
+    chunk->next  = dbuf->chunks;
+    chunk->size  = bytes;
+    dbuf->chunks = chunk;
+
+    dbuf->buffer = chunk + 1;
+    dbuf->used   = (isize + 7) & ~7;
+
+    xdr_dbuf_clamp_size(dbuf);
+
+    return dbuf->buffer;
+#else /* if XDR_DBUF_EXTENDED */
+    return NULL;
+#endif /* if XDR_DBUF_EXTENDED */
+} /* xdr_dbuf_alloc_space_chained */
+
 static FORCE_INLINE void * WARN_UNUSED_RESULT
 xdr_dbuf_alloc_space(
     int       isize,
@@ -101,8 +408,9 @@ xdr_dbuf_alloc_space(
 {
     void *ptr;
 
-    if (unlikely(dbuf->used + isize > dbuf->size)) {
-        return NULL;
+    /* Widened so a negative isize from an oversized length also goes out of line */
+    if (unlikely((uint64_t) (uint32_t) isize + (uint32_t) dbuf->used > (uint32_t) dbuf->size)) {
+        return xdr_dbuf_alloc_space_chained(isize, dbuf);
     }
     ptr         = (char *) dbuf->buffer + dbuf->used;
     dbuf->used += isize;
@@ -110,6 +418,262 @@ xdr_dbuf_alloc_space(
     return ptr;
 } // xdr_dbuf_alloc_space
 
+/*
+ * Limits emitted per type as XDR_MAX_WIRE_SIZE_X, XDR_MAX_IOV_X and
+ * XDR_MAX_DBUF_X(niov), or XDR_UNBOUNDED when the type has none.
+ */
+#define XDR_UNBOUNDED         -1
+#define XDR_DBUF_ROUND(bytes) (((bytes) + 7) & ~(uint64_t) 7)
+#define XDR_DBUF_MAX(a, b)    ((a) > (b) ? (a) : (b))
+
+/* Generated code assigns dbuf allocations through this so it also builds as C++ */
+#ifdef __cplusplus
+#define XDR_PTR_CAST(lvalue) (decltype(lvalue))
+#else /* ifdef __cplusplus */
+#define XDR_PTR_CAST(lvalue)
+#endif /* ifdef __cplusplus */
+
+#if XDR_DBUF_EXTENDED
+
+/*
+ * Pooled dbufs.
+ *
+ * Each thread owns an xdr_dbuf_cache holding free dbufs in power of two
+ * size classes.  xdr_dbuf_cache_get() must be called by the owning
+ * thread.  xdr_dbuf_cache_put() may be called from any thread, passing
+ * that thread's own cache (or NULL): dbufs owned by another cache are
+ * pushed onto the owner's lock-free return stack, which the owner drains
+ * in one atomic exchange the next time its free list runs dry.  The
+ * cache structure stays alive until the owner has destroyed it and every
+ * dbuf it handed out has been returned.
+ *
+ * A pooled dbuf shares its allocation with the pool bookkeeping, so it
+ * must only ever be released with xdr_dbuf_cache_put(); calling
+ * xdr_dbuf_destroy() or xdr_dbuf_free() on it aborts.  Putting a dbuf
+ * back resets it and clears any chunk allocator or quota the user set,
+ * so the next user of the dbuf starts from the xdr_dbuf_init() defaults.
+ */
+
+#ifndef XDR_DBUF_CACHE_CLASSES
+#define XDR_DBUF_CACHE_CLASSES   8
+#endif /* ifndef XDR_DBUF_CACHE_CLASSES */
+
+#ifndef XDR_DBUF_CACHE_MIN_SHIFT
+#define XDR_DBUF_CACHE_MIN_SHIFT 12
+#endif /* ifndef XDR_DBUF_CACHE_MIN_SHIFT */
+
+#define XDR_DBUF_CACHE_CLOSED    ((struct xdr_dbuf_pooled *) 1)
+
+struct xdr_dbuf_cache;
+
+struct xdr_dbuf_pooled {
+    xdr_dbuf                dbuf;
+    struct xdr_dbuf_cache  *owner;
+    struct xdr_dbuf_pooled *next;
+    int                     size_class;
+};
+
+struct xdr_dbuf_cache {
+    struct xdr_dbuf_pooled *free[XDR_DBUF_CACHE_CLASSES];
+    int                     nfree[XDR_DBUF_CACHE_CLASSES];
+    int                     max_free;
+    int                     refcnt;
+    struct xdr_dbuf_pooled *remote;
+};
+
+static inline struct xdr_dbuf_cache *
+xdr_dbuf_cache_create(int max_free)
+{
+    struct xdr_dbuf_cache *cache;
+
+    cache = (struct xdr_dbuf_cache *) calloc(1, sizeof(*cache));
+
+    if (unlikely(cache == NULL)) {
+        return NULL;
+    }
+
+    cache->max_free = max_free;
+    cache->refcnt   = 1;
+
+    return cache;
+} /* xdr_dbuf_cache_create */
+
+static inline void
+xdr_dbuf_cache_unref(struct xdr_dbuf_cache *cache)
+{
+    if (__atomic_sub_fetch(&cache->refcnt, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(cache);
+    }
+} /* xdr_dbuf_cache_unref */
+
+static inline void
+xdr_dbuf_pooled_free(struct xdr_dbuf_pooled *pooled)
+{
+    struct xdr_dbuf_cache *owner = pooled->owner;
+
+    xdr_dbuf_release_chunks(&pooled->dbuf);
+    free(pooled);
+
+    if (owner) {
+        xdr_dbuf_cache_unref(owner);
+    }
+} /* xdr_dbuf_pooled_free */
+
+static inline void
+xdr_dbuf_cache_stash(
+    struct xdr_dbuf_cache  *cache,
+    struct xdr_dbuf_pooled *pooled)
+{
+    int size_class = pooled->size_class;
+
+    if (cache->nfree[size_class] >= cache->max_free) {
+        xdr_dbuf_pooled_free(pooled);
+        return;
+    }
+
+    pooled->next            = cache->free[size_class];
+    cache->free[size_class] = pooled;
+    cache->nfree[size_class]++;
+} /* xdr_dbuf_cache_stash */
+
+static inline void
+xdr_dbuf_cache_drain(struct xdr_dbuf_cache *cache)
+{
+    struct xdr_dbuf_pooled *list, *pooled;
+
+    list = __atomic_exchange_n(&cache->remote, NULL, __ATOMIC_ACQUIRE);
+
+    while (list) {
+        pooled = list;
+        list   = list->next;
+        xdr_dbuf_cache_stash(cache, pooled);
+    }
+} /* xdr_dbuf_cache_drain */
+
+static inline xdr_dbuf *
+xdr_dbuf_cache_get(
+    struct xdr_dbuf_cache *cache,
+    int                    bytes)
+{
+    struct xdr_dbuf_pooled *pooled;
+    int                     size_class = 0;
+
+    while (size_class < XDR_DBUF_CACHE_CLASSES &&
+           (1 << (size_class + XDR_DBUF_CACHE_MIN_SHIFT)) < bytes) {
+        size_class++;
+    }
+
+    if (size_class < XDR_DBUF_CACHE_CLASSES) {
+
+        if (cache->free[size_class] == NULL &&
+            __atomic_load_n(&cache->remote, __ATOMIC_RELAXED)) {
+            xdr_dbuf_cache_drain(cache);
+        }
+
+        pooled = cache->free[size_class];
+
+        if (pooled) {
+            cache->free[size_class] = pooled->next;
+            cache->nfree[size_class]--;
+            return &pooled->dbuf;
+        }
+
+        bytes = 1 << (size_class + XDR_DBUF_CACHE_MIN_SHIFT);
+    }
+
+    pooled = (struct xdr_dbuf_pooled *) malloc(sizeof(*pooled) + bytes);
+
+    if (unlikely(pooled == NULL)) {
+        return NULL;
+    }
+
+    pooled->dbuf.buffer       = pooled + 1;
+    pooled->dbuf.size         = bytes;
+    pooled->dbuf.used         = 0;
+    pooled->dbuf.first_buffer = pooled->dbuf.buffer;
+    pooled->dbuf.first_size   = bytes;
+    pooled->dbuf.pooled       = 1;
+    pooled->size_class        = size_class;
+    pooled->next              = NULL;
+
+    xdr_dbuf_clear_settings(&pooled->dbuf);
+
+    if (size_class < XDR_DBUF_CACHE_CLASSES) {
+        pooled->owner = cache;
+        __atomic_add_fetch(&cache->refcnt, 1, __ATOMIC_RELAXED);
+    } else {
+        pooled->owner = NULL;
+    }
+
+    return &pooled->dbuf;
+} /* xdr_dbuf_cache_get */
+
+static inline void
+xdr_dbuf_cache_put(
+    struct xdr_dbuf_cache *cache,
+    xdr_dbuf              *dbuf)
+{
+    struct xdr_dbuf_pooled *pooled = (struct xdr_dbuf_pooled *) dbuf;
+    struct xdr_dbuf_cache  *owner  = pooled->owner;
+    struct xdr_dbuf_pooled *head;
+
+    if (unlikely(!dbuf->pooled)) {
+        xdr_dbuf_misuse("xdr_dbuf_cache_put() called on a dbuf that is not pooled");
+    }
+
+    xdr_dbuf_reset(dbuf);
+    xdr_dbuf_clear_settings(dbuf);
+
+    if (owner == NULL) {
+        xdr_dbuf_pooled_free(pooled);
+    } else if (owner == cache) {
+        xdr_dbuf_cache_stash(cache, pooled);
+    } else {
+        head = __atomic_load_n(&owner->remote, __ATOMIC_RELAXED);
+
+        do {
+            if (unlikely(head == XDR_DBUF_CACHE_CLOSED)) {
+                xdr_dbuf_pooled_free(pooled);
+                return;
+            }
+            pooled->next = head;
+        } while (!__atomic_compare_exchange_n(&owner->remote, &head, pooled, 1,
+                                              __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+} /* xdr_dbuf_cache_put */
+
+/*
+ * Called by the owning thread.  Cached dbufs are freed immediately;
+ * dbufs still in use are freed when they are put back.
+ */
+static inline void
+xdr_dbuf_cache_destroy(struct xdr_dbuf_cache *cache)
+{
+    struct xdr_dbuf_pooled *list, *pooled;
+    int                     i;
+
+    for (i = 0; i < XDR_DBUF_CACHE_CLASSES; i++) {
+        while (cache->free[i]) {
+            pooled         = cache->free[i];
+            cache->free[i] = pooled->next;
+            xdr_dbuf_pooled_free(pooled);
+        }
+        cache->nfree[i] = 0;
+    }
+
+    list = __atomic_exchange_n(&cache->remote, XDR_DBUF_CACHE_CLOSED, __ATOMIC_ACQUIRE);
+
+    while (list) {
+        pooled = list;
+        list   = list->next;
+        xdr_dbuf_pooled_free(pooled);
+    }
+
+    xdr_dbuf_cache_unref(cache);
+} /* xdr_dbuf_cache_destroy */
+
+#endif /* if XDR_DBUF_EXTENDED */
+
 static FORCE_INLINE int WARN_UNUSED_RESULT
 xdr_dbuf_alloc_opaque(
     xdr_opaque *opaque,
@@ -148,7 +712,7 @@ xdr_dbuf_alloc_string(
     xdr_dbuf   *dbuf)
 {
     string->len = ilen;
-    string->str = xdr_dbuf_alloc_space(ilen, dbuf);
+    string->str = (char *) xdr_dbuf_alloc_space(ilen, dbuf);
     if (unlikely(string->str == NULL)) {
         return -1;
     }
@@ -202,10 +766,19 @@ __xdr_dbuf_alloc_array(
 #include TOSTRING(XDR_CUSTOM_IOVEC)
 #else  /* ifdef XDR_CUSTOM_IOVEC */
 
+#ifdef XDR_IOVEC_NATIVE
+/*
+ * Layout compatible with struct iovec, so marshalled output can be
+ * handed to writev(), sendmsg() or io_uring without translation.
+ */
+#include <sys/uio.h>
+typedef struct iovec xdr_iovec;
+#else  /* ifdef XDR_IOVEC_NATIVE */
 typedef struct {
     void    *iov_base;
     uint32_t iov_len;
 } xdr_iovec;
+#endif /* ifdef XDR_IOVEC_NATIVE */
 
 #define xdr_iovec_data(iov)          ((iov)->iov_base)
 #define xdr_iovec_len(iov)           ((iov)->iov_len)
@@ -224,14 +797,1320 @@ typedef struct {
             (out)->iov_len  = (in)->iov_len; \
         } while (0)
 
+#define xdr_iovec_can_merge(prev, next) \
+        ((char *) (prev)->iov_base + (prev)->iov_len == (char *) (next)->iov_base)
+#define xdr_iovec_merge(prev, next)     ((prev)->iov_len += (next)->iov_len)
+
+#define xdr_iovec_set_static(iov, ptr, len) \
+        do { \
+            (iov)->iov_base = (void *) (ptr); \
+            (iov)->iov_len  = (len); \
+        } while (0)
+
 #endif /* ifdef XDR_CUSTOM_IOVEC */
 
+/*
+ * Output coalescing hooks.  A custom iovec header may define
+ * xdr_iovec_can_merge()/xdr_iovec_merge() to allow adjacent entries
+ * to be combined (merge must release the private data of next), and
+ * xdr_iovec_set_static() if an iovec may reference static memory.
+ */
+#ifndef xdr_iovec_can_merge
+#define xdr_iovec_can_merge(prev, next) 0
+#define xdr_iovec_merge(prev, next)     do { } while (0)
+#endif /* ifndef xdr_iovec_can_merge */
+
+/*
+ * Encoded lengths are returned as int, so no more than INT32_MAX bytes
+ * of an iovec can ever be consumed.  Larger lengths, possible with
+ * XDR_IOVEC_NATIVE or a custom iovec, are clamped rather than
+ * truncated when they are stored in cursor state.
+ */
+#define xdr_iovec_len32(iov) \
+        ((uint32_t) (xdr_iovec_len(iov) > INT32_MAX ? INT32_MAX : xdr_iovec_len(iov)))
+
 typedef struct {
     xdr_iovec *iov;
     int        niov;
     uint32_t   length;
 } xdr_iovecr;
 
+/*
+ * CRC32C (Castagnoli), as used by iSCSI and NVMe/TCP.  Cursors with a
+ * digest enabled fold in the bytes they emit or consume as they go, so
+ * an integrity check needs no separate pass over the encoding.  The
+ * SSE4.2 or ARMv8 CRC instructions are used when the target has them.
+ * On x86-64 builds that do not assume SSE4.2 the instruction is still
+ * used if the running CPU has it, selected on first use; otherwise a
+ * slicing-by-8 table is used.
+ */
+#if defined(__SSE4_2__) && defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#else  /* if defined(__SSE4_2__) && defined(__x86_64__) */
+#define XDR_CRC32C_SOFT 1
+#if defined(__x86_64__) && !defined(XDR_SIMD_DISABLE)
+#define XDR_CRC32C_DISPATCH 1
+#include <nmmintrin.h>
+#endif /* if defined(__x86_64__) && !defined(XDR_SIMD_DISABLE) */
+#endif /* if defined(__SSE4_2__) && defined(__x86_64__) */
+
+#define XDR_CRC32C_POLY 0x82f63b78
+
+#ifdef XDR_CRC32C_SOFT
+
+#define XDR_CRC32C_UNKNOWN 0
+#define XDR_CRC32C_BUSY    1
+#define XDR_CRC32C_TABLE   2
+#define XDR_CRC32C_SSE42   3
+
+static int      xdr_crc32c_impl = XDR_CRC32C_UNKNOWN;
+static uint32_t xdr_crc32c_table[8][256];
+
+/* Bytewise, used only while the first caller builds the table */
+static __attribute__((unused)) uint32_t
+xdr_crc32c_nibble(
+    uint32_t       crc,
+    const uint8_t *p,
+    size_t         len)
+{
+    static const uint32_t nibble[16] = {
+        0x00000000, 0x105ec76f, 0x20bd8ede, 0x30e349b1,
+        0x417b1dbc, 0x5125dad3, 0x61c69362, 0x7198540d,
+        0x82f63b78, 0x92a8fc17, 0xa24bb5a6, 0xb21572c9,
+        0xc38d26c4, 0xd3d3e1ab, 0xe330a81a, 0xf36e6f75
+    };
+
+    for (; len; len--) {
+        crc ^= *p++;
+        crc  = (crc >> 4) ^ nibble[crc & 0xf];
+        crc  = (crc >> 4) ^ nibble[crc & 0xf];
+    }
+
+    return crc;
+} /* xdr_crc32c_nibble */
+
+/* Slicing-by-8 over the table, on an inverted crc like the other kernels */
+static __attribute__((unused)) uint32_t
+xdr_crc32c_slice8(
+    uint32_t       crc,
+    const uint8_t *p,
+    size_t         len)
+{
+    uint32_t lo, hi;
+
+    for (; len && ((uintptr_t) p & 7); len--) {
+        crc = (crc >> 8) ^ xdr_crc32c_table[0][(crc ^ *p++) & 0xff];
+    }
+
+    for (; len >= 8; len -= 8, p += 8) {
+        lo = crc ^ ((uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24);
+        hi = (uint32_t) p[4] | (uint32_t) p[5] << 8 | (uint32_t) p[6] << 16 | (uint32_t) p[7] << 24;
+
+        crc = xdr_crc32c_table[7][lo & 0xff] ^
+            xdr_crc32c_table[6][(lo >> 8) & 0xff] ^
+            xdr_crc32c_table[5][(lo >> 16) & 0xff] ^
+            xdr_crc32c_table[4][lo >> 24] ^
+            xdr_crc32c_table[3][hi & 0xff] ^
+            xdr_crc32c_table[2][(hi >> 8) & 0xff] ^
+            xdr_crc32c_table[1][(hi >> 16) & 0xff] ^
+            xdr_crc32c_table[0][hi >> 24];
+    }
+
+    for (; len; len--) {
+        crc = (crc >> 8) ^ xdr_crc32c_table[0][(crc ^ *p++) & 0xff];
+    }
+
+    return crc;
+} /* xdr_crc32c_slice8 */
+
+#ifdef XDR_CRC32C_DISPATCH
+__attribute__((target("sse4.2"), unused)) static uint32_t
+xdr_crc32c_sse42(
+    uint32_t       crc,
+    const uint8_t *p,
+    size_t         len)
+{
+    uint64_t v, crc64 = crc;
+
+    for (; len >= 8; len -= 8, p += 8) {
+        memcpy(&v, p, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+    }
+
+    crc = (uint32_t) crc64;
+
+    for (; len; len--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+
+    return crc;
+} /* xdr_crc32c_sse42 */
+#endif /* ifdef XDR_CRC32C_DISPATCH */
+
+/*
+ * One caller builds the table; any others racing with it use the
+ * bytewise loop until it is ready.
+ */
+static __attribute__((noinline, cold, unused)) int
+xdr_crc32c_build_table(void)
+{
+    uint32_t c;
+    int      i, k, impl = XDR_CRC32C_UNKNOWN;
+
+    if (!__atomic_compare_exchange_n(&xdr_crc32c_impl, &impl, XDR_CRC32C_BUSY, 0,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        return impl;
+    }
+
+    for (i = 0; i < 256; i++) {
+        c = i;
+
+        for (k = 0; k < 8; k++) {
+            c = c & 1 ? (c >> 1) ^ XDR_CRC32C_POLY : c >> 1;
+        }
+
+        xdr_crc32c_table[0][i] = c;
+    }
+
+    for (i = 0; i < 256; i++) {
+        for (k = 1; k < 8; k++) {
+            c                      = xdr_crc32c_table[k - 1][i];
+            xdr_crc32c_table[k][i] = (c >> 8) ^ xdr_crc32c_table[0][c & 0xff];
+        }
+    }
+
+    __atomic_store_n(&xdr_crc32c_impl, XDR_CRC32C_TABLE, __ATOMIC_RELEASE);
+
+    return XDR_CRC32C_TABLE;
+} /* xdr_crc32c_build_table */
+
+/* Pick the implementation on first use */
+static __attribute__((noinline, cold, unused)) int
+xdr_crc32c_detect(void)
+{
+#ifdef XDR_CRC32C_DISPATCH
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("sse4.2")) {
+        __atomic_store_n(&xdr_crc32c_impl, XDR_CRC32C_SSE42, __ATOMIC_RELEASE);
+        return XDR_CRC32C_SSE42;
+    }
+#endif /* ifdef XDR_CRC32C_DISPATCH */
+
+    return xdr_crc32c_build_table();
+} /* xdr_crc32c_detect */
+
+#endif /* ifdef XDR_CRC32C_SOFT */
+
+static inline uint32_t
+xdr_crc32c(
+    uint32_t    crc,
+    const void *data,
+    size_t      len)
+{
+    const uint8_t *p = (const uint8_t *) data;
+
+    crc = ~crc;
+
+#if defined(__SSE4_2__) && defined(__x86_64__)
+    uint64_t v, crc64 = crc;
+
+    for (; len >= 8; len -= 8, p += 8) {
+        memcpy(&v, p, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+    }
+
+    crc = (uint32_t) crc64;
+
+    for (; len; len--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+#elif defined(__ARM_FEATURE_CRC32)
+    uint64_t v;
+
+    for (; len >= 8; len -= 8, p += 8) {
+        memcpy(&v, p, 8);
+        crc = __crc32cd(crc, v);
+    }
+
+    for (; len; len--) {
+        crc = __crc32cb(crc, *p++);
+    }
+#else  /* if defined(__SSE4_2__) && defined(__x86_64__) */
+    int impl = __atomic_load_n(&xdr_crc32c_impl, __ATOMIC_ACQUIRE);
+
+    if (unlikely(impl < XDR_CRC32C_TABLE)) {
+        impl = xdr_crc32c_detect();
+    }
+
+    switch (impl) {
+#ifdef XDR_CRC32C_DISPATCH
+        case XDR_CRC32C_SSE42:
+            crc = xdr_crc32c_sse42(crc, p, len);
+            break;
+#endif /* ifdef XDR_CRC32C_DISPATCH */
+        case XDR_CRC32C_TABLE:
+            crc = xdr_crc32c_slice8(crc, p, len);
+            break;
+        default:
+            crc = xdr_crc32c_nibble(crc, p, len);
+            break;
+    } /* switch */
+#endif /* if defined(__SSE4_2__) && defined(__x86_64__) */
+
+    return ~crc;
+} /* xdr_crc32c */
+
+/* Product of two polynomials modulo the CRC32C polynomial, a != 0 */
+static inline uint32_t
+xdr_crc32c_multmodp(
+    uint32_t a,
+    uint32_t b)
+{
+    uint32_t m = 1U << 31, p = 0;
+
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        b   = b & 1 ? (b >> 1) ^ XDR_CRC32C_POLY : b >> 1;
+    }
+
+    return p;
+} /* xdr_crc32c_multmodp */
+
+/*
+ * Advance a raw (zero seeded, not inverted) CRC over n zero bytes.
+ * Since CRCs are linear, this gives the change in a digest when bytes
+ * n positions before its end are modified after they were folded in.
+ */
+static inline uint32_t
+xdr_crc32c_shift(
+    uint32_t crc,
+    uint32_t n)
+{
+    uint32_t x = 1U << 23; /* x^8 */
+
+    while (n) {
+        if (n & 1) {
+            crc = xdr_crc32c_multmodp(x, crc);
+        }
+        x   = xdr_crc32c_multmodp(x, x);
+        n >>= 1;
+    }
+
+    return crc;
+} /* xdr_crc32c_shift */
+
+/*
+ * Fast non-cryptographic hash stored for members marked %xdrzcc hash,
+ * for use as a lookup key by directory, id mapping and handle caches.
+ * Words are read in host order, so values are only comparable between
+ * hosts of the same byte order.
+ */
+static inline uint32_t
+xdr_hash(
+    const void *data,
+    uint32_t    len)
+{
+    const uint8_t *p = (const uint8_t *) data;
+    uint64_t       h = 0x9e3779b97f4a7c15ULL ^ len, v;
+
+    for (; len >= 8; len -= 8, p += 8) {
+        memcpy(&v, p, 8);
+        h  = (h ^ v) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+
+    if (len) {
+        v = 0;
+        memcpy(&v, p, len);
+        h = (h ^ v) * 0xff51afd7ed558ccdULL;
+    }
+
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return (uint32_t) h;
+} /* xdr_hash */
+
+/*
+ * Write cursor.  Encoded output is accumulated in runs of the scratch
+ * buffer and emitted as iovecs, interleaved with iovecs referencing
+ * zero-copy payloads.  If a refill callback is set, running out of
+ * scratch space or output iovecs calls it instead of failing.  The
+ * callback must make at least the requested scratch bytes and iovec
+ * slots available using xdr_write_cursor_set_iov() and/or
+ * xdr_write_cursor_set_scratch(), or return -1.
+ */
+
+/*
+ * zcopaque payloads shorter than this many bytes are copied into the
+ * scratch buffer instead of being referenced by their own iovecs.
+ * May be overridden per cursor with xdr_write_cursor_set_zc_inline().
+ */
+#ifndef XDR_ZC_INLINE_THRESHOLD
+#define XDR_ZC_INLINE_THRESHOLD 0
+#endif /* ifndef XDR_ZC_INLINE_THRESHOLD */
+
+/*
+ * marshall_X_batch() prefetches the strings, opaques and vectors that
+ * the message this many places ahead points to.  Those are scattered,
+ * unlike the input array and the output, which are walked in order.
+ */
+#ifndef XDR_BATCH_PREFETCH_DISTANCE
+#define XDR_BATCH_PREFETCH_DISTANCE 8
+#endif /* ifndef XDR_BATCH_PREFETCH_DISTANCE */
+
+struct xdr_write_cursor;
+
+typedef int (*xdr_write_cursor_refill_t)(
+    struct xdr_write_cursor *cursor,
+    unsigned int             bytes,
+    int                      iovs,
+    void                    *private_data);
+
+struct xdr_write_cursor {
+    xdr_iovec                   *iov;
+    int                          niov;
+    int                          maxiov;
+    xdr_iovec                   *scratch_iov;
+    void                        *scratch_data;
+    int                          scratch_size;
+    int                          scratch_used;
+    int                          scratch_reserved;
+    int                          total;
+    struct evpl_rpc2_rdma_chunk *rdma_chunk;
+    xdr_write_cursor_refill_t    refill;
+    void                        *refill_private;
+    uint32_t                     zc_inline_threshold;
+    int                          coalesce;
+    int                          pad_pending;
+    int                          digest;
+    uint32_t                     crc;
+    int                          dry_run;
+};
+
+static FORCE_INLINE void
+xdr_write_cursor_init(
+    struct xdr_write_cursor     *cursor,
+    xdr_iovec                   *scratch_iov,
+    xdr_iovec                   *out_iov,
+    int                          out_niov,
+    struct evpl_rpc2_rdma_chunk *rdma_chunk,
+    int                          out_offset)
+{
+    cursor->iov                 = out_iov;
+    cursor->niov                = 0;
+    cursor->maxiov              = out_niov;
+    cursor->scratch_iov         = scratch_iov;
+    cursor->rdma_chunk          = rdma_chunk;
+    cursor->scratch_used        = out_offset;
+    cursor->scratch_reserved    = out_offset;
+    cursor->scratch_data        = xdr_iovec_data(scratch_iov);
+    cursor->scratch_size        = xdr_iovec_len32(scratch_iov);
+    cursor->refill              = NULL;
+    cursor->refill_private      = NULL;
+    cursor->zc_inline_threshold = XDR_ZC_INLINE_THRESHOLD;
+    cursor->coalesce            = 0;
+    cursor->pad_pending         = 0;
+    cursor->digest              = 0;
+    cursor->crc                 = 0;
+    cursor->dry_run             = 0;
+
+    xdr_iovec_set_len(scratch_iov, 0);
+
+    cursor->total = 0;
+
+} /* xdr_write_cursor_init */
+
+static inline void
+xdr_write_cursor_set_refill(
+    struct xdr_write_cursor  *cursor,
+    xdr_write_cursor_refill_t refill,
+    void                     *private_data)
+{
+    cursor->refill         = refill;
+    cursor->refill_private = private_data;
+} /* xdr_write_cursor_set_refill */
+
+static inline void
+xdr_write_cursor_set_zc_inline(
+    struct xdr_write_cursor *cursor,
+    uint32_t                 threshold)
+{
+    cursor->zc_inline_threshold = threshold;
+} /* xdr_write_cursor_set_zc_inline */
+
+/*
+ * When enabled, adjacent output iovecs referencing contiguous memory
+ * are merged, and pads following zero-copy payloads that would form a
+ * scratch run of their own reference a shared static zero buffer.
+ */
+static inline void
+xdr_write_cursor_set_coalesce(
+    struct xdr_write_cursor *cursor,
+    int                      enable)
+{
+    cursor->coalesce = enable;
+} /* xdr_write_cursor_set_coalesce */
+
+/*
+ * The write cursor settings marshall_requirements_X() runs the encoder
+ * with, with the same meaning as on the cursor.  rdma_max_length is the
+ * max_length of the RDMA chunk passed to the encoder, or 0 if there is
+ * none.  Passing a NULL config models a plain marshall_X() call.
+ */
+struct xdr_marshall_config {
+    uint32_t zc_inline_threshold;
+    int      coalesce;
+    uint32_t rdma_max_length;
+};
+
+static inline void
+xdr_marshall_config_init(struct xdr_marshall_config *config)
+{
+    config->zc_inline_threshold = XDR_ZC_INLINE_THRESHOLD;
+    config->coalesce            = 0;
+    config->rdma_max_length     = 0;
+} /* xdr_marshall_config_init */
+
+/*
+ * Keep a CRC32C of the encoding, excluding any out_offset reserve.
+ * Scratch runs are folded in as they are flushed and zero-copy payloads
+ * as they are referenced, so the digest is complete once
+ * xdr_write_cursor_finish() has been called.
+ */
+static inline void
+xdr_write_cursor_set_digest(
+    struct xdr_write_cursor *cursor,
+    int                      enable)
+{
+    cursor->digest = enable;
+} /* xdr_write_cursor_set_digest */
+
+static inline uint32_t
+xdr_write_cursor_digest(const struct xdr_write_cursor *cursor)
+{
+    return cursor->crc;
+} /* xdr_write_cursor_digest */
+
+/* Fold a flushed scratch run into the digest, skipping the reserve */
+static FORCE_INLINE void
+xdr_write_cursor_digest_run(struct xdr_write_cursor *cursor)
+{
+    int skip = 0;
+
+    if (cursor->total < cursor->scratch_reserved) {
+        skip = cursor->scratch_reserved - cursor->total;
+    }
+
+    cursor->crc = xdr_crc32c(cursor->crc, (const char *) cursor->scratch_data + skip,
+                             cursor->scratch_used - skip);
+} /* xdr_write_cursor_digest_run */
+
+static __attribute__((noinline, cold, unused)) int
+xdr_write_cursor_refill(
+    struct xdr_write_cursor *cursor,
+    unsigned int             bytes,
+    int                      iovs)
+{
+    int need = iovs;
+
+    if (cursor->refill == NULL) {
+        return -1;
+    }
+
+    /* The current scratch run is flushed before switching buffers */
+    if (bytes && cursor->scratch_used) {
+        need++;
+    }
+
+    if (unlikely(cursor->refill(cursor, bytes, need, cursor->refill_private) < 0)) {
+        return -1;
+    }
+
+    if (unlikely(cursor->maxiov - cursor->niov < iovs ||
+                 (unsigned int) (cursor->scratch_size - cursor->scratch_used) < bytes)) {
+        return -1;
+    }
+
+    return 0;
+} /* xdr_write_cursor_refill */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+xdr_write_cursor_reserve(
+    struct xdr_write_cursor *cursor,
+    unsigned int             bytes)
+{
+    if (unlikely(cursor->scratch_used + bytes > (unsigned int) cursor->scratch_size)) {
+        return xdr_write_cursor_refill(cursor, bytes, 0);
+    }
+
+    return 0;
+} /* xdr_write_cursor_reserve */
+
+/*
+ * Reference in from out with op, xdr_iovec_move_private() or
+ * xdr_iovec_copy_private().  A dry run never takes, shares or releases
+ * the private data of an iovec, so it copies the iovec as it is.
+ */
+#define xdr_write_cursor_ref(cursor, out, in, op) \
+        do { \
+            if (unlikely((cursor)->dry_run)) { \
+                *(out) = *(in); \
+            } else { \
+                op(out, in); \
+            } \
+        } while (0)
+
+/*
+ * Append an iovec to the output, merging it into the previous entry
+ * when coalescing is enabled and the two are contiguous.
+ */
+static inline int WARN_UNUSED_RESULT
+xdr_write_cursor_emit(
+    struct xdr_write_cursor *cursor,
+    xdr_iovec               *next)
+{
+    xdr_iovec *prev, *iov;
+
+    if (cursor->coalesce && cursor->niov) {
+        prev = &cursor->iov[cursor->niov - 1];
+
+        if (xdr_iovec_can_merge(prev, next)) {
+            if (unlikely(cursor->dry_run)) {
+                xdr_iovec_set_len(prev, xdr_iovec_len(prev) + xdr_iovec_len(next));
+            } else {
+                xdr_iovec_merge(prev, next);
+            }
+            return 0;
+        }
+    }
+
+    if (unlikely(cursor->niov + 1 > cursor->maxiov)) {
+        if (unlikely(xdr_write_cursor_refill(cursor, 0, 1) < 0)) {
+            return -1;
+        }
+    }
+
+    iov = &cursor->iov[cursor->niov++];
+
+    xdr_write_cursor_ref(cursor, iov, next, xdr_iovec_move_private);
+
+    return 0;
+} /* xdr_write_cursor_emit */
+
+static __attribute__((noinline, unused)) int
+xdr_write_cursor_flush_coalesce(struct xdr_write_cursor *cursor)
+{
+    xdr_iovec tmp;
+
+#ifdef xdr_iovec_set_static
+    static const uint32_t zero = 0;
+
+    if (cursor->pad_pending && cursor->scratch_used == cursor->pad_pending) {
+        if (cursor->digest) {
+            cursor->crc = xdr_crc32c(cursor->crc, &zero, cursor->pad_pending);
+        }
+
+        xdr_iovec_set_static(&tmp, &zero, cursor->pad_pending);
+
+        if (unlikely(xdr_write_cursor_emit(cursor, &tmp) < 0)) {
+            return -1;
+        }
+
+        cursor->total       += cursor->scratch_used;
+        cursor->scratch_used = 0;
+        cursor->pad_pending  = 0;
+        return 0;
+    }
+#endif /* ifdef xdr_iovec_set_static */
+
+    cursor->pad_pending = 0;
+
+    if (cursor->digest) {
+        xdr_write_cursor_digest_run(cursor);
+    }
+
+    xdr_write_cursor_ref(cursor, &tmp, cursor->scratch_iov, xdr_iovec_copy_private);
+    xdr_iovec_set_data(&tmp, cursor->scratch_data);
+    xdr_iovec_set_len(&tmp, cursor->scratch_used);
+
+    if (unlikely(xdr_write_cursor_emit(cursor, &tmp) < 0)) {
+        return -1;
+    }
+
+    xdr_iovec_set_len(cursor->scratch_iov, xdr_iovec_len(cursor->scratch_iov) + cursor->scratch_used);
+
+    cursor->scratch_data  = (char *) cursor->scratch_data + cursor->scratch_used;
+    cursor->scratch_size -= cursor->scratch_used;
+    cursor->total        += cursor->scratch_used;
+    cursor->scratch_used  = 0;
+
+    return 0;
+} /* xdr_write_cursor_flush_coalesce */
+
+static FORCE_INLINE int WARN_UNUSED_RESULT
+xdr_write_cursor_flush(struct xdr_write_cursor *cursor)
+{
+    xdr_iovec *iov;
+
+    if (cursor->scratch_used && cursor->coalesce) {
+        return xdr_write_cursor_flush_coalesce(cursor);
+    }
+
+    if (cursor->scratch_used) {
+
+        if (unlikely(cursor->niov + 1 > cursor->maxiov)) {
+            if (unlikely(xdr_write_cursor_refill(cursor, 0, 1) < 0)) {
+                return -1;
+            }
+        }
+
+        if (unlikely(cursor->digest)) {
+            xdr_write_cursor_digest_run(cursor);
+        }
+
+        iov = &cursor->iov[cursor->niov++];
+
+        xdr_write_cursor_ref(cursor, iov, cursor->scratch_iov, xdr_iovec_copy_private);
+        xdr_iovec_set_data(iov, cursor->scratch_data);
+        xdr_iovec_set_len(iov, cursor->scratch_used);
+
+        xdr_iovec_set_len(cursor->scratch_iov, xdr_iovec_len(cursor->scratch_iov) + cursor->scratch_used);
+
+        cursor->scratch_data  = (char *) cursor->scratch_data + cursor->scratch_used;
+        cursor->scratch_size -= cursor->scratch_used;
+        cursor->total        += cursor->scratch_used;
+        cursor->scratch_used  = 0;
+    }
+
+    return 0;
+} /* xdr_write_cursor_flush */
+
+/*
+ * Switch the cursor to a new output iovec array.  Entries already
+ * emitted are moved into the new array, which must be able to hold
+ * them.  The caller then finds the complete output in cursor->iov.
+ */
+static inline int WARN_UNUSED_RESULT
+xdr_write_cursor_set_iov(
+    struct xdr_write_cursor *cursor,
+    xdr_iovec               *iov,
+    int                      maxiov)
+{
+    int i;
+
+    if (unlikely(maxiov < cursor->niov)) {
+        return -1;
+    }
+
+    if (iov != cursor->iov) {
+        for (i = 0; i < cursor->niov; i++) {
+            xdr_iovec_move_private(&iov[i], &cursor->iov[i]);
+        }
+    }
+
+    cursor->iov    = iov;
+    cursor->maxiov = maxiov;
+
+    return 0;
+} /* xdr_write_cursor_set_iov */
+
+/*
+ * Continue encoding into a new scratch buffer.  The current run is
+ * flushed first; as with the initial scratch iovec, the length of each
+ * scratch iovec is updated to the number of bytes consumed from it.
+ */
+static inline int WARN_UNUSED_RESULT
+xdr_write_cursor_set_scratch(
+    struct xdr_write_cursor *cursor,
+    xdr_iovec               *scratch_iov)
+{
+    if (unlikely(xdr_write_cursor_flush(cursor) < 0)) {
+        return -1;
+    }
+
+    cursor->scratch_iov  = scratch_iov;
+    cursor->scratch_data = xdr_iovec_data(scratch_iov);
+    cursor->scratch_size = xdr_iovec_len32(scratch_iov);
+
+    xdr_iovec_set_len(scratch_iov, 0);
+
+    return 0;
+} /* xdr_write_cursor_set_scratch */
+
+/*
+ * Flush any pending scratch run; returns the total encoded length.
+ */
+static inline int WARN_UNUSED_RESULT
+xdr_write_cursor_finish(struct xdr_write_cursor *cursor)
+{
+    if (unlikely(xdr_write_cursor_flush(cursor) < 0)) {
+        return -1;
+    }
+
+    return cursor->total;
+} /* xdr_write_cursor_finish */
+
+/*
+ * A dry run drives the real encoder through a write cursor without
+ * producing output, to find the scratch space and output iovecs it
+ * would consume with one large enough scratch buffer and iovec array.
+ * Scratch runs are written to a private discard buffer, which is only
+ * replaced when a single run outgrows it, and output iovecs are counted
+ * in a window that keeps just the last entry, the only one coalescing
+ * can still merge into.  Iovecs are copied without their private data
+ * being taken, so the message is left as it was.
+ */
+#define XDR_DRY_RUN_DISCARD 1024
+#define XDR_DRY_RUN_WINDOW  16
+
+struct xdr_write_dry_run {
+    struct xdr_write_cursor     cursor;
+    xdr_iovec                   scratch_iov;
+    xdr_iovec                   window[XDR_DRY_RUN_WINDOW];
+    int                         retired;
+    void                       *discard_base;
+    int                         discard_size;
+    void                      **blocks;
+#if EVPL_RPC2
+    struct evpl_rpc2_rdma_chunk rdma_chunk;
+#endif /* if EVPL_RPC2 */
+    uint64_t                    discard[XDR_DRY_RUN_DISCARD / 8];
+};
+
+/* Heap blocks are chained through their first word and freed by finish */
+static __attribute__((noinline, cold, unused)) void *
+xdr_write_dry_run_block(
+    struct xdr_write_dry_run *dry,
+    size_t                    bytes)
+{
+    void **block = (void **) malloc(16 + bytes);
+
+    if (unlikely(block == NULL)) {
+        return NULL;
+    }
+
+    block[0]    = dry->blocks;
+    dry->blocks = block;
+
+    return (char *) block + 16;
+} /* xdr_write_dry_run_block */
+
+static __attribute__((noinline, cold, unused)) int
+xdr_write_dry_run_refill(
+    struct xdr_write_cursor *cursor,
+    unsigned int             bytes,
+    int                      iovs,
+    void                    *private_data)
+{
+    struct xdr_write_dry_run *dry = (struct xdr_write_dry_run *) private_data;
+    xdr_iovec                *window;
+    uint64_t                  need;
+    int                       size;
+
+    if (cursor->maxiov - cursor->niov < iovs) {
+        if (cursor->niov > 1) {
+            dry->retired  += cursor->niov - 1;
+            cursor->iov[0] = cursor->iov[cursor->niov - 1];
+            cursor->niov   = 1;
+        }
+
+        if (cursor->maxiov - cursor->niov < iovs) {
+            size   = 2 * (iovs + 1);
+            window = (xdr_iovec *) xdr_write_dry_run_block(dry, size * sizeof(xdr_iovec));
+
+            if (unlikely(window == NULL)) {
+                return -1;
+            }
+
+            if (cursor->niov) {
+                window[0] = cursor->iov[0];
+            }
+
+            cursor->iov    = window;
+            cursor->maxiov = size;
+        }
+    }
+
+    /* The bytes of the current run are never read back, only its length */
+    need = (uint64_t) cursor->scratch_used + bytes;
+
+    if (need > (uint64_t) cursor->scratch_size) {
+        if (unlikely(need > INT32_MAX / 2)) {
+            return -1;
+        }
+
+        if (need > (uint64_t) dry->discard_size) {
+            size              = dry->discard_size * 2 > (int) need ? dry->discard_size * 2 : (int) need;
+            dry->discard_base = xdr_write_dry_run_block(dry, size);
+
+            if (unlikely(dry->discard_base == NULL)) {
+                return -1;
+            }
+
+            dry->discard_size = size;
+        }
+
+        cursor->scratch_data = dry->discard_base;
+        cursor->scratch_size = dry->discard_size;
+    }
+
+    return 0;
+} /* xdr_write_dry_run_refill */
+
+static inline void
+xdr_write_dry_run_init(
+    struct xdr_write_dry_run         *dry,
+    int                               out_offset,
+    const struct xdr_marshall_config *config)
+{
+    struct xdr_marshall_config   defaults;
+    struct evpl_rpc2_rdma_chunk *rdma_chunk = NULL;
+
+    if (config == NULL) {
+        xdr_marshall_config_init(&defaults);
+        config = &defaults;
+    }
+
+    memset(&dry->scratch_iov, 0, sizeof(dry->scratch_iov));
+    xdr_iovec_set_data(&dry->scratch_iov, dry->discard);
+    xdr_iovec_set_len(&dry->scratch_iov, sizeof(dry->discard));
+
+    dry->retired      = 0;
+    dry->discard_base = dry->discard;
+    dry->discard_size = sizeof(dry->discard);
+    dry->blocks       = NULL;
+
+#if EVPL_RPC2
+    memset(&dry->rdma_chunk, 0, sizeof(dry->rdma_chunk));
+    dry->rdma_chunk.max_length = config->rdma_max_length;
+    rdma_chunk                 = &dry->rdma_chunk;
+#endif /* if EVPL_RPC2 */
+
+    xdr_write_cursor_init(&dry->cursor, &dry->scratch_iov, dry->window, XDR_DRY_RUN_WINDOW,
+                          rdma_chunk, out_offset);
+    xdr_write_cursor_set_zc_inline(&dry->cursor, config->zc_inline_threshold);
+    xdr_write_cursor_set_coalesce(&dry->cursor, config->coalesce);
+    xdr_write_cursor_set_refill(&dry->cursor, xdr_write_dry_run_refill, dry);
+
+    dry->cursor.dry_run = 1;
+} /* xdr_write_dry_run_init */
+
+/*
+ * Finish a dry run the encoder returned rc for.  Returns the scratch
+ * bytes consumed, including out_offset, and stores the output iovecs
+ * filled in niov, or -1 if encoding failed.
+ */
+static inline int
+xdr_write_dry_run_finish(
+    struct xdr_write_dry_run *dry,
+    int                       rc,
+    int                      *niov)
+{
+    void **block;
+
+    if (rc == 0 && xdr_write_cursor_finish(&dry->cursor) < 0) {
+        rc = -1;
+    }
+
+    if (rc == 0) {
+        *niov = dry->retired + dry->cursor.niov;
+        rc    = xdr_iovec_len32(&dry->scratch_iov);
+    } else {
+        rc = -1;
+    }
+
+    while ((block = dry->blocks) != NULL) {
+        dry->blocks = (void **) block[0];
+        free(block);
+    }
+
+    return rc;
+} /* xdr_write_dry_run_finish */
+
+#ifdef XDR_CHECK_REQUIREMENTS
+/* Abort if marshall_requirements_X() disagreed with the encode it predicted */
+static __attribute__((noinline, cold, unused)) void
+xdr_check_requirements(
+    const char      *name,
+    int              scratch,
+    int              niov,
+    const xdr_iovec *scratch_iov,
+    int              niov_out)
+{
+    if (scratch != (int) xdr_iovec_len32(scratch_iov) || niov != niov_out) {
+        fprintf(stderr, "marshall_requirements_%s: predicted %d scratch bytes and %d iovecs, "
+                "marshall_%s used %u and %d\n", name, scratch, niov, name,
+                xdr_iovec_len32(scratch_iov), niov_out);
+        abort();
+    }
+} /* xdr_check_requirements */
+#endif /* ifdef XDR_CHECK_REQUIREMENTS */
+
+/*
+ * A mark records the state of a write cursor so that a partially
+ * encoded value can be discarded again with xdr_write_cursor_rewind().
+ * Nothing may be emitted into a different scratch buffer in between,
+ * so only the positions that encoding advances are saved: the scratch
+ * buffer position follows from the flushed length of scratch_iov.
+ */
+struct xdr_write_mark {
+    int          niov;
+    unsigned int scratch_len;
+    int          scratch_used;
+    int          total;
+    int          pad_pending;
+    uint32_t     crc;
+    xdr_iovec    last;
+};
+
+static inline void
+xdr_write_cursor_mark(
+    struct xdr_write_cursor *cursor,
+    struct xdr_write_mark   *mark)
+{
+    mark->niov         = cursor->niov;
+    mark->scratch_len  = xdr_iovec_len32(cursor->scratch_iov);
+    mark->scratch_used = cursor->scratch_used;
+    mark->total        = cursor->total;
+    mark->pad_pending  = cursor->pad_pending;
+    mark->crc          = cursor->crc;
+
+    if (cursor->niov) {
+        mark->last = cursor->iov[cursor->niov - 1];
+    }
+} /* xdr_write_cursor_mark */
+
+static inline void
+xdr_write_cursor_rewind(
+    struct xdr_write_cursor *cursor,
+    struct xdr_write_mark   *mark)
+{
+    unsigned int flushed = xdr_iovec_len32(cursor->scratch_iov) - mark->scratch_len;
+
+    cursor->scratch_data  = (char *) cursor->scratch_data - flushed;
+    cursor->scratch_size += flushed;
+    cursor->niov          = mark->niov;
+    cursor->scratch_used  = mark->scratch_used;
+    cursor->total         = mark->total;
+    cursor->pad_pending   = mark->pad_pending;
+    cursor->crc           = mark->crc;
+
+    xdr_iovec_set_len(cursor->scratch_iov, mark->scratch_len);
+
+    /* Coalescing may have extended the last iovec in place */
+    if (cursor->niov) {
+        cursor->iov[cursor->niov - 1] = mark->last;
+    }
+} /* xdr_write_cursor_rewind */
+
+/*
+ * Decoding reads the segment of cursor->cur between iov_offset and end.
+ * Without record marking a segment is the whole iovec.  A record marked
+ * stream (RFC 5531 section 11) is read in place: segments also stop at
+ * each fragment boundary and the 4 byte fragment headers are stepped
+ * over, so they are never decoded, referenced by zero-copy output or
+ * counted in offset.
+ */
+struct xdr_read_cursor {
+    xdr_iovec                   *cur;
+    xdr_iovec                   *last;
+    unsigned int                 iov_offset;
+    unsigned int                 end;
+    unsigned int                 offset;
+    uint32_t                     fragment;
+    uint8_t                      record;
+    uint8_t                      last_fragment;
+    uint8_t                      digest;
+    unsigned int                 digest_start;
+    uint32_t                     crc;
+    struct evpl_rpc2_rdma_chunk *read_chunk;
+    xdr_iovec                    ring[2];
+};
+
+static FORCE_INLINE void
+xdr_read_cursor_vector_init(
+    struct xdr_read_cursor      *cursor,
+    xdr_iovec                   *iov,
+    int                          niov,
+    struct evpl_rpc2_rdma_chunk *read_chunk)
+{
+    cursor->cur           = iov;
+    cursor->last          = iov + (niov - 1);
+    cursor->iov_offset    = 0;
+    cursor->end           = xdr_iovec_len32(iov);
+    cursor->offset        = 0;
+    cursor->fragment      = 0;
+    cursor->record        = 0;
+    cursor->last_fragment = 0;
+    cursor->digest        = 0;
+    cursor->digest_start  = 0;
+    cursor->crc           = 0;
+    cursor->read_chunk    = read_chunk;
+} /* xdr_read_cursor_vector_init */
+
+static FORCE_INLINE void
+xdr_read_cursor_contig_init(
+    struct xdr_read_cursor      *cursor,
+    xdr_iovec                   *iov,
+    struct evpl_rpc2_rdma_chunk *read_chunk)
+{
+    xdr_read_cursor_vector_init(cursor, iov, 1, read_chunk);
+} /* xdr_read_cursor_contig_init */
+
+/*
+ * Move to the next non-empty segment once the current one is exhausted.
+ * cursor->fragment holds the bytes of the current fragment beyond the
+ * segment; when none are left the next fragment header is read, which
+ * may itself straddle iovecs.  The cursor is left unchanged if no more
+ * data is available or the last fragment of the record has been read.
+ * Crossing a segment is rare next to the reads within one, so this is
+ * kept out of line.
+ */
+static __attribute__((noinline, cold, unused)) int
+xdr_read_cursor_vector_next(struct xdr_read_cursor *cursor)
+{
+    xdr_iovec   *cur  = cursor->cur;
+    unsigned int pos  = cursor->end, len;
+    uint32_t     left = cursor->fragment, header;
+    uint8_t      last = cursor->last_fragment;
+    int          i;
+
+    do {
+        if (cursor->record && left == 0) {
+            if (last) {
+                return -1;
+            }
+
+            header = 0;
+
+            for (i = 0; i < 4; i++) {
+                while (pos == xdr_iovec_len32(cur)) {
+                    if (cur == cursor->last) {
+                        return -1;
+                    }
+                    cur++;
+                    pos = 0;
+                }
+
+                header = (header << 8) | ((const uint8_t *) xdr_iovec_data(cur))[pos++];
+            }
+
+            last = header >> 31;
+            left = header & 0x7fffffff;
+        } else {
+            if (cur == cursor->last) {
+                return -1;
+            }
+            cur++;
+            pos = 0;
+        }
+
+        len = xdr_iovec_len32(cur) - pos;
+
+        if (cursor->record) {
+            if (len > left) {
+                len = left;
+            }
+            left -= len;
+        }
+    } while (len == 0);
+
+    if (cursor->digest) {
+        cursor->crc = xdr_crc32c(cursor->crc,
+                                 (const char *) xdr_iovec_data(cursor->cur) + cursor->digest_start,
+                                 cursor->end - cursor->digest_start);
+        cursor->digest_start = pos;
+    }
+
+    cursor->cur           = cur;
+    cursor->iov_offset    = pos;
+    cursor->end           = pos + len;
+    cursor->fragment      = left;
+    cursor->last_fragment = last;
+
+    return 0;
+} /* xdr_read_cursor_vector_next */
+
+/*
+ * Start reading a record marked stream at the header of its first
+ * fragment.  Decoding stops at the end of the record's last fragment.
+ */
+static inline int WARN_UNUSED_RESULT
+xdr_read_cursor_record_init(
+    struct xdr_read_cursor      *cursor,
+    xdr_iovec                   *iov,
+    int                          niov,
+    struct evpl_rpc2_rdma_chunk *read_chunk)
+{
+    xdr_read_cursor_vector_init(cursor, iov, niov, read_chunk);
+
+    cursor->end    = 0;
+    cursor->record = 1;
+
+    return xdr_read_cursor_vector_next(cursor);
+} /* xdr_read_cursor_record_init */
+
+/*
+ * Read length bytes from a circular buffer starting at head, wrapping
+ * to the start of the buffer at its end.  ring describes the whole
+ * buffer; the two halves of a wrapped value are held in the cursor, so
+ * the cursor must outlive the decode, and a zero-copy opaque spanning
+ * the wrap references both.
+ */
+static inline int WARN_UNUSED_RESULT
+xdr_read_cursor_ring_init(
+    struct xdr_read_cursor      *cursor,
+    const xdr_iovec             *ring,
+    uint32_t                     head,
+    uint32_t                     length,
+    struct evpl_rpc2_rdma_chunk *read_chunk)
+{
+    uint32_t capacity = xdr_iovec_len32(ring);
+    uint32_t first;
+
+    if (unlikely(head >= capacity || length > capacity)) {
+        return -1;
+    }
+
+    first = capacity - head < length ? capacity - head : length;
+
+    xdr_iovec_copy_private(&cursor->ring[0], ring);
+    xdr_iovec_set_data(&cursor->ring[0], (char *) xdr_iovec_data(ring) + head);
+    xdr_iovec_set_len(&cursor->ring[0], first);
+
+    if (first == length) {
+        xdr_read_cursor_vector_init(cursor, cursor->ring, 1, read_chunk);
+    } else {
+        xdr_iovec_copy_private(&cursor->ring[1], ring);
+        xdr_iovec_set_len(&cursor->ring[1], length - first);
+        xdr_read_cursor_vector_init(cursor, cursor->ring, 2, read_chunk);
+    }
+
+    return 0;
+} /* xdr_read_cursor_ring_init */
+
+/*
+ * Keep a CRC32C of the bytes consumed from here on.  Each segment is
+ * folded in when the cursor leaves it; xdr_read_cursor_digest() adds
+ * the part of the current segment consumed so far.
+ */
+static inline void
+xdr_read_cursor_set_digest(
+    struct xdr_read_cursor *cursor,
+    int                     enable)
+{
+    cursor->digest       = enable;
+    cursor->digest_start = cursor->iov_offset;
+} /* xdr_read_cursor_set_digest */
+
+static inline uint32_t
+xdr_read_cursor_digest(struct xdr_read_cursor *cursor)
+{
+    if (cursor->digest) {
+        cursor->crc = xdr_crc32c(cursor->crc,
+                                 (const char *) xdr_iovec_data(cursor->cur) + cursor->digest_start,
+                                 cursor->iov_offset - cursor->digest_start);
+        cursor->digest_start = cursor->iov_offset;
+    }
+
+    return cursor->crc;
+} /* xdr_read_cursor_digest */
+
+/*
+ * A view refers to an encoded value in place.  Generated view_X_*()
+ * accessors decode individual members from the wire only when called.
+ */
+struct xdr_view {
+    xdr_iovec *iov;
+    int        niov;
+    uint32_t   offset;
+};
+
+/*
+ * Resumable unmarshalling.  Received data is appended to the context as
+ * it arrives and the generated unmarshall_X_resume() is called again;
+ * it returns XDR_RESUME_MORE until the value is complete.  Decoding
+ * stops between members, so no partial scalar state is kept, or within
+ * the body of a string or opaque, and each nesting level records its
+ * position in a frame on the stack.
+ * Appended iovecs must remain valid until the value is released, as
+ * with unmarshall_X().
+ *
+ * The same context drives marshall_X_resume(), which encodes as much
+ * of a value as fits in each set of output buffers it is given.  Only
+ * the depth, stack and offset fields are used in that direction.
+ */
+#ifndef XDR_RESUME_MAX_DEPTH
+#define XDR_RESUME_MAX_DEPTH 32
+#endif /* ifndef XDR_RESUME_MAX_DEPTH */
+
+#define XDR_RESUME_MORE      (-2)
+
+struct xdr_resume_frame {
+    uint32_t field;
+    uint32_t phase;
+    uint32_t index;
+    void    *node;
+};
+
+struct xdr_resume {
+    xdr_iovec              *iov;
+    int                     niov;
+    int                     maxiov;
+    int                     cur;
+    uint32_t                iov_offset;
+    uint32_t                offset;
+    int                     depth;
+    struct xdr_resume_frame stack[XDR_RESUME_MAX_DEPTH];
+};
+
+static inline void
+xdr_resume_init(
+    struct xdr_resume *ctx,
+    xdr_iovec         *iov,
+    int                maxiov)
+{
+    ctx->iov        = iov;
+    ctx->niov       = 0;
+    ctx->maxiov     = maxiov;
+    ctx->cur        = 0;
+    ctx->iov_offset = 0;
+    ctx->offset     = 0;
+    ctx->depth      = 0;
+} /* xdr_resume_init */
+
+static inline int WARN_UNUSED_RESULT
+xdr_resume_append(
+    struct xdr_resume *ctx,
+    xdr_iovec         *iov,
+    int                niov)
+{
+    xdr_iovec *out;
+    int        i;
+
+    if (unlikely(ctx->niov + niov > ctx->maxiov)) {
+        return -1;
+    }
+
+    for (i = 0; i < niov; i++) {
+        out = &ctx->iov[ctx->niov++];
+        xdr_iovec_move_private(out, &iov[i]);
+    }
+
+    return 0;
+} /* xdr_resume_append */
+
 void
 dump_output(
     const char *format,
@@ -0,0 +1,225 @@
+// SPDX-FileCopyrightText: 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+/*
+ * C++ layer emitted with -x c++.  The per-type codecs are defined in the
+ * header in this mode, so encode() and decode() below inline into the
+ * caller instead of stopping at an out-of-line C wrapper.
+ */
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <type_traits>
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#define XDR_HAVE_SPAN 1
+#endif /* if __cplusplus >= 202002L && __has_include(<span>) */
+
+namespace xdr {
+
+/* Cursor kinds the generated decoders are specialized on */
+struct contig_cursor {};
+struct vector_cursor {};
+
+/*
+ * codec<T> is specialized for every XDR type with static marshall(),
+ * unmarshall<Kind>() and length() members.
+ */
+template <typename T>
+struct codec;
+
+/* Encoded size of types whose encoding is constant, undefined otherwise */
+template <typename T>
+struct wire_size;
+
+template <typename T, typename = void>
+struct has_wire_size : std::false_type {};
+
+template <typename T>
+struct has_wire_size<T, std::void_t<decltype(wire_size<T>::value)> > : std::true_type {};
+
+template <typename T>
+inline constexpr int wire_size_v = wire_size<T>::value;
+
+/*
+ * Worst-case limits of every type, as XDR_MAX_WIRE_SIZE_X, XDR_MAX_IOV_X
+ * and XDR_MAX_DBUF_X(niov), with XDR_UNBOUNDED where there is no limit.
+ */
+template <typename T>
+struct limits;
+
+template <typename Kind, typename T>
+static FORCE_INLINE int WARN_UNUSED_RESULT
+decode(
+    T                      &out,
+    struct xdr_read_cursor *cursor,
+    xdr_dbuf               *dbuf)
+{
+    static_assert(std::is_same_v<Kind, contig_cursor> || std::is_same_v<Kind, vector_cursor>,
+                  "cursor kind must be contig_cursor or vector_cursor");
+
+    return codec<T>::template unmarshall<Kind>(out, cursor, dbuf);
+} /* decode */
+
+/* Same contract as unmarshall_X(), with the optional RDMA chunk last */
+template <typename T>
+static FORCE_INLINE int WARN_UNUSED_RESULT
+decode(
+    T                           &out,
+    xdr_iovec                   *iov,
+    int                          niov,
+    xdr_dbuf                    *dbuf,
+    struct evpl_rpc2_rdma_chunk *rdma_chunk = nullptr)
+{
+    struct xdr_read_cursor cursor;
+
+    if (niov == 1) {
+        xdr_read_cursor_contig_init(&cursor, iov, rdma_chunk);
+        return decode<contig_cursor>(out, &cursor, dbuf);
+    }
+
+    xdr_read_cursor_vector_init(&cursor, iov, niov, rdma_chunk);
+    return decode<vector_cursor>(out, &cursor, dbuf);
+} /* decode */
+
+template <typename T>
+static FORCE_INLINE int WARN_UNUSED_RESULT
+encode(
+    const T                 &in,
+    struct xdr_write_cursor *cursor)
+{
+    return codec<T>::marshall(in, cursor);
+} /* encode */
+
+/* Same contract and argument order as marshall_X() */
+template <typename T>
+static FORCE_INLINE int WARN_UNUSED_RESULT
+encode(
+    const T                     &in,
+    xdr_iovec                   *iov_in,
+    xdr_iovec                   *iov_out,
+    int                         *niov_out,
+    struct evpl_rpc2_rdma_chunk *rdma_chunk = nullptr,
+    int                          out_offset = 0)
+{
+    struct xdr_write_cursor cursor;
+
+    xdr_write_cursor_init(&cursor, iov_in, iov_out, *niov_out, rdma_chunk, out_offset);
+
+    if (unlikely(codec<T>::marshall(in, &cursor) < 0)) {
+        return -1;
+    }
+
+    if (unlikely(xdr_write_cursor_flush(&cursor) < 0)) {
+        return -1;
+    }
+
+    *niov_out = cursor.niov;
+    return cursor.total;
+} /* encode */
+
+template <typename T>
+static FORCE_INLINE int
+length(const T &in)
+{
+    if constexpr (has_wire_size<T>::value) {
+        return wire_size_v<T>;
+    } else {
+        return codec<T>::length(in);
+    }
+} /* length */
+
+/*
+ * A std::pmr::memory_resource carving allocations out of an xdr_dbuf, so
+ * pmr containers can share the arena decoded messages live in.  Memory is
+ * only given back by xdr_dbuf_reset().
+ */
+class dbuf_resource : public std::pmr::memory_resource
+{
+    public:
+
+        explicit dbuf_resource(xdr_dbuf *dbuf) noexcept : dbuf_(dbuf)
+        {
+        }
+
+        xdr_dbuf *
+        dbuf() const noexcept
+        {
+            return dbuf_;
+        } /* dbuf */
+
+    private:
+
+        void *
+        do_allocate(
+            std::size_t bytes,
+            std::size_t alignment) override
+        {
+            void *ptr = nullptr;
+
+            /* dbuf allocations are 8 byte aligned */
+            if (alignment <= 8 && bytes <= INT32_MAX) {
+                ptr = xdr_dbuf_alloc_space((int) bytes, dbuf_);
+            }
+
+            if (unlikely(ptr == nullptr)) {
+                throw std::bad_alloc();
+            }
+
+            return ptr;
+        } /* do_allocate */
+
+        void
+        do_deallocate(
+            void       *,
+            std::size_t,
+            std::size_t) override
+        {
+        } /* do_deallocate */
+
+        bool
+        do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            /* No RTTI needed; memory from one resource is never freed by another anyway */
+            return this == &other;
+        } /* do_is_equal */
+
+        xdr_dbuf *dbuf_;
+};
+
+/* Decoded strings and opaques reference the wire or the dbuf in place */
+static inline std::string_view
+view(const xdr_string &str)
+{
+    return std::string_view(str.str, str.len);
+} /* view */
+
+#ifdef XDR_HAVE_SPAN
+static inline std::span<const uint8_t>
+view(const xdr_opaque &opaque)
+{
+    return std::span<const uint8_t>((const uint8_t *) opaque.data, opaque.len);
+} /* view */
+
+static inline std::span<const xdr_iovec>
+view(const xdr_iovecr &zc)
+{
+    return std::span<const xdr_iovec>(zc.iov, zc.niov);
+} /* view */
+
+/* Variable-length arrays, e.g. view(msg.words, msg.num_words) */
+template <typename T>
+static inline std::span<T>
+view(
+    T       *elements,
+    uint32_t count)
+{
+    return std::span<T>(elements, count);
+} /* view */
+#endif /* ifdef XDR_HAVE_SPAN */
+
+} // namespace xdr
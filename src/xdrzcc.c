@@ -16,6 +16,7 @@ extern int yyparse();
 
 extern const char  *embedded_builtin_c;
 extern const char  *embedded_builtin_h;
+extern const char  *embedded_builtin_cxx_h;
 
 struct xdr_struct  *xdr_structs  = NULL;
 struct xdr_union   *xdr_unions   = NULL;
@@ -101,6 +102,29 @@ xdr_add_identifier(
 
     HASH_ADD_STR(xdr_identifiers, name, ident);
 } /* xdr_add_identifier */
+
+/* Builtin scalars whose arrays and vectors are converted in bulk */
+static int
+is_bulk_scalar(struct xdr_type *type)
+{
+    static const char *names[] = {
+        "uint32_t", "int32_t", "uint64_t", "int64_t", "float", "double"
+    };
+    int                i;
+
+    if (!type->builtin) {
+        return 0;
+    }
+
+    for (i = 0; i < (int) (sizeof(names) / sizeof(names[0])); i++) {
+        if (strcmp(type->name, names[i]) == 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+} /* is_bulk_scalar */
+
 void
 emit_marshall(
     FILE            *output,
@@ -167,16 +191,27 @@ emit_marshall(
                 type->name, name);
         fprintf(output, "        }\n");
         fprintf(output, "    }\n");
+    } else if (type->vector && is_bulk_scalar(type)) {
+        fprintf(output,
+                "    if (unlikely(__marshall_uint32_t(&in->num_%s, cursor) < 0)) return -1;\n",
+                name);
+        fprintf(output,
+                "    if (unlikely(__marshall_%s_bulk(in->%s, in->num_%s, cursor) < 0)) return -1;\n",
+                type->name, name, name);
+    } else if (type->array && is_bulk_scalar(type)) {
+        fprintf(output,
+                "    if (unlikely(__marshall_%s_bulk(in->%s, %s, cursor) < 0)) return -1;\n",
+                type->name, name, type->array_size);
     } else if (type->vector) {
         fprintf(output,
                 "    if (unlikely(__marshall_uint32_t(&in->num_%s, cursor) < 0)) return -1;\n",
                 name);
-        fprintf(output, "    for (int i = 0; i < in->num_%s; i++) {\n", name);
+        fprintf(output, "    for (uint32_t i = 0; i < in->num_%s; i++) {\n", name);
         fprintf(output, "        if (unlikely(__marshall_%s(&in->%s[i], cursor) < 0)) return -1;\n",
                 type->name, name);
         fprintf(output, "    }\n");
     } else if (type->array) {
-        fprintf(output, "    for (int i = 0; i < %s; ++i) {\n",
+        fprintf(output, "    for (uint32_t i = 0; i < %s; ++i) {\n",
                 type->array_size);
         fprintf(output, "        if (unlikely(__marshall_%s(&in->%s[i], cursor) < 0)) return -1;\n",
                 type->name, name);
@@ -187,6 +222,25 @@ emit_marshall(
     }
 } /* emit_marshall */
 
+/*
+ * Reject a decoded element count beyond the declared bound, or one whose
+ * allocation size would overflow, before anything is allocated for it.
+ */
+static void
+emit_count_check(
+    FILE            *output,
+    const char      *name,
+    struct xdr_type *type)
+{
+    if (type->vector_bound) {
+        fprintf(output, "    if (unlikely(out->num_%s > %s)) return -1;\n",
+                name, type->vector_bound);
+    }
+
+    fprintf(output, "    if (unlikely(out->num_%s > INT32_MAX / sizeof(*out->%s))) return -1;\n",
+            name, name);
+} /* emit_count_check */
+
 void
 emit_unmarshall(
     FILE            *output,
@@ -203,8 +257,8 @@ emit_unmarshall(
                     name, type->array_size);
         } else if (type->zerocopy) {
             fprintf(output,
-                    "    rc = __unmarshall_opaque_zerocopy_vector(&out->%s, cursor, dbuf);\n",
-                    name);
+                    "    rc = __unmarshall_opaque_zerocopy_vector(&out->%s, %s, cursor, dbuf);\n",
+                    name, type->vector_bound ? type->vector_bound : "0");
         } else {
             fprintf(output,
                     "    rc = __unmarshall_opaque_vector(&out->%s, %s, cursor, dbuf);\n",
@@ -212,8 +266,8 @@ emit_unmarshall(
         }
     } else if (strcmp(type->name, "xdr_string") == 0) {
         fprintf(output,
-                "    rc = __unmarshall_%s_vector(&out->%s, cursor, dbuf);\n",
-                type->name, name);
+                "    rc = __unmarshall_%s_vector(&out->%s, %s, cursor, dbuf);\n",
+                type->name, name, type->vector_bound ? type->vector_bound : "0");
     } else if (type->linkedlist) {
 
         HASH_FIND_STR(xdr_identifiers, type->name, chk);
@@ -236,7 +290,7 @@ emit_unmarshall(
         fprintf(output, "        out->%s = NULL;\n", name);
         fprintf(output, "        struct %s *current = NULL, *last = NULL;\n", type->name);
         fprintf(output, "        while (more) {\n");
-        fprintf(output, "          current = xdr_dbuf_alloc_space(sizeof(*current), dbuf);\n");
+        fprintf(output, "          current = XDR_PTR_CAST(current) xdr_dbuf_alloc_space(sizeof(*current), dbuf);\n");
         fprintf(output, "          if (unlikely(current == NULL)) return -1;\n");
         fprintf(output,
                 "        rc = __unmarshall_%s_vector(current, cursor, dbuf);\n",
@@ -266,7 +320,7 @@ emit_unmarshall(
         fprintf(output, "        len += rc;\n");
         fprintf(output, "        rc = 0;\n");
         fprintf(output, "        if (more) {\n");
-        fprintf(output, "         out->%s = xdr_dbuf_alloc_space(sizeof(*out->%s), dbuf);\n", name, name);
+        fprintf(output, "         out->%s = XDR_PTR_CAST(out->%s) xdr_dbuf_alloc_space(sizeof(*out->%s), dbuf);\n", name, name, name);
         fprintf(output, "         if (unlikely(out->%s == NULL)) return -1;\n", name);
         fprintf(output,
                 "        rc = __unmarshall_%s_vector(out->%s, cursor, dbuf);\n",
@@ -275,16 +329,34 @@ emit_unmarshall(
         fprintf(output, "            out->%s = NULL;\n", name);
         fprintf(output, "        };\n");
         fprintf(output, "    }\n");
+    } else if (type->vector && is_bulk_scalar(type)) {
+        fprintf(output,
+                "    rc = __unmarshall_uint32_t_vector(&out->num_%s, cursor, dbuf);\n",
+                name);
+        fprintf(output, "    if (unlikely(rc < 0)) return rc;\n");
+        fprintf(output, "    len += rc;\n");
+        emit_count_check(output, name, type);
+        fprintf(output, "     out->%s = XDR_PTR_CAST(out->%s) xdr_dbuf_alloc_space(out->num_%s * sizeof(*out->%s), dbuf);\n",
+                name, name, name, name);
+        fprintf(output, "     if (unlikely(out->%s == NULL)) return -1;\n", name);
+        fprintf(output,
+                "    rc = __unmarshall_%s_bulk_vector(out->%s, out->num_%s, cursor);\n",
+                type->name, name, name);
+    } else if (type->array && is_bulk_scalar(type)) {
+        fprintf(output,
+                "    rc = __unmarshall_%s_bulk_vector(out->%s, %s, cursor);\n",
+                type->name, name, type->array_size);
     } else if (type->vector) {
         fprintf(output,
                 "    rc = __unmarshall_uint32_t_vector(&out->num_%s, cursor, dbuf);\n",
                 name);
         fprintf(output, "    if (unlikely(rc < 0)) return rc;\n");
         fprintf(output, "    len += rc;\n");
-        fprintf(output, "     out->%s = xdr_dbuf_alloc_space(out->num_%s * sizeof(*out->%s), dbuf);\n",
-                name, name, name);
+        emit_count_check(output, name, type);
+        fprintf(output, "     out->%s = XDR_PTR_CAST(out->%s) xdr_dbuf_alloc_space(out->num_%s * sizeof(*out->%s), dbuf);\n",
+                name, name, name, name);
         fprintf(output, "     if (unlikely(out->%s == NULL)) return -1;\n", name);
-        fprintf(output, "    for (int i = 0; i < out->num_%s; i++) {\n", name);
+        fprintf(output, "    for (uint32_t i = 0; i < out->num_%s; i++) {\n", name);
         fprintf(output,
                 "    rc = __unmarshall_%s_vector(&out->%s[i], cursor, dbuf);\n",
                 type->name, name);
@@ -293,7 +365,7 @@ emit_unmarshall(
         fprintf(output, "    }\n");
         fprintf(output, "    rc = 0;\n");
     } else if (type->array) {
-        fprintf(output, "    for (int i = 0; i < %s; i++) {\n",
+        fprintf(output, "    for (uint32_t i = 0; i < %s; i++) {\n",
                 type->array_size);
         fprintf(output,
                 "    rc = __unmarshall_%s_vector(&out->%s[i], cursor, dbuf);\n",
@@ -323,6 +395,9 @@ emit_unmarshall_contig(
 
     if (type->opaque) {
         if (type->array) {
+            fprintf(output,
+                    "    if (unlikely(cursor->iov_offset + %s > cursor->end)) return -1;\n",
+                    type->array_size);
             fprintf(output,
                     "    memcpy(out->%s, xdr_iovec_data(cursor->cur) + cursor->iov_offset, %s);\n",
                     name, type->array_size);
@@ -332,8 +407,8 @@ emit_unmarshall_contig(
             fprintf(output, "    rc = 0;\n");
         } else if (type->zerocopy) {
             fprintf(output,
-                    "    rc = __unmarshall_opaque_zerocopy_contig(&out->%s, cursor, dbuf);\n",
-                    name);
+                    "    rc = __unmarshall_opaque_zerocopy_contig(&out->%s, %s, cursor, dbuf);\n",
+                    name, type->vector_bound ? type->vector_bound : "0");
             fprintf(output, "    if (unlikely(rc < 0)) return rc;\n");
         } else {
             fprintf(output,
@@ -343,8 +418,8 @@ emit_unmarshall_contig(
         }
     } else if (strcmp(type->name, "xdr_string") == 0) {
         fprintf(output,
-                "    rc = __unmarshall_%s_contig(&out->%s, cursor, dbuf);\n",
-                type->name, name);
+                "    rc = __unmarshall_%s_contig(&out->%s, %s, cursor, dbuf);\n",
+                type->name, name, type->vector_bound ? type->vector_bound : "0");
         fprintf(output, "    if (unlikely(rc < 0)) return rc;\n");
     } else if (type->linkedlist) {
 
@@ -368,7 +443,7 @@ emit_unmarshall_contig(
         fprintf(output, "        out->%s = NULL;\n", name);
         fprintf(output, "        struct %s *current = NULL, *last = NULL;\n", type->name);
         fprintf(output, "        while (more) {\n");
-        fprintf(output, "          current = xdr_dbuf_alloc_space(sizeof(*current), dbuf);\n");
+        fprintf(output, "          current = XDR_PTR_CAST(current) xdr_dbuf_alloc_space(sizeof(*current), dbuf);\n");
         fprintf(output, "          if (unlikely(current == NULL)) return -1;\n");
         fprintf(output,
                 "        rc = __unmarshall_%s_contig(current, cursor, dbuf);\n",
@@ -398,27 +473,45 @@ emit_unmarshall_contig(
         fprintf(output, "        len += rc;\n");
         fprintf(output, "        rc = 0;\n");
         fprintf(output, "        if (more) {\n");
-        fprintf(output, "         out->%s = xdr_dbuf_alloc_space(sizeof(*out->%s), dbuf);\n", name, name);
+        fprintf(output, "         out->%s = XDR_PTR_CAST(out->%s) xdr_dbuf_alloc_space(sizeof(*out->%s), dbuf);\n", name, name, name);
         fprintf(output, "         if (unlikely(out->%s == NULL)) return -1;\n", name);
         fprintf(output,
                 "        rc = __unmarshall_%s_contig(out->%s, cursor, dbuf);\n",
                 type->name, name);
-        fprintf(output, "        if (unlikely(rc < 0)) return rc;\n");
-        fprintf(output, "        len += rc;\n");
         fprintf(output, "        } else {\n");
         fprintf(output, "            out->%s = NULL;\n", name);
         fprintf(output, "        };\n");
         fprintf(output, "    }\n");
+    } else if (type->vector && is_bulk_scalar(type)) {
+        fprintf(output,
+                "    rc = __unmarshall_uint32_t_contig(&out->num_%s, cursor, dbuf);\n",
+                name);
+        fprintf(output, "    if (unlikely(rc < 0)) return rc;\n");
+        fprintf(output, "    len += rc;\n");
+        emit_count_check(output, name, type);
+        fprintf(output, "     out->%s = XDR_PTR_CAST(out->%s) xdr_dbuf_alloc_space(out->num_%s * sizeof(*out->%s), dbuf);\n",
+                name, name, name, name);
+        fprintf(output, "     if (unlikely(out->%s == NULL)) return -1;\n", name);
+        fprintf(output,
+                "    rc = __unmarshall_%s_bulk_contig(out->%s, out->num_%s, cursor);\n",
+                type->name, name, name);
+        fprintf(output, "    if (unlikely(rc < 0)) return rc;\n");
+    } else if (type->array && is_bulk_scalar(type)) {
+        fprintf(output,
+                "    rc = __unmarshall_%s_bulk_contig(out->%s, %s, cursor);\n",
+                type->name, name, type->array_size);
+        fprintf(output, "    if (unlikely(rc < 0)) return rc;\n");
     } else if (type->vector) {
         fprintf(output,
                 "    rc = __unmarshall_uint32_t_contig(&out->num_%s, cursor, dbuf);\n",
                 name);
         fprintf(output, "    if (unlikely(rc < 0)) return rc;\n");
         fprintf(output, "    len += rc;\n");
-        fprintf(output, "     out->%s = xdr_dbuf_alloc_space(out->num_%s * sizeof(*out->%s), dbuf);\n",
-                name, name, name);
+        emit_count_check(output, name, type);
+        fprintf(output, "     out->%s = XDR_PTR_CAST(out->%s) xdr_dbuf_alloc_space(out->num_%s * sizeof(*out->%s), dbuf);\n",
+                name, name, name, name);
         fprintf(output, "     if (unlikely(out->%s == NULL)) return -1;\n", name);
-        fprintf(output, "    for (int i = 0; i < out->num_%s; i++) {\n", name);
+        fprintf(output, "    for (uint32_t i = 0; i < out->num_%s; i++) {\n", name);
         fprintf(output,
                 "    rc = __unmarshall_%s_contig(&out->%s[i], cursor, dbuf);\n",
                 type->name, name);
@@ -427,7 +520,7 @@ emit_unmarshall_contig(
         fprintf(output, "    }\n");
         fprintf(output, "    rc = 0;\n");
     } else if (type->array) {
-        fprintf(output, "    for (int i = 0; i < %s; i++) {\n",
+        fprintf(output, "    for (uint32_t i = 0; i < %s; i++) {\n",
                 type->array_size);
         fprintf(output,
                 "    rc = __unmarshall_%s_contig(&out->%s[i], cursor, dbuf);\n",
@@ -521,12 +614,73 @@ is_type_recursive(const char *type_name)
     return 0;
 } /* is_type_recursive */
 
+/* Wire size of a builtin scalar, or -1 for anything else */
+static int
+builtin_wire_size(struct xdr_type *type)
+{
+    if (!type->builtin || type->opaque) {
+        return -1;
+    }
+
+    if (strcmp(type->name, "uint32_t") == 0 ||
+        strcmp(type->name, "int32_t") == 0 ||
+        strcmp(type->name, "float") == 0 ||
+        strcmp(type->name, "xdr_bool") == 0) {
+        return 4;
+    }
+
+    if (strcmp(type->name, "uint64_t") == 0 ||
+        strcmp(type->name, "int64_t") == 0 ||
+        strcmp(type->name, "double") == 0) {
+        return 8;
+    }
+
+    return -1;
+} /* builtin_wire_size */
+
+/* Whether a type is a struct coded by the table-driven interpreter */
+static int
+is_table_struct(const char *name)
+{
+    struct xdr_identifier *chk;
+
+    HASH_FIND_STR(xdr_identifiers, name, chk);
+
+    return chk && chk->type == XDR_STRUCT && ((struct xdr_struct *) chk->ptr)->table;
+} /* is_table_struct */
+
+/*
+ * Mark the struct or union name refers to, through a typedef if need be,
+ * as a top-level message type.  Returns -1 if it is neither.
+ */
+static int
+mark_message_type(const char *name)
+{
+    struct xdr_identifier *chk;
+
+    HASH_FIND_STR(xdr_identifiers, name, chk);
+
+    if (chk && chk->type == XDR_TYPEDEF) {
+        HASH_FIND_STR(xdr_identifiers, ((struct xdr_typedef *) chk->ptr)->type->name, chk);
+    }
+
+    if (chk && chk->type == XDR_STRUCT) {
+        ((struct xdr_struct *) chk->ptr)->message = 1;
+    } else if (chk && chk->type == XDR_UNION) {
+        ((struct xdr_union *) chk->ptr)->message = 1;
+    } else {
+        return -1;
+    }
+
+    return 0;
+} /* mark_message_type */
+
 void
 emit_internal_headers(
     FILE       *source,
     const char *name)
 {
-    int is_recursive = is_type_recursive(name);
+    int is_recursive = is_type_recursive(name) || is_table_struct(name);
 
     if (is_recursive) {
         fprintf(source, "static int WARN_UNUSED_RESULT\n");
@@ -554,10 +708,261 @@ emit_internal_headers(
     fprintf(source, "    const struct %s *in);\n", name);
 } /* emit_internal_headers */
 
+/*
+ * Out-of-line thunks and codec through which the table interpreter
+ * reaches a type that is not table-driven itself.
+ */
+static void
+emit_table_codec(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "static int\n");
+    fprintf(source, "__table_marshall_%s(\n", name);
+    fprintf(source, "    const void *in,\n");
+    fprintf(source, "    struct xdr_write_cursor *cursor) {\n");
+    fprintf(source, "    return __marshall_%s((struct %s *) in, cursor);\n", name, name);
+    fprintf(source, "}\n\n");
+
+    fprintf(source, "static int\n");
+    fprintf(source, "__table_unmarshall_%s_vector(\n", name);
+    fprintf(source, "    void *out,\n");
+    fprintf(source, "    struct xdr_read_cursor *cursor,\n");
+    fprintf(source, "    xdr_dbuf *dbuf) {\n");
+    fprintf(source, "    return __unmarshall_%s_vector((struct %s *) out, cursor, dbuf);\n", name, name);
+    fprintf(source, "}\n\n");
+
+    fprintf(source, "static int\n");
+    fprintf(source, "__table_unmarshall_%s_contig(\n", name);
+    fprintf(source, "    void *out,\n");
+    fprintf(source, "    struct xdr_read_cursor *cursor,\n");
+    fprintf(source, "    xdr_dbuf *dbuf) {\n");
+    fprintf(source, "    return __unmarshall_%s_contig((struct %s *) out, cursor, dbuf);\n", name, name);
+    fprintf(source, "}\n\n");
+
+    fprintf(source, "static int\n");
+    fprintf(source, "__table_length_%s(const void *in) {\n", name);
+    fprintf(source, "    return __marshall_length_%s((const struct %s *) in);\n", name, name);
+    fprintf(source, "}\n\n");
+
+    fprintf(source, "static const struct xdr_table_codec xdr_table_codec_%s = {\n", name);
+    fprintf(source, "    __table_marshall_%s,\n", name);
+    fprintf(source, "    __table_unmarshall_%s_vector,\n", name);
+    fprintf(source, "    __table_unmarshall_%s_contig,\n", name);
+    fprintf(source, "    __table_length_%s\n", name);
+    fprintf(source, "};\n\n");
+} /* emit_table_codec */
+
+/* One field descriptor of a table-driven struct */
+static void
+emit_table_field(
+    FILE                     *source,
+    const char               *parent,
+    struct xdr_struct_member *member)
+{
+    struct xdr_type       *type = member->type;
+    struct xdr_identifier *chk;
+    const char            *kind, *shape = "XDR_TABLE_PLAIN", *bound = "0";
+    char                   aux[256], size[256], table[256], codec[256];
+    int                    swap = 0;
+
+    snprintf(aux, sizeof(aux), "0");
+    snprintf(size, sizeof(size), "0");
+    snprintf(table, sizeof(table), "NULL");
+    snprintf(codec, sizeof(codec), "NULL");
+
+    if (type->opaque) {
+        kind  = type->array ? "XDR_TABLE_FIXED" : type->zerocopy ? "XDR_TABLE_ZCOPAQUE" : "XDR_TABLE_OPAQUE";
+        bound = type->array ? type->array_size : type->vector_bound ? type->vector_bound : "0";
+    } else if (strcmp(type->name, "xdr_string") == 0) {
+        kind  = "XDR_TABLE_STRING";
+        bound = type->vector_bound ? type->vector_bound : "0";
+    } else {
+        if (type->builtin) {
+            kind = "XDR_TABLE_SCALAR";
+            swap = strcmp(type->name, "float") != 0 && strcmp(type->name, "double") != 0;
+            snprintf(size, sizeof(size), "%d", builtin_wire_size(type));
+        } else {
+            kind = "XDR_TABLE_TYPE";
+
+            if (is_table_struct(type->name)) {
+                snprintf(table, sizeof(table), "&xdr_table_%s", type->name);
+            } else {
+                snprintf(codec, sizeof(codec), "&xdr_table_codec_%s", type->name);
+            }
+        }
+
+        if (type->linkedlist) {
+            HASH_FIND_STR(xdr_identifiers, type->name, chk);
+            shape = "XDR_TABLE_LIST";
+            snprintf(aux, sizeof(aux), "offsetof(struct %s, %s)", type->name,
+                     ((struct xdr_struct *) chk->ptr)->nextmember);
+            snprintf(size, sizeof(size), "sizeof(*((struct %s *) 0)->%s)", parent, member->name);
+        } else if (type->optional) {
+            shape = "XDR_TABLE_OPTIONAL";
+            snprintf(size, sizeof(size), "sizeof(*((struct %s *) 0)->%s)", parent, member->name);
+        } else if (type->vector) {
+            shape = "XDR_TABLE_VECTOR";
+            bound = type->vector_bound ? type->vector_bound : "0";
+            snprintf(aux, sizeof(aux), "offsetof(struct %s, num_%s)", parent, member->name);
+            snprintf(size, sizeof(size), "sizeof(*((struct %s *) 0)->%s)", parent, member->name);
+        } else if (type->array) {
+            shape = "XDR_TABLE_ARRAY";
+            bound = type->array_size;
+            snprintf(size, sizeof(size), "sizeof(((struct %s *) 0)->%s[0])", parent, member->name);
+        }
+    }
+
+    if (member->hash) {
+        snprintf(aux, sizeof(aux), "offsetof(struct %s, %s_hash)", parent, member->name);
+    }
+
+    fprintf(source, "    { %s, %s, %d, %d, offsetof(struct %s, %s), %s, %s, %s, %s, %s },\n",
+            kind, shape, swap, member->hash, parent, member->name, aux, bound, size, table, codec);
+} /* emit_table_field */
+
+void
+emit_table_struct(
+    FILE              *source,
+    struct xdr_struct *xdr_structp,
+    int                cxx)
+{
+    struct xdr_struct_member *member;
+    int                       nfields = 0;
+
+    DL_FOREACH(xdr_structp->members, member)
+    {
+        if (nfields++ == 0) {
+            fprintf(source, "static const struct xdr_table_field xdr_table_fields_%s[] = {\n",
+                    xdr_structp->name);
+        }
+
+        emit_table_field(source, xdr_structp->name, member);
+    }
+
+    if (nfields) {
+        fprintf(source, "};\n\n");
+    }
+
+    /* C++ has no tentative definitions, so tables live in an unnamed namespace there */
+    fprintf(source, "%sconst struct xdr_table_type xdr_table_%s = ",
+            cxx ? "namespace { " : "static ", xdr_structp->name);
+
+    if (nfields) {
+        fprintf(source, "{ xdr_table_fields_%s, %d };", xdr_structp->name, nfields);
+    } else {
+        fprintf(source, "{ NULL, 0 };");
+    }
+
+    fprintf(source, "%s\n\n", cxx ? " }" : "");
+} /* emit_table_struct */
+
+/*
+ * Descriptor tables for every table-driven struct, preceded by codecs for
+ * the other types they reference.
+ */
+void
+emit_tables(
+    FILE *source,
+    int   cxx)
+{
+    struct xdr_struct        *xdr_structp, *refp;
+    struct xdr_union         *xdr_unionp;
+    struct xdr_struct_member *member;
+    int                       used;
+
+    DL_FOREACH(xdr_structs, xdr_structp)
+    {
+        if (xdr_structp->table) {
+            fprintf(source, "%s struct xdr_table_type xdr_table_%s;%s\n",
+                    cxx ? "namespace { extern const" : "static const", xdr_structp->name, cxx ? " }" : "");
+        }
+    }
+
+    fprintf(source, "\n");
+
+    /* Linked list structs are never table-driven, so lists go through codecs */
+    DL_FOREACH(xdr_structs, xdr_structp)
+    {
+        if (xdr_structp->table) {
+            continue;
+        }
+
+        used = 0;
+
+        DL_FOREACH(xdr_structs, refp)
+        {
+            DL_FOREACH(refp->members, member)
+            {
+                used |= refp->table && strcmp(member->type->name, xdr_structp->name) == 0;
+            }
+        }
+
+        if (used) {
+            emit_table_codec(source, xdr_structp->name);
+        }
+    }
+
+    DL_FOREACH(xdr_unions, xdr_unionp)
+    {
+        used = 0;
+
+        DL_FOREACH(xdr_structs, refp)
+        {
+            DL_FOREACH(refp->members, member)
+            {
+                used |= refp->table && strcmp(member->type->name, xdr_unionp->name) == 0;
+            }
+        }
+
+        if (used) {
+            emit_table_codec(source, xdr_unionp->name);
+        }
+    }
+
+    DL_FOREACH(xdr_structs, xdr_structp)
+    {
+        if (xdr_structp->table) {
+            emit_table_struct(source, xdr_structp, cxx);
+        }
+    }
+} /* emit_tables */
+
+/* The per-type entry points of a table-driven struct just run its table */
+void
+emit_table_stubs(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "static int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__marshall_%s(\n", name);
+    fprintf(source, "    struct %s *in,\n", name);
+    fprintf(source, "    struct xdr_write_cursor *cursor) {\n");
+    fprintf(source, "    return xdr_table_marshall(&xdr_table_%s, in, cursor);\n", name);
+    fprintf(source, "}\n\n");
+
+    fprintf(source, "static int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__unmarshall_%s_vector(\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    struct xdr_read_cursor *cursor,\n");
+    fprintf(source, "    xdr_dbuf *dbuf) {\n");
+    fprintf(source, "    return xdr_table_unmarshall(&xdr_table_%s, out, cursor, dbuf, 0);\n", name);
+    fprintf(source, "}\n\n");
+
+    fprintf(source, "static int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__unmarshall_%s_contig(\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    struct xdr_read_cursor *cursor,\n");
+    fprintf(source, "    xdr_dbuf *dbuf) {\n");
+    fprintf(source, "    return xdr_table_unmarshall(&xdr_table_%s, out, cursor, dbuf, 1);\n", name);
+    fprintf(source, "}\n\n");
+} /* emit_table_stubs */
+
 void
 emit_wrapper_headers(
     FILE       *header,
-    const char *name)
+    const char *name,
+    int         message)
 {
     fprintf(header, "int marshall_%s(\n", name);
     fprintf(header, "    struct %s *in,\n", name);
@@ -567,6 +972,12 @@ emit_wrapper_headers(
     fprintf(header, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
     fprintf(header, "    int out_offset);\n\n");
 
+    if (message) {
+        fprintf(header, "int marshall_%s_cursor(\n", name);
+        fprintf(header, "    struct %s *in,\n", name);
+        fprintf(header, "    struct xdr_write_cursor *cursor);\n\n");
+    }
+
     fprintf(header, "int unmarshall_%s(\n", name);
     fprintf(header, "    struct %s *out,\n", name);
     fprintf(header, "    xdr_iovec *iov,\n");
@@ -574,37 +985,122 @@ emit_wrapper_headers(
     fprintf(header, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
     fprintf(header, "    xdr_dbuf *dbuf);\n\n");
 
+    fprintf(header, "int unmarshall_%s_cursor(\n", name);
+    fprintf(header, "    struct %s *out,\n", name);
+    fprintf(header, "    struct xdr_read_cursor *cursor,\n");
+    fprintf(header, "    xdr_dbuf *dbuf);\n\n");
+
+    fprintf(header, "int skip_%s(\n", name);
+    fprintf(header, "    xdr_iovec *iov,\n");
+    fprintf(header, "    int niov);\n\n");
+
     fprintf(header, "int marshall_length_%s(const struct %s *in);\n\n", name, name);
 } /* emit_wrapper_headers */
 
 void
-emit_dump_headers(
+emit_digest_wrapper_headers(
     FILE       *header,
     const char *name)
 {
-    fprintf(header,
-            "void dump_%s(const char *name, const struct %s *in);\n\n", name,
-            name);
-} /* emit_dump_headers */
+    fprintf(header, "int marshall_%s_digest(\n", name);
+    fprintf(header, "    struct %s *in,\n", name);
+    fprintf(header, "    xdr_iovec *iov_in,\n");
+    fprintf(header, "    xdr_iovec *iov_out,\n");
+    fprintf(header, "    int *niov_out,\n");
+    fprintf(header, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
+    fprintf(header, "    int out_offset,\n");
+    fprintf(header, "    uint32_t *digest);\n\n");
+
+    fprintf(header, "int unmarshall_%s_digest(\n", name);
+    fprintf(header, "    struct %s *out,\n", name);
+    fprintf(header, "    xdr_iovec *iov,\n");
+    fprintf(header, "    int niov,\n");
+    fprintf(header, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
+    fprintf(header, "    xdr_dbuf *dbuf,\n");
+    fprintf(header, "    uint32_t *digest);\n\n");
+} /* emit_digest_wrapper_headers */
 
 void
-emit_dump_member(
-    FILE            *source,
-    const char      *name,
-    struct xdr_type *type)
+emit_batch_wrapper_headers(
+    FILE       *header,
+    const char *name)
 {
-    if (type->builtin) {
-        if (strcmp(type->name, "uint32_t") == 0) {
-            if (type->vector) {
-                fprintf(source,
-                        "    dump_output(\"%%s.num_%s = %%u\", subprefix, in->num_%s);\n",
-                        name, name);
-                fprintf(source, "    for (int i = 0; i < in->num_%s; i++) {\n",
-                        name);
-                fprintf(source,
-                        "        char subsubprefix[160];\n");
-                fprintf(source,
-                        "        snprintf(subsubprefix, sizeof(subsubprefix), \"%%s.%s[%%d]\", subprefix, i);\n",
+    fprintf(header, "int marshall_%s_batch(\n", name);
+    fprintf(header, "    struct %s *in,\n", name);
+    fprintf(header, "    int n,\n");
+    fprintf(header, "    xdr_iovec *iov_in,\n");
+    fprintf(header, "    xdr_iovec *iov_out,\n");
+    fprintf(header, "    int *niov_out,\n");
+    fprintf(header, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
+    fprintf(header, "    int out_offset,\n");
+    fprintf(header, "    uint32_t *lengths);\n\n");
+
+    fprintf(header, "int unmarshall_%s_batch(\n", name);
+    fprintf(header, "    struct %s *out,\n", name);
+    fprintf(header, "    int n,\n");
+    fprintf(header, "    xdr_iovec *iov,\n");
+    fprintf(header, "    int niov,\n");
+    fprintf(header, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
+    fprintf(header, "    xdr_dbuf *dbuf,\n");
+    fprintf(header, "    uint32_t *lengths);\n\n");
+} /* emit_batch_wrapper_headers */
+
+void
+emit_validate_wrapper_headers(
+    FILE       *header,
+    const char *name)
+{
+    fprintf(header, "int validate_%s(\n", name);
+    fprintf(header, "    xdr_iovec *iov,\n");
+    fprintf(header, "    int niov,\n");
+    fprintf(header, "    int *error_offset);\n\n");
+} /* emit_validate_wrapper_headers */
+
+void
+emit_footprint_wrapper_headers(
+    FILE       *header,
+    const char *name)
+{
+    fprintf(header, "int unmarshall_footprint_%s(\n", name);
+    fprintf(header, "    xdr_iovec *iov,\n");
+    fprintf(header, "    int niov,\n");
+    fprintf(header, "    struct evpl_rpc2_rdma_chunk *rdma_chunk);\n\n");
+
+    fprintf(header, "int marshall_requirements_%s(\n", name);
+    fprintf(header, "    const struct %s *in,\n", name);
+    fprintf(header, "    int out_offset,\n");
+    fprintf(header, "    const struct xdr_marshall_config *config,\n");
+    fprintf(header, "    int *niov);\n\n");
+} /* emit_footprint_wrapper_headers */
+
+void
+emit_dump_headers(
+    FILE       *header,
+    const char *name)
+{
+    fprintf(header,
+            "void dump_%s(const char *name, const struct %s *in);\n\n", name,
+            name);
+} /* emit_dump_headers */
+
+void
+emit_dump_member(
+    FILE            *source,
+    const char      *name,
+    struct xdr_type *type)
+{
+    if (type->builtin) {
+        if (strcmp(type->name, "uint32_t") == 0) {
+            if (type->vector) {
+                fprintf(source,
+                        "    dump_output(\"%%s.num_%s = %%u\", subprefix, in->num_%s);\n",
+                        name, name);
+                fprintf(source, "    for (uint32_t i = 0; i < in->num_%s; i++) {\n",
+                        name);
+                fprintf(source,
+                        "        char subsubprefix[160];\n");
+                fprintf(source,
+                        "        snprintf(subsubprefix, sizeof(subsubprefix), \"%%s.%s[%%d]\", subprefix, i);\n",
                         name);
                 fprintf(source,
                         "        dump_output(\"%%s.%s = %%08x\", subsubprefix, in->%s[i]);\n",
@@ -660,7 +1156,7 @@ emit_dump_member(
             fprintf(source,
                     "    dump_output(\"%%s.num_%s = %%u\", subprefix, in->num_%s);\n",
                     name, name);
-            fprintf(source, "   for (int i = 0; i < in->num_%s; i++) {\n", name)
+            fprintf(source, "   for (uint32_t i = 0; i < in->num_%s; i++) {\n", name)
             ;
             fprintf(source, "       char subsubprefix[80];\n");
             fprintf(source,
@@ -682,6 +1178,9 @@ emit_dump_member(
     }
 } /* emit_dump_member */
 
+static int type_fixed_wire_size(
+    struct xdr_type *type);
+
 void
 emit_length_member(
     FILE            *source,
@@ -690,6 +1189,7 @@ emit_length_member(
 {
     struct xdr_type       *emit_type;
     struct xdr_identifier *chk;
+    int                    size;
 
     HASH_FIND_STR(xdr_identifiers, type->name, chk);
 
@@ -699,9 +1199,14 @@ emit_length_member(
         emit_type = type;
     }
 
-    if (emit_type->opaque) {
+    size = type_fixed_wire_size(emit_type);
+
+    if (size >= 0) {
+        fprintf(source, "    length += %d;\n", size);
+    } else if (emit_type->opaque) {
         if (emit_type->array) {
-            fprintf(source, "    length += xdr_pad(%s);\n", emit_type->array_size);
+            /* Fixed opaques are encoded without padding */
+            fprintf(source, "    length += %s;\n", emit_type->array_size);
         } else if (emit_type->zerocopy) {
             fprintf(source, "    length += 4 + in->%s.length + xdr_pad(in->%s.length);\n", name, name);
         } else {
@@ -711,7 +1216,7 @@ emit_length_member(
         fprintf(source, "    length += 4 + in->%s.len + xdr_pad(in->%s.len);\n", name, name);
     } else if (emit_type->vector) {
         fprintf(source, "    length += 4;\n");
-        fprintf(source, "    for (int i = 0; i < in->num_%s; i++) {\n", name);
+        fprintf(source, "    for (uint32_t i = 0; i < in->num_%s; i++) {\n", name);
         fprintf(source, "        length += __marshall_length_%s(&in->%s[i]);\n", type->name, name);
         fprintf(source, "    }\n");
     } else if (emit_type->optional) {
@@ -720,7 +1225,7 @@ emit_length_member(
         fprintf(source, "        length += __marshall_length_%s(in->%s);\n", type->name, name);
         fprintf(source, "    }\n");
     } else if (emit_type->array) {
-        fprintf(source, "    for (int i = 0; i < %s; i++) {\n", emit_type->array_size);
+        fprintf(source, "    for (uint32_t i = 0; i < %s; i++) {\n", emit_type->array_size);
         fprintf(source, "        length += __marshall_length_%s(&in->%s[i]);\n", type->name, name);
         fprintf(source, "    }\n");
     } else {
@@ -779,7 +1284,14 @@ emit_length_struct(
     struct xdr_struct_member *member;
     int                       is_recursive = is_type_recursive(name);
 
-    if (is_recursive) {
+    if (xdr_structp->table) {
+        fprintf(source,
+                "static int __marshall_length_%s(const struct %s *in)\n",
+                name, name);
+        fprintf(source, "{\n");
+        fprintf(source, "    return xdr_table_length(&xdr_table_%s, in);\n", name);
+        fprintf(source, "}\n\n");
+    } else if (is_recursive) {
         fprintf(source,
                 "static int __marshall_length_%s(const struct %s *in)\n",
                 name, name);
@@ -789,22 +1301,30 @@ emit_length_struct(
                 name, name);
     }
 
-    fprintf(source, "{\n");
-    fprintf(source, "    uint32_t length = 0;\n");
+    if (!xdr_structp->table) {
+        fprintf(source, "{\n");
+        fprintf(source, "    uint32_t length = 0;\n");
 
-    DL_FOREACH(xdr_structp->members, member)
-    {
-        emit_length_member(source, member->name, member->type);
+        DL_FOREACH(xdr_structp->members, member)
+        {
+            emit_length_member(source, member->name, member->type);
+        }
+        fprintf(source, "    return length;\n");
+        fprintf(source, "}\n\n");
     }
-    fprintf(source, "    return length;\n");
-    fprintf(source, "}\n\n");
+} /* emit_length_struct */
 
+void
+emit_length_wrapper(
+    FILE       *source,
+    const char *name)
+{
     fprintf(source, "int marshall_length_%s(const struct %s *in)\n",
             name, name);
     fprintf(source, "{\n");
     fprintf(source, "    return __marshall_length_%s(in);\n", name);
     fprintf(source, "}\n\n");
-} /* emit_length_struct */
+} /* emit_length_wrapper */
 
 void
 emit_dump_union(
@@ -845,95 +1365,2540 @@ emit_dump_union(
     }
 
     fprintf(source, "    }\n");
-    fprintf(source, "}\n\n");
-
-    fprintf(source, "void dump_%s(const char *name, const struct %s *in)\n",
-            name, name);
-    fprintf(source, "{\n");
-    fprintf(source, "    _dump_%s(\"\", \"%s\", in);\n", name, name);
-    fprintf(source, "}\n\n");
-} /* emit_dump_union */
-
-/*
- * Check if a type is a variable-length opaque (has its own length prefix).
- * For opaque_union, if a case type is variable-length opaque, we should NOT
- * emit the separate body_len prefix since the opaque's length IS the body length.
- */
-static int
-is_varlen_opaque(struct xdr_type *type)
-{
-    return type && type->opaque && !type->array;
-} /* is_varlen_opaque */
+    fprintf(source, "}\n\n");
+
+    fprintf(source, "void dump_%s(const char *name, const struct %s *in)\n",
+            name, name);
+    fprintf(source, "{\n");
+    fprintf(source, "    _dump_%s(\"\", \"%s\", in);\n", name, name);
+    fprintf(source, "}\n\n");
+} /* emit_dump_union */
+
+/*
+ * Check if a type is a variable-length opaque (has its own length prefix).
+ * For opaque_union, if a case type is variable-length opaque, we should NOT
+ * emit the separate body_len prefix since the opaque's length IS the body length.
+ */
+static int
+is_varlen_opaque(struct xdr_type *type)
+{
+    return type && type->opaque && !type->array;
+} /* is_varlen_opaque */
+
+/*
+ * The case whose body runs for a label.  Labels without a body fall
+ * through to the next case in the order generated switches emit them:
+ * the remaining labelled cases, then default.
+ */
+static struct xdr_union_case *
+union_case_arm(
+    struct xdr_union      *xdr_unionp,
+    struct xdr_union_case *casep)
+{
+    struct xdr_union_case *next;
+    int                    is_default = strcmp(casep->label, "default") == 0;
+
+    if (casep->type || casep->voided) {
+        return casep;
+    }
+
+    if (is_default) {
+        return NULL;
+    }
+
+    for (next = casep->next; next; next = next->next) {
+        if (strcmp(next->label, "default") != 0 && (next->type || next->voided)) {
+            return next;
+        }
+    }
+
+    DL_FOREACH(xdr_unionp->cases, next)
+    {
+        if (strcmp(next->label, "default") == 0) {
+            return union_case_arm(xdr_unionp, next);
+        }
+    }
+
+    return NULL;
+} /* union_case_arm */
+
+/*
+ * Marshall one opaque_union arm.  The body length is not known until
+ * the body has been encoded, so a slot is reserved for it and patched
+ * afterwards.  Varlen opaque arms carry their own length instead.
+ */
+static void
+emit_marshall_opaque_arm(
+    FILE                  *source,
+    struct xdr_union_case *casep)
+{
+    if (!casep->type && !casep->voided) {
+        return;
+    }
+
+    if (is_varlen_opaque(casep->type)) {
+        emit_marshall(source, casep->name, casep->type);
+        fprintf(source, "        break;\n");
+        return;
+    }
+
+    fprintf(source, "        {\n");
+    fprintf(source, "            uint32_t *body_len, body_start;\n");
+    fprintf(source, "            if (unlikely(xdr_write_cursor_length_slot(cursor, &body_len, &body_start) < 0)) return -1;\n");
+
+    if (casep->type) {
+        emit_marshall(source, casep->name, casep->type);
+    }
+
+    fprintf(source, "            xdr_write_cursor_length_patch(cursor, body_len, body_start);\n");
+    fprintf(source, "        }\n");
+    fprintf(source, "        break;\n");
+} /* emit_marshall_opaque_arm */
+
+void
+emit_length_union(
+    FILE             *source,
+    const char       *name,
+    struct xdr_union *xdr_unionp)
+{
+    struct xdr_union_case *casep;
+    int                    is_recursive = is_type_recursive(name);
+
+    if (is_recursive) {
+        fprintf(source,
+                "static int __marshall_length_%s(const struct %s *in)\n",
+                name, name);
+    } else {
+        fprintf(source,
+                "static FORCE_INLINE int __marshall_length_%s(const struct %s *in)\n",
+                name, name);
+    }
+    fprintf(source, "{\n");
+    fprintf(source, "    uint32_t length = 0;\n");
+    emit_length_member(source, xdr_unionp->pivot_name, xdr_unionp->pivot_type);
+    fprintf(source, "    switch (in->%s) {\n", xdr_unionp->pivot_name);
+
+    DL_FOREACH(xdr_unionp->cases, casep)
+    {
+        if (strcmp(casep->label, "default") != 0) {
+            fprintf(source, "    case %s:\n", casep->label);
+            if (!casep->type && !casep->voided) {
+                continue;
+            }
+            /*
+             * For opaque_union, add body_len prefix (4 bytes) except for
+             * varlen opaque types which have their own length prefix.
+             */
+            if (xdr_unionp->opaque && !is_varlen_opaque(casep->type)) {
+                fprintf(source, "        length += 4; /* opaque union body length prefix */\n");
+            }
+            if (casep->type) {
+                emit_length_member(source, casep->name, casep->type);
+            }
+            fprintf(source, "        break;\n");
+        }
+    }
+
+    DL_FOREACH(xdr_unionp->cases, casep)
+    {
+        if (strcmp(casep->label, "default") == 0) {
+            fprintf(source, "    default:\n");
+            if (!casep->type && !casep->voided) {
+                continue;
+            }
+            /*
+             * For opaque_union, add body_len prefix (4 bytes) except for
+             * varlen opaque types which have their own length prefix.
+             */
+            if (xdr_unionp->opaque && !is_varlen_opaque(casep->type)) {
+                fprintf(source, "        length += 4; /* opaque union body length prefix */\n");
+            }
+            if (casep->type) {
+                emit_length_member(source, casep->name, casep->type);
+            }
+            fprintf(source, "        break;\n");
+        }
+    }
+
+    fprintf(source, "    }\n");
+    fprintf(source, "    return length;\n");
+    fprintf(source, "}\n\n");
+} /* emit_length_union */
+
+/* Resolve an array size that is either a literal or a named constant */
+static int
+resolve_size(const char *str)
+{
+    struct xdr_identifier *chk;
+    char                  *end;
+    long                   value;
+
+    HASH_FIND_STR(xdr_identifiers, str, chk);
+
+    if (chk && chk->type == XDR_CONST) {
+        str = ((struct xdr_const *) chk->ptr)->value;
+    }
+
+    value = strtol(str, &end, 0);
+
+    if (*end != '\0' || value < 0 || value > 0x7fffffff) {
+        return -1;
+    }
+
+    return value;
+} /* resolve_size */
+
+/*
+ * Wire size of a single element of the given type, ignoring any
+ * array, vector or optional qualifier, or -1 if it is not constant.
+ */
+static int
+type_element_wire_size(struct xdr_type *type)
+{
+    struct xdr_identifier    *chk;
+    struct xdr_struct        *xdr_structp;
+    struct xdr_struct_member *member;
+    int                       size, msize;
+
+    if (type->builtin) {
+        return builtin_wire_size(type);
+    }
+
+    if (type->enumeration) {
+        return 4;
+    }
+
+    HASH_FIND_STR(xdr_identifiers, type->name, chk);
+
+    if (!chk) {
+        return -1;
+    }
+
+    switch (chk->type) {
+        case XDR_ENUM:
+            return 4;
+        case XDR_TYPEDEF:
+            return type_fixed_wire_size(((struct xdr_typedef *) chk->ptr)->type);
+        case XDR_STRUCT:
+            xdr_structp = (struct xdr_struct *) chk->ptr;
+
+            if (xdr_structp->linkedlist) {
+                return -1;
+            }
+
+            size = 0;
+
+            DL_FOREACH(xdr_structp->members, member)
+            {
+                msize = type_fixed_wire_size(member->type);
+
+                if (msize < 0) {
+                    return -1;
+                }
+
+                size += msize;
+            }
+            return size;
+        default:
+            return -1;
+    } /* switch */
+} /* type_element_wire_size */
+
+/* Wire size of a member of the given type, or -1 if it is not constant */
+static int
+type_fixed_wire_size(struct xdr_type *type)
+{
+    int count = 1, size;
+
+    if (type->optional || type->linkedlist || type->vector) {
+        return -1;
+    }
+
+    if (type->array) {
+        count = resolve_size(type->array_size);
+
+        if (count < 0) {
+            return -1;
+        }
+    }
+
+    if (type->opaque) {
+        return type->array ? count : -1;
+    }
+
+    size = type_element_wire_size(type);
+
+    if (size < 0 || (count && size > 0x7fffffff / count)) {
+        return -1;
+    }
+
+    return size * count;
+} /* type_fixed_wire_size */
+
+/*
+ * Fixed runs are bounds checked once and then encoded with straight-line
+ * stores.  Runs decoded from a split vector are gathered on the stack,
+ * so they are capped at this many bytes.
+ */
+#define XDR_RUN_MAX 512
+
+/* Name of the __pack_X()/__unpack_X() helpers for a run member */
+static const char *
+run_type_name(struct xdr_type *type)
+{
+    struct xdr_identifier *chk;
+
+    if (type->builtin) {
+        return builtin_wire_size(type) > 0 ? type->name : NULL;
+    }
+
+    HASH_FIND_STR(xdr_identifiers, type->name, chk);
+
+    if (!chk) {
+        return NULL;
+    }
+
+    if (chk->type == XDR_ENUM) {
+        return "uint32_t";
+    }
+
+    return chk->type == XDR_STRUCT ? type->name : NULL;
+} /* run_type_name */
+
+/*
+ * Size of a member that can be part of a fixed run: a scalar, a fixed
+ * opaque, a struct of constant wire size or a fixed array of those.
+ * Returns -1 for any other member.
+ */
+static int
+run_member_size(struct xdr_type *type)
+{
+    int size = type_fixed_wire_size(type);
+
+    if (size < 0 || size > XDR_RUN_MAX) {
+        return -1;
+    }
+
+    if (!type->opaque && !run_type_name(type)) {
+        return -1;
+    }
+
+    return size;
+} /* run_member_size */
+
+/* Whether a struct is packed as a whole by the containing run */
+static int
+is_run_struct(struct xdr_struct *xdr_structp)
+{
+    struct xdr_type type;
+
+    if (xdr_structp->linkedlist) {
+        return 0;
+    }
+
+    memset(&type, 0, sizeof(type));
+    type.name = xdr_structp->name;
+
+    return run_member_size(&type) >= 0;
+} /* is_run_struct */
+
+static void
+emit_run_member(
+    FILE            *source,
+    const char      *name,
+    struct xdr_type *type,
+    int              offset,
+    int              pack,
+    const char      *indent)
+{
+    const char *var = pack ? "in" : "out";
+    const char *fn  = pack ? "pack" : "unpack";
+    int         width;
+
+    if (type->opaque) {
+        if (pack) {
+            fprintf(source, "%smemcpy(p + %d, in->%s, %s);\n", indent, offset, name, type->array_size);
+        } else {
+            fprintf(source, "%smemcpy(out->%s, p + %d, %s);\n", indent, name, offset, type->array_size);
+        }
+    } else if (type->array) {
+        width = type_element_wire_size(type);
+        fprintf(source, "%sfor (uint32_t i = 0; i < %s; i++) {\n", indent, type->array_size);
+        fprintf(source, "%s    __%s_%s(&%s->%s[i], p + %d + i * %d);\n",
+                indent, fn, run_type_name(type), var, name, offset, width);
+        fprintf(source, "%s}\n", indent);
+    } else {
+        fprintf(source, "%s__%s_%s(&%s->%s, p + %d);\n",
+                indent, fn, run_type_name(type), var, name, offset);
+    }
+} /* emit_run_member */
+
+/* Emit one bounds check and the stores or loads of members [first, last) */
+static void
+emit_run(
+    FILE                     *source,
+    struct xdr_struct_member *first,
+    struct xdr_struct_member *last,
+    int                       size,
+    const char               *mode)
+{
+    struct xdr_struct_member *member;
+    int                       offset = 0, pack = strcmp(mode, "marshall") == 0;
+
+    if (size == 0) {
+        return;
+    }
+
+    fprintf(source, "    {\n");
+
+    if (pack) {
+        fprintf(source, "        char *p = xdr_write_cursor_run(cursor, %d);\n", size);
+    } else if (strcmp(mode, "vector") == 0) {
+        fprintf(source, "        char tmp[%d];\n", size);
+        fprintf(source, "        const char *p = xdr_read_cursor_vector_run(cursor, tmp, %d);\n", size);
+    } else {
+        fprintf(source, "        const char *p = xdr_read_cursor_contig_run(cursor, %d);\n", size);
+    }
+
+    fprintf(source, "        if (unlikely(p == NULL)) return -1;\n");
+
+    for (member = first; member != last; member = member->next) {
+        emit_run_member(source, member->name, member->type, offset, pack, "        ");
+        offset += run_member_size(member->type);
+    }
+
+    if (!pack) {
+        fprintf(source, "        len += %d;\n", size);
+    }
+
+    fprintf(source, "    }\n");
+} /* emit_run */
+
+/* Members marked with %xdrzcc hash get their hash stored as soon as decoded */
+static void
+emit_member_hash(
+    FILE                     *source,
+    struct xdr_struct_member *member)
+{
+    const char *data = member->type->opaque ? "data" : "str";
+
+    if (!member->hash) {
+        return;
+    }
+
+    fprintf(source, "    out->%s_hash = xdr_hash(out->%s.%s, out->%s.len);\n",
+            member->name, member->name, data, member->name);
+} /* emit_member_hash */
+
+/*
+ * Emit the members of a struct for marshall, vector or contig unmarshall,
+ * grouping consecutive fixed-size members into runs.
+ */
+static void
+emit_struct_members(
+    FILE              *source,
+    struct xdr_struct *xdr_structp,
+    const char        *mode)
+{
+    struct xdr_struct_member *member, *first = NULL;
+    int                       size = 0, msize;
+
+    DL_FOREACH(xdr_structp->members, member)
+    {
+        if (xdr_structp->linkedlist && strncmp(member->name, "next", 4) == 0) {
+            msize = -1;
+        } else {
+            msize = run_member_size(member->type);
+        }
+
+        if (first && (msize < 0 || size + msize > XDR_RUN_MAX)) {
+            emit_run(source, first, member, size, mode);
+            first = NULL;
+        }
+
+        if (msize >= 0) {
+            if (!first) {
+                first = member;
+                size  = 0;
+            }
+            size += msize;
+        } else if (xdr_structp->linkedlist && strncmp(member->name, "next", 4) == 0) {
+            continue;
+        } else if (strcmp(mode, "marshall") == 0) {
+            emit_marshall(source, member->name, member->type);
+        } else if (strcmp(mode, "vector") == 0) {
+            emit_unmarshall(source, member->name, member->type);
+            emit_member_hash(source, member);
+        } else {
+            emit_unmarshall_contig(source, member->name, member->type);
+            emit_member_hash(source, member);
+        }
+    }
+
+    if (first) {
+        emit_run(source, first, NULL, size, mode);
+    }
+} /* emit_struct_members */
+
+void
+emit_pack_headers(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "static FORCE_INLINE void\n");
+    fprintf(source, "__pack_%s(\n", name);
+    fprintf(source, "    const struct %s *in,\n", name);
+    fprintf(source, "    char *p);\n\n");
+    fprintf(source, "static FORCE_INLINE void\n");
+    fprintf(source, "__unpack_%s(\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    const char *p);\n\n");
+} /* emit_pack_headers */
+
+/* Unchecked encode and decode of a struct with a constant wire size */
+void
+emit_pack_struct(
+    FILE              *source,
+    const char        *name,
+    struct xdr_struct *xdr_structp)
+{
+    struct xdr_struct_member *member;
+    int                       offset, pack;
+
+    for (pack = 1; pack >= 0; pack--) {
+        fprintf(source, "static FORCE_INLINE void\n");
+
+        if (pack) {
+            fprintf(source, "__pack_%s(\n", name);
+            fprintf(source, "    const struct %s *in,\n", name);
+            fprintf(source, "    char *p) {\n");
+        } else {
+            fprintf(source, "__unpack_%s(\n", name);
+            fprintf(source, "    struct %s *out,\n", name);
+            fprintf(source, "    const char *p) {\n");
+        }
+
+        offset = 0;
+
+        DL_FOREACH(xdr_structp->members, member)
+        {
+            emit_run_member(source, member->name, member->type, offset, pack, "    ");
+            offset += run_member_size(member->type);
+        }
+
+        fprintf(source, "}\n\n");
+    }
+} /* emit_pack_struct */
+
+void
+emit_wire_size(
+    FILE              *header,
+    struct xdr_struct *xdr_structp)
+{
+    struct xdr_type type;
+    int             size;
+
+    if (xdr_structp->linkedlist) {
+        return;
+    }
+
+    memset(&type, 0, sizeof(type));
+    type.name = xdr_structp->name;
+
+    size = type_fixed_wire_size(&type);
+
+    if (size >= 0) {
+        fprintf(header, "#define XDR_WIRE_SIZE_%s %d\n", xdr_structp->name, size);
+    }
+} /* emit_wire_size */
+
+/*
+ * Worst-case encoded size of a type and the number of output iovecs its
+ * zero-copy payloads can add: one flushing the scratch run before each
+ * payload, plus one per byte for payloads passed as single-byte iovecs.
+ * Returns -1 if either has no static bound, which is the case for
+ * unbounded strings, opaques and vectors, lists and recursive types.
+ */
+static int
+type_max(
+    struct xdr_type *type,
+    int64_t         *wire,
+    int64_t         *zciov,
+    const char     **seen,
+    int              depth);
+
+static int
+type_max_element(
+    struct xdr_type *type,
+    int64_t         *wire,
+    int64_t         *zciov,
+    const char     **seen,
+    int              depth)
+{
+    struct xdr_identifier    *chk;
+    struct xdr_struct        *xdr_structp;
+    struct xdr_struct_member *member;
+    struct xdr_union         *xdr_unionp;
+    struct xdr_union_case    *casep;
+    int64_t                   mwire, mziov;
+    int                       i;
+
+    *wire  = 0;
+    *zciov = 0;
+
+    if (type->builtin || type->enumeration) {
+        *wire = type_element_wire_size(type);
+        return *wire < 0 ? -1 : 0;
+    }
+
+    HASH_FIND_STR(xdr_identifiers, type->name, chk);
+
+    if (!chk || depth >= 64) {
+        return -1;
+    }
+
+    for (i = 0; i < depth; i++) {
+        if (strcmp(seen[i], type->name) == 0) {
+            return -1;
+        }
+    }
+
+    seen[depth] = type->name;
+
+    switch (chk->type) {
+        case XDR_ENUM:
+            *wire = 4;
+            return 0;
+        case XDR_TYPEDEF:
+            return type_max(((struct xdr_typedef *) chk->ptr)->type, wire, zciov, seen, depth + 1);
+        case XDR_STRUCT:
+            xdr_structp = (struct xdr_struct *) chk->ptr;
+
+            if (xdr_structp->linkedlist) {
+                return -1;
+            }
+
+            DL_FOREACH(xdr_structp->members, member)
+            {
+                if (type_max(member->type, &mwire, &mziov, seen, depth + 1) < 0) {
+                    return -1;
+                }
+
+                *wire  += mwire;
+                *zciov += mziov;
+
+                if (*wire > INT32_MAX || *zciov > INT32_MAX) {
+                    return -1;
+                }
+            }
+            return 0;
+        case XDR_UNION:
+            xdr_unionp = (struct xdr_union *) chk->ptr;
+
+            /* An opaque union body has its own length word */
+            *wire = xdr_unionp->opaque ? 4 : 0;
+
+            DL_FOREACH(xdr_unionp->cases, casep)
+            {
+                if (!casep->type) {
+                    continue;
+                }
+
+                if (type_max(casep->type, &mwire, &mziov, seen, depth + 1) < 0) {
+                    return -1;
+                }
+
+                if (xdr_unionp->opaque && !is_varlen_opaque(casep->type)) {
+                    mwire += 4;
+                }
+
+                *wire  = mwire > *wire ? mwire : *wire;
+                *zciov = mziov > *zciov ? mziov : *zciov;
+            }
+
+            mwire = type_element_wire_size(xdr_unionp->pivot_type);
+
+            if (mwire < 0 || *wire + mwire > INT32_MAX) {
+                return -1;
+            }
+
+            *wire += mwire;
+            return 0;
+        default:
+            return -1;
+    } /* switch */
+} /* type_max_element */
+
+static int
+type_max(
+    struct xdr_type *type,
+    int64_t         *wire,
+    int64_t         *zciov,
+    const char     **seen,
+    int              depth)
+{
+    int64_t count = 1, ewire, eziov;
+
+    if (type->linkedlist) {
+        return -1;
+    }
+
+    if (type->vector) {
+        count = type->vector_bound ? resolve_size(type->vector_bound) : -1;
+    } else if (type->array) {
+        count = resolve_size(type->array_size);
+    }
+
+    if (count < 0) {
+        return -1;
+    }
+
+    if (type->opaque || strcmp(type->name, "xdr_string") == 0) {
+        if (!type->vector && !type->array) {
+            return -1;
+        }
+
+        /* Fixed opaques are encoded without padding */
+        *wire  = type->array ? count : 4 + ((count + 3) & ~3);
+        *zciov = type->zerocopy ? 1 + count : 0;
+        return *wire > INT32_MAX ? -1 : 0;
+    }
+
+    if (type_max_element(type, &ewire, &eziov, seen, depth) < 0) {
+        return -1;
+    }
+
+    *wire  = count * ewire + (type->vector || type->optional ? 4 : 0);
+    *zciov = count * eziov;
+
+    return *wire > INT32_MAX || *zciov > INT32_MAX ? -1 : 0;
+} /* type_max */
+
+/*
+ * Emit an expression for the most dbuf space unmarshalling a member can
+ * take from niov input iovecs: a zero-copy opaque may reference every
+ * one of them, and any string or opaque may be copied out.
+ */
+static void
+emit_max_dbuf(
+    FILE            *header,
+    const char      *parent,
+    const char      *name,
+    struct xdr_type *type)
+{
+    char elem[256];
+    int  count;
+
+    snprintf(elem, sizeof(elem), "sizeof(*((struct %s *) 0)->%s)", parent, name);
+
+    if (type->opaque || strcmp(type->name, "xdr_string") == 0) {
+        if (type->array) {
+            fprintf(header, "0");
+        } else if (type->zerocopy) {
+            fprintf(header, "XDR_DBUF_ROUND(sizeof(xdr_iovec) * (niov))");
+        } else {
+            fprintf(header, "XDR_DBUF_ROUND(%d)", resolve_size(type->vector_bound));
+        }
+        return;
+    }
+
+    count = type->vector ? resolve_size(type->vector_bound) :
+        type->array ? resolve_size(type->array_size) : 1;
+
+    if (type->builtin || type->enumeration) {
+        if (type->vector) {
+            fprintf(header, "XDR_DBUF_ROUND(%d * %s)", count, elem);
+        } else if (type->optional) {
+            fprintf(header, "XDR_DBUF_ROUND(%s)", elem);
+        } else {
+            fprintf(header, "0");
+        }
+        return;
+    }
+
+    if (type->vector) {
+        fprintf(header, "XDR_DBUF_ROUND(%d * %s) + ", count, elem);
+    } else if (type->optional) {
+        fprintf(header, "XDR_DBUF_ROUND(%s) + ", elem);
+    }
+
+    if (count != 1) {
+        fprintf(header, "%d * ", count);
+    }
+
+    fprintf(header, "XDR_MAX_DBUF_%s(niov)", type->name);
+} /* emit_max_dbuf */
+
+void
+emit_max_size(
+    FILE              *header,
+    const char        *name,
+    struct xdr_struct *xdr_structp,
+    struct xdr_union  *xdr_unionp)
+{
+    struct xdr_type           type;
+    struct xdr_struct_member *member;
+    struct xdr_union_case    *casep;
+    const char               *seen[64];
+    int64_t                   wire, zciov;
+    int                       arms = 0;
+
+    memset(&type, 0, sizeof(type));
+    type.name = (char *) name;
+
+    if (type_max(&type, &wire, &zciov, seen, 0) < 0 || zciov + 1 > INT32_MAX) {
+        fprintf(header, "#define XDR_MAX_WIRE_SIZE_%s XDR_UNBOUNDED\n", name);
+        fprintf(header, "#define XDR_MAX_IOV_%s XDR_UNBOUNDED\n", name);
+        fprintf(header, "#define XDR_MAX_DBUF_%s(niov) XDR_UNBOUNDED\n", name);
+        return;
+    }
+
+    fprintf(header, "#define XDR_MAX_WIRE_SIZE_%s %d\n", name, (int) wire);
+    fprintf(header, "#define XDR_MAX_IOV_%s %d\n", name, (int) zciov + 1);
+    fprintf(header, "#define XDR_MAX_DBUF_%s(niov) ((int64_t) (", name);
+
+    if (xdr_structp) {
+        DL_FOREACH(xdr_structp->members, member)
+        {
+            emit_max_dbuf(header, name, member->name, member->type);
+            fprintf(header, " + ");
+        }
+    } else {
+        DL_FOREACH(xdr_unionp->cases, casep)
+        {
+            if (casep->type) {
+                fprintf(header, "XDR_DBUF_MAX(");
+                emit_max_dbuf(header, name, casep->name, casep->type);
+                fprintf(header, ", ");
+                arms++;
+            }
+        }
+    }
+
+    fprintf(header, "0");
+
+    while (arms--) {
+        fprintf(header, ")");
+    }
+
+    fprintf(header, "))\n");
+} /* emit_max_size */
+
+/* Emit code advancing the read cursor past one encoded member */
+static void
+emit_skip(
+    FILE            *source,
+    struct xdr_type *type,
+    const char      *mode)
+{
+    int size, width;
+
+    size  = type_fixed_wire_size(type);
+    width = type_element_wire_size(type);
+
+    if (size >= 0) {
+        fprintf(source, "    rc = xdr_read_cursor_%s_skip(cursor, %d);\n", mode, size);
+    } else if (type->opaque || strcmp(type->name, "xdr_string") == 0) {
+        fprintf(source, "    rc = __skip_opaque_%s(cursor);\n", mode);
+    } else if (type->linkedlist || type->optional) {
+        fprintf(source, "    {\n");
+        fprintf(source, "        uint32_t more;\n");
+        fprintf(source, "        rc = __unmarshall_uint32_t_%s(&more, cursor, NULL);\n", mode);
+        fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "        len += rc;\n");
+        fprintf(source, "        %s (more) {\n", type->linkedlist ? "while" : "if");
+        fprintf(source, "            rc = __skip_%s_%s(cursor);\n", type->name, mode);
+        fprintf(source, "            if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "            len += rc;\n");
+        if (type->linkedlist) {
+            fprintf(source, "            rc = __unmarshall_uint32_t_%s(&more, cursor, NULL);\n", mode);
+            fprintf(source, "            if (unlikely(rc < 0)) return rc;\n");
+            fprintf(source, "            len += rc;\n");
+        }
+        fprintf(source, "        }\n");
+        fprintf(source, "        rc = 0;\n");
+        fprintf(source, "    }\n");
+    } else if (type->vector && width > 0) {
+        fprintf(source, "    rc = __skip_fixed_%s(cursor, %d);\n", mode, width);
+    } else if (type->vector) {
+        fprintf(source, "    {\n");
+        fprintf(source, "        uint32_t count;\n");
+        fprintf(source, "        rc = __unmarshall_uint32_t_%s(&count, cursor, NULL);\n", mode);
+        fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "        len += rc;\n");
+        fprintf(source, "        for (uint32_t i = 0; i < count; i++) {\n");
+        fprintf(source, "            rc = __skip_%s_%s(cursor);\n", type->name, mode);
+        fprintf(source, "            if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "            len += rc;\n");
+        fprintf(source, "        }\n");
+        fprintf(source, "        rc = 0;\n");
+        fprintf(source, "    }\n");
+    } else if (type->array) {
+        fprintf(source, "    for (uint32_t i = 0; i < %s; i++) {\n", type->array_size);
+        fprintf(source, "        rc = __skip_%s_%s(cursor);\n", type->name, mode);
+        fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "        len += rc;\n");
+        fprintf(source, "    }\n");
+        fprintf(source, "    rc = 0;\n");
+    } else {
+        fprintf(source, "    rc = __skip_%s_%s(cursor);\n", type->name, mode);
+    }
+
+    fprintf(source, "    if (unlikely(rc < 0)) return rc;\n");
+    fprintf(source, "    len += rc;\n");
+} /* emit_skip */
+
+void
+emit_skip_headers(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "static inline int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__skip_%s_vector(\n", name);
+    fprintf(source, "    struct xdr_read_cursor *cursor);\n\n");
+
+    fprintf(source, "static inline int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__skip_%s_contig(\n", name);
+    fprintf(source, "    struct xdr_read_cursor *cursor);\n\n");
+} /* emit_skip_headers */
+
+void
+emit_skip_wrapper(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "int WARN_UNUSED_RESULT\n");
+    fprintf(source, "skip_%s(\n", name);
+    fprintf(source, "    xdr_iovec *iov,\n");
+    fprintf(source, "    int niov) {\n");
+    fprintf(source, "    struct xdr_read_cursor cursor;\n");
+    fprintf(source, "    if (niov == 1) {\n");
+    fprintf(source, "        xdr_read_cursor_contig_init(&cursor, iov, NULL);\n");
+    fprintf(source, "        return __skip_%s_contig(&cursor);\n", name);
+    fprintf(source, "    } else {\n");
+    fprintf(source, "        xdr_read_cursor_vector_init(&cursor, iov, niov, NULL);\n");
+    fprintf(source, "        return __skip_%s_vector(&cursor);\n", name);
+    fprintf(source, "    }\n");
+    fprintf(source, "}\n\n");
+} /* emit_skip_wrapper */
+
+void
+emit_skip_struct(
+    FILE              *source,
+    const char        *name,
+    struct xdr_struct *xdr_structp,
+    const char        *mode)
+{
+    struct xdr_struct_member *member;
+
+    fprintf(source, "static inline int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__skip_%s_%s(\n", name, mode);
+    fprintf(source, "    struct xdr_read_cursor *cursor) {\n");
+    fprintf(source, "    int rc, len = 0;\n");
+
+    DL_FOREACH(xdr_structp->members, member)
+    {
+        if (xdr_structp->linkedlist && strncmp(member->name, "next", 4) == 0) {
+            continue;
+        }
+
+        emit_skip(source, member->type, mode);
+    }
+
+    fprintf(source, "    return len;\n");
+    fprintf(source, "}\n\n");
+} /* emit_skip_struct */
+
+void
+emit_skip_union(
+    FILE             *source,
+    const char       *name,
+    struct xdr_union *xdr_unionp,
+    const char       *mode)
+{
+    struct xdr_union_case *casep;
+    int                    is_default, has_default = 0;
+
+    fprintf(source, "static inline int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__skip_%s_%s(\n", name, mode);
+    fprintf(source, "    struct xdr_read_cursor *cursor) {\n");
+    fprintf(source, "    int rc, len = 0;\n");
+    fprintf(source, "    %s pivot;\n", xdr_unionp->pivot_type->name);
+    fprintf(source, "    rc = __unmarshall_%s_%s(&pivot, cursor, NULL);\n",
+            xdr_unionp->pivot_type->name, mode);
+    fprintf(source, "    if (unlikely(rc < 0)) return rc;\n");
+    fprintf(source, "    len += rc;\n");
+    fprintf(source, "    switch (pivot) {\n");
+
+    /* Non-default arms first, then default, matching the unmarshall switch */
+    for (is_default = 0; is_default < 2; is_default++) {
+        DL_FOREACH(xdr_unionp->cases, casep)
+        {
+            if ((strcmp(casep->label, "default") == 0) != is_default) {
+                continue;
+            }
+
+            if (is_default) {
+                has_default = 1;
+                fprintf(source, "    default:\n");
+            } else {
+                fprintf(source, "    case %s:\n", casep->label);
+            }
+
+            if (xdr_unionp->opaque) {
+                /* Every opaque union arm is length-prefixed on the wire */
+                if (!casep->type && !casep->voided) {
+                    continue;
+                }
+                if (is_varlen_opaque(casep->type)) {
+                    fprintf(source, "        rc = __skip_opaque_%s(cursor);\n", mode);
+                } else {
+                    fprintf(source, "        rc = __skip_fixed_%s(cursor, 1);\n", mode);
+                }
+                fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+                fprintf(source, "        len += rc;\n");
+                fprintf(source, "        break;\n");
+            } else if (casep->voided) {
+                fprintf(source, "        break;\n");
+            } else if (casep->type) {
+                emit_skip(source, casep->type, mode);
+                fprintf(source, "        break;\n");
+            }
+        }
+    }
+
+    if (xdr_unionp->opaque && !has_default) {
+        fprintf(source, "    default:\n");
+        fprintf(source, "        rc = __skip_fixed_%s(cursor, 1);\n", mode);
+        fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "        len += rc;\n");
+        fprintf(source, "        break;\n");
+    }
+
+    fprintf(source, "    }\n");
+    fprintf(source, "    return len;\n");
+    fprintf(source, "}\n\n");
+} /* emit_skip_union */
+
+/*
+ * Emit code checking one encoded member is well formed and stepping past
+ * it.  Validation always runs on the vector cursor, which takes the same
+ * fast path as contig while a field lies within the current segment.
+ */
+static void
+emit_validate(
+    FILE            *source,
+    struct xdr_type *type)
+{
+    const char *bound = type->vector_bound ? type->vector_bound : "0";
+    int         size, width;
+
+    size  = type_fixed_wire_size(type);
+    width = type_element_wire_size(type);
+
+    if (size >= 0) {
+        fprintf(source, "    rc = xdr_read_cursor_vector_skip(cursor, %d);\n", size);
+    } else if (type->opaque || strcmp(type->name, "xdr_string") == 0) {
+        fprintf(source, "    rc = __validate_opaque_vector(%s, cursor);\n", bound);
+    } else if (type->linkedlist || type->optional) {
+        fprintf(source, "    {\n");
+        fprintf(source, "        uint32_t more;\n");
+        fprintf(source, "        rc = __validate_bool_vector(&more, cursor);\n");
+        fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "        len += rc;\n");
+        fprintf(source, "        %s (more) {\n", type->linkedlist ? "while" : "if");
+        fprintf(source, "            rc = __validate_%s_vector(cursor);\n", type->name);
+        fprintf(source, "            if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "            len += rc;\n");
+        if (type->linkedlist) {
+            fprintf(source, "            rc = __validate_bool_vector(&more, cursor);\n");
+            fprintf(source, "            if (unlikely(rc < 0)) return rc;\n");
+            fprintf(source, "            len += rc;\n");
+        }
+        fprintf(source, "        }\n");
+        fprintf(source, "        rc = 0;\n");
+        fprintf(source, "    }\n");
+    } else if (type->vector && width > 0) {
+        fprintf(source, "    rc = __validate_fixed_vector(%d, %s, cursor);\n", width, bound);
+    } else if (type->vector) {
+        fprintf(source, "    {\n");
+        fprintf(source, "        uint32_t count;\n");
+        fprintf(source, "        rc = __validate_count_vector(&count, %s, cursor);\n", bound);
+        fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "        len += rc;\n");
+        fprintf(source, "        for (uint32_t i = 0; i < count; i++) {\n");
+        fprintf(source, "            rc = __validate_%s_vector(cursor);\n", type->name);
+        fprintf(source, "            if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "            len += rc;\n");
+        fprintf(source, "        }\n");
+        fprintf(source, "        rc = 0;\n");
+        fprintf(source, "    }\n");
+    } else if (type->array) {
+        fprintf(source, "    for (uint32_t i = 0; i < %s; i++) {\n", type->array_size);
+        fprintf(source, "        rc = __validate_%s_vector(cursor);\n", type->name);
+        fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "        len += rc;\n");
+        fprintf(source, "    }\n");
+        fprintf(source, "    rc = 0;\n");
+    } else {
+        fprintf(source, "    rc = __validate_%s_vector(cursor);\n", type->name);
+    }
+
+    fprintf(source, "    if (unlikely(rc < 0)) return rc;\n");
+    fprintf(source, "    len += rc;\n");
+} /* emit_validate */
+
+void
+emit_validate_headers(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "static inline int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__validate_%s_vector(\n", name);
+    fprintf(source, "    struct xdr_read_cursor *cursor);\n\n");
+} /* emit_validate_headers */
+
+void
+emit_validate_wrapper(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "int WARN_UNUSED_RESULT\n");
+    fprintf(source, "validate_%s(\n", name);
+    fprintf(source, "    xdr_iovec *iov,\n");
+    fprintf(source, "    int niov,\n");
+    fprintf(source, "    int *error_offset) {\n");
+    fprintf(source, "    struct xdr_read_cursor cursor;\n");
+    fprintf(source, "    int rc;\n");
+    fprintf(source, "    xdr_read_cursor_vector_init(&cursor, iov, niov, NULL);\n");
+    fprintf(source, "    rc = __validate_%s_vector(&cursor);\n", name);
+    fprintf(source, "    if (unlikely(rc < 0) && error_offset) *error_offset = cursor.offset;\n");
+    fprintf(source, "    return rc;\n");
+    fprintf(source, "}\n\n");
+} /* emit_validate_wrapper */
+
+void
+emit_validate_struct(
+    FILE              *source,
+    const char        *name,
+    struct xdr_struct *xdr_structp)
+{
+    struct xdr_struct_member *member;
+
+    fprintf(source, "static inline int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__validate_%s_vector(\n", name);
+    fprintf(source, "    struct xdr_read_cursor *cursor) {\n");
+    fprintf(source, "    int rc, len = 0;\n");
+
+    DL_FOREACH(xdr_structp->members, member)
+    {
+        if (xdr_structp->linkedlist && strncmp(member->name, "next", 4) == 0) {
+            continue;
+        }
+
+        emit_validate(source, member->type);
+    }
+
+    fprintf(source, "    return len;\n");
+    fprintf(source, "}\n\n");
+} /* emit_validate_struct */
+
+/*
+ * Unlike unmarshall, a discriminant with no matching arm is rejected, and
+ * each opaque union body must be exactly as long as its length prefix.
+ */
+void
+emit_validate_union(
+    FILE             *source,
+    const char       *name,
+    struct xdr_union *xdr_unionp)
+{
+    struct xdr_union_case *casep;
+    int                    is_default, has_default = 0;
+
+    fprintf(source, "static inline int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__validate_%s_vector(\n", name);
+    fprintf(source, "    struct xdr_read_cursor *cursor) {\n");
+    fprintf(source, "    int rc, len = 0;\n");
+    fprintf(source, "    %s pivot;\n", xdr_unionp->pivot_type->name);
+
+    if (xdr_unionp->opaque) {
+        fprintf(source, "    uint32_t body_len;\n");
+        fprintf(source, "    int body_start;\n");
+    }
+
+    fprintf(source, "    rc = __unmarshall_%s_vector(&pivot, cursor, NULL);\n",
+            xdr_unionp->pivot_type->name);
+    fprintf(source, "    if (unlikely(rc < 0)) return rc;\n");
+    fprintf(source, "    len += rc;\n");
+    fprintf(source, "    switch (pivot) {\n");
+
+    for (is_default = 0; is_default < 2; is_default++) {
+        DL_FOREACH(xdr_unionp->cases, casep)
+        {
+            if ((strcmp(casep->label, "default") == 0) != is_default) {
+                continue;
+            }
+
+            if (is_default) {
+                has_default = 1;
+                fprintf(source, "    default:\n");
+            } else {
+                fprintf(source, "    case %s:\n", casep->label);
+            }
+
+            if (!casep->type && !casep->voided) {
+                continue;
+            }
+
+            if (xdr_unionp->opaque && is_varlen_opaque(casep->type)) {
+                /* The arm's own length prefix doubles as the body length */
+                emit_validate(source, casep->type);
+            } else if (xdr_unionp->opaque) {
+                fprintf(source, "        rc = __unmarshall_uint32_t_vector(&body_len, cursor, NULL);\n");
+                fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+                fprintf(source, "        len += rc;\n");
+                fprintf(source, "        body_start = len;\n");
+                if (casep->type) {
+                    emit_validate(source, casep->type);
+                }
+                fprintf(source, "        if (unlikely((uint32_t) (len - body_start) != body_len)) return -1;\n");
+            } else if (casep->type) {
+                emit_validate(source, casep->type);
+            }
+
+            fprintf(source, "        break;\n");
+        }
+    }
+
+    if (!has_default) {
+        fprintf(source, "    default:\n");
+        fprintf(source, "        return -1;\n");
+    }
+
+    fprintf(source, "    }\n");
+    fprintf(source, "    return len;\n");
+    fprintf(source, "}\n\n");
+} /* emit_validate_union */
+
+/*
+ * Emit code stepping past one encoded member as unmarshall would decode
+ * it, adding the dbuf bytes the decode would allocate to *bytes.  parent
+ * names the struct or union holding the member, so array element sizes
+ * can be taken from its declaration.
+ */
+static void
+emit_footprint(
+    FILE            *source,
+    const char      *parent,
+    const char      *name,
+    struct xdr_type *type,
+    const char      *mode)
+{
+    const char *bound = type->vector_bound ? type->vector_bound : "0";
+    char        elem[256];
+    int         size, width;
+
+    size  = type_fixed_wire_size(type);
+    width = type_element_wire_size(type);
+
+    snprintf(elem, sizeof(elem), "sizeof(*((struct %s *) 0)->%s)", parent, name);
+
+    if (size >= 0) {
+        fprintf(source, "    rc = xdr_read_cursor_%s_skip(cursor, %d);\n", mode, size);
+    } else if (type->opaque && type->zerocopy) {
+        fprintf(source, "    rc = __footprint_zerocopy_%s(%s, cursor, bytes);\n", mode, bound);
+    } else if (type->opaque || strcmp(type->name, "xdr_string") == 0) {
+        fprintf(source, "    rc = __footprint_opaque_%s(%s, cursor, bytes);\n", mode, bound);
+    } else if (type->linkedlist || type->optional) {
+        fprintf(source, "    {\n");
+        fprintf(source, "        uint32_t more;\n");
+        fprintf(source, "        rc = __unmarshall_uint32_t_%s(&more, cursor, NULL);\n", mode);
+        fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "        len += rc;\n");
+        fprintf(source, "        %s (more) {\n", type->linkedlist ? "while" : "if");
+        if (type->linkedlist) {
+            fprintf(source, "            *bytes += xdr_dbuf_footprint(sizeof(struct %s));\n", type->name);
+        } else {
+            fprintf(source, "            *bytes += xdr_dbuf_footprint(%s);\n", elem);
+        }
+        fprintf(source, "            rc = __footprint_%s_%s(cursor, bytes);\n", type->name, mode);
+        fprintf(source, "            if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "            len += rc;\n");
+        if (type->linkedlist) {
+            fprintf(source, "            rc = __unmarshall_uint32_t_%s(&more, cursor, NULL);\n", mode);
+            fprintf(source, "            if (unlikely(rc < 0)) return rc;\n");
+            fprintf(source, "            len += rc;\n");
+        }
+        fprintf(source, "        }\n");
+        fprintf(source, "        rc = 0;\n");
+        fprintf(source, "    }\n");
+    } else if (type->vector) {
+        fprintf(source, "    {\n");
+        fprintf(source, "        uint32_t count;\n");
+        fprintf(source, "        rc = __unmarshall_uint32_t_%s(&count, cursor, NULL);\n", mode);
+        fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "        len += rc;\n");
+        if (type->vector_bound) {
+            fprintf(source, "        if (unlikely(count > %s)) return -1;\n", type->vector_bound);
+        }
+        fprintf(source, "        if (unlikely(count > INT32_MAX / %s)) return -1;\n", elem);
+        fprintf(source, "        *bytes += xdr_dbuf_footprint(count * %s);\n", elem);
+        if (width > 0) {
+            fprintf(source, "        if (unlikely((uint64_t) count * %d > INT32_MAX)) return -1;\n", width);
+            fprintf(source, "        rc = xdr_read_cursor_%s_skip(cursor, count * %d);\n", mode, width);
+            fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+            fprintf(source, "        len += rc;\n");
+        } else {
+            fprintf(source, "        for (uint32_t i = 0; i < count; i++) {\n");
+            fprintf(source, "            rc = __footprint_%s_%s(cursor, bytes);\n", type->name, mode);
+            fprintf(source, "            if (unlikely(rc < 0)) return rc;\n");
+            fprintf(source, "            len += rc;\n");
+            fprintf(source, "        }\n");
+        }
+        fprintf(source, "        rc = 0;\n");
+        fprintf(source, "    }\n");
+    } else if (type->array) {
+        fprintf(source, "    for (uint32_t i = 0; i < %s; i++) {\n", type->array_size);
+        fprintf(source, "        rc = __footprint_%s_%s(cursor, bytes);\n", type->name, mode);
+        fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "        len += rc;\n");
+        fprintf(source, "    }\n");
+        fprintf(source, "    rc = 0;\n");
+    } else {
+        fprintf(source, "    rc = __footprint_%s_%s(cursor, bytes);\n", type->name, mode);
+    }
+
+    fprintf(source, "    if (unlikely(rc < 0)) return rc;\n");
+    fprintf(source, "    len += rc;\n");
+} /* emit_footprint */
+
+void
+emit_footprint_headers(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "static inline int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__footprint_%s_vector(\n", name);
+    fprintf(source, "    struct xdr_read_cursor *cursor,\n");
+    fprintf(source, "    uint64_t *bytes);\n\n");
+
+    fprintf(source, "static inline int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__footprint_%s_contig(\n", name);
+    fprintf(source, "    struct xdr_read_cursor *cursor,\n");
+    fprintf(source, "    uint64_t *bytes);\n\n");
+} /* emit_footprint_headers */
+
+void
+emit_footprint_wrapper(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "int WARN_UNUSED_RESULT\n");
+    fprintf(source, "unmarshall_footprint_%s(\n", name);
+    fprintf(source, "    xdr_iovec *iov,\n");
+    fprintf(source, "    int niov,\n");
+    fprintf(source, "    struct evpl_rpc2_rdma_chunk *rdma_chunk) {\n");
+    fprintf(source, "    struct xdr_read_cursor cursor;\n");
+    fprintf(source, "    uint64_t bytes = 0;\n");
+    fprintf(source, "    int rc;\n");
+    fprintf(source, "    if (niov == 1) {\n");
+    fprintf(source, "        xdr_read_cursor_contig_init(&cursor, iov, rdma_chunk);\n");
+    fprintf(source, "        rc = __footprint_%s_contig(&cursor, &bytes);\n", name);
+    fprintf(source, "    } else {\n");
+    fprintf(source, "        xdr_read_cursor_vector_init(&cursor, iov, niov, rdma_chunk);\n");
+    fprintf(source, "        rc = __footprint_%s_vector(&cursor, &bytes);\n", name);
+    fprintf(source, "    }\n");
+    fprintf(source, "    if (unlikely(rc < 0 || bytes > INT32_MAX)) return -1;\n");
+    fprintf(source, "    return bytes;\n");
+    fprintf(source, "}\n\n");
+
+    fprintf(source, "int\n");
+    fprintf(source, "marshall_requirements_%s(\n", name);
+    fprintf(source, "    const struct %s *in,\n", name);
+    fprintf(source, "    int out_offset,\n");
+    fprintf(source, "    const struct xdr_marshall_config *config,\n");
+    fprintf(source, "    int *niov) {\n");
+    fprintf(source, "    struct xdr_write_dry_run dry;\n");
+    fprintf(source, "    int rc;\n");
+    fprintf(source, "    xdr_write_dry_run_init(&dry, out_offset, config);\n");
+    fprintf(source, "    rc = marshall_%s_cursor((struct %s *) in, &dry.cursor);\n", name, name);
+    fprintf(source, "    return xdr_write_dry_run_finish(&dry, rc, niov);\n");
+    fprintf(source, "}\n\n");
+} /* emit_footprint_wrapper */
+
+void
+emit_footprint_struct(
+    FILE              *source,
+    const char        *name,
+    struct xdr_struct *xdr_structp,
+    const char        *mode)
+{
+    struct xdr_struct_member *member;
+
+    fprintf(source, "static inline int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__footprint_%s_%s(\n", name, mode);
+    fprintf(source, "    struct xdr_read_cursor *cursor,\n");
+    fprintf(source, "    uint64_t *bytes) {\n");
+    fprintf(source, "    int rc, len = 0;\n");
+
+    DL_FOREACH(xdr_structp->members, member)
+    {
+        if (xdr_structp->linkedlist && strncmp(member->name, "next", 4) == 0) {
+            continue;
+        }
+
+        emit_footprint(source, name, member->name, member->type, mode);
+    }
+
+    fprintf(source, "    return len;\n");
+    fprintf(source, "}\n\n");
+} /* emit_footprint_struct */
+
+/* Mirrors the unmarshall switch, including unknown discriminants */
+void
+emit_footprint_union(
+    FILE             *source,
+    const char       *name,
+    struct xdr_union *xdr_unionp,
+    const char       *mode)
+{
+    struct xdr_union_case *casep;
+    int                    is_default, has_default = 0;
+
+    fprintf(source, "static inline int WARN_UNUSED_RESULT\n");
+    fprintf(source, "__footprint_%s_%s(\n", name, mode);
+    fprintf(source, "    struct xdr_read_cursor *cursor,\n");
+    fprintf(source, "    uint64_t *bytes) {\n");
+    fprintf(source, "    int rc, len = 0;\n");
+    fprintf(source, "    %s pivot;\n", xdr_unionp->pivot_type->name);
+
+    if (xdr_unionp->opaque) {
+        fprintf(source, "    uint32_t body_len;\n");
+        fprintf(source, "    int body_start;\n");
+    }
+
+    fprintf(source, "    rc = __unmarshall_%s_%s(&pivot, cursor, NULL);\n",
+            xdr_unionp->pivot_type->name, mode);
+    fprintf(source, "    if (unlikely(rc < 0)) return rc;\n");
+    fprintf(source, "    len += rc;\n");
+    fprintf(source, "    switch (pivot) {\n");
+
+    for (is_default = 0; is_default < 2; is_default++) {
+        DL_FOREACH(xdr_unionp->cases, casep)
+        {
+            if ((strcmp(casep->label, "default") == 0) != is_default) {
+                continue;
+            }
+
+            if (is_default) {
+                has_default = 1;
+                fprintf(source, "    default:\n");
+            } else {
+                fprintf(source, "    case %s:\n", casep->label);
+            }
+
+            if (!casep->type && !casep->voided) {
+                continue;
+            }
+
+            if (xdr_unionp->opaque && is_varlen_opaque(casep->type)) {
+                emit_footprint(source, name, casep->name, casep->type, mode);
+            } else if (xdr_unionp->opaque) {
+                fprintf(source, "        rc = __unmarshall_uint32_t_%s(&body_len, cursor, NULL);\n", mode);
+                fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+                fprintf(source, "        len += rc;\n");
+                fprintf(source, "        body_start = len;\n");
+                if (casep->type) {
+                    emit_footprint(source, name, casep->name, casep->type, mode);
+                }
+                fprintf(source, "        if (unlikely((uint32_t) (len - body_start) != body_len)) return -1;\n");
+            } else if (casep->type) {
+                emit_footprint(source, name, casep->name, casep->type, mode);
+            }
+
+            fprintf(source, "        break;\n");
+        }
+    }
+
+    if (!has_default) {
+        fprintf(source, "    default:\n");
+        if (xdr_unionp->opaque) {
+            fprintf(source, "        rc = __unmarshall_uint32_t_%s(&body_len, cursor, NULL);\n", mode);
+            fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+            fprintf(source, "        if (unlikely(body_len != 0)) return -1;\n");
+            fprintf(source, "        len += rc;\n");
+        }
+        fprintf(source, "        break;\n");
+    }
+
+    fprintf(source, "    }\n");
+    fprintf(source, "    return len;\n");
+    fprintf(source, "}\n\n");
+} /* emit_footprint_union */
+
+/*
+ * Number of struct members whose wire offset is only known after
+ * walking a preceding variable-length member.
+ */
+static int
+struct_view_nindex(struct xdr_struct *xdr_structp)
+{
+    struct xdr_struct_member *member;
+    int                       variable = 0, nindex = 0;
+
+    DL_FOREACH(xdr_structp->members, member)
+    {
+        if (xdr_structp->linkedlist && strncmp(member->name, "next", 4) == 0) {
+            continue;
+        }
+
+        if (variable) {
+            nindex++;
+        } else if (type_fixed_wire_size(member->type) < 0) {
+            variable = 1;
+        }
+    }
+
+    return nindex;
+} /* struct_view_nindex */
+
+/* Whether a member can be opened as a nested view */
+static int
+is_viewable(struct xdr_type *type)
+{
+    struct xdr_identifier *chk;
+
+    if (!type || type->builtin || type->enumeration || type->opaque ||
+        type->vector || type->array || type->optional || type->linkedlist) {
+        return 0;
+    }
+
+    HASH_FIND_STR(xdr_identifiers, type->name, chk);
+
+    return chk && (chk->type == XDR_STRUCT || chk->type == XDR_UNION);
+} /* is_viewable */
+
+void
+emit_view_type(
+    FILE              *header,
+    const char        *name,
+    struct xdr_struct *xdr_structp)
+{
+    int nindex = xdr_structp ? struct_view_nindex(xdr_structp) : 0;
+
+    fprintf(header, "struct %s_view {\n", name);
+    fprintf(header, "    struct xdr_view view;\n");
+
+    if (xdr_structp) {
+        fprintf(header, "    int             indexed;\n");
+    }
+
+    if (nindex) {
+        fprintf(header, "    uint32_t        index[%d];\n", nindex);
+    }
+
+    fprintf(header, "};\n\n");
+} /* emit_view_type */
+
+static void
+emit_view_member_headers(
+    FILE            *header,
+    const char      *name,
+    const char      *member,
+    struct xdr_type *type)
+{
+    fprintf(header, "int view_%s_%s(\n", name, member);
+    fprintf(header, "    struct %s_view *view,\n", name);
+    fprintf(header, "    struct %s *out,\n", name);
+    fprintf(header, "    xdr_dbuf *dbuf);\n\n");
+
+    if (is_viewable(type)) {
+        fprintf(header, "int view_%s_%s_view(\n", name, member);
+        fprintf(header, "    struct %s_view *view,\n", name);
+        fprintf(header, "    struct %s_view *sub);\n\n", type->name);
+    }
+} /* emit_view_member_headers */
+
+void
+emit_view_headers(
+    FILE              *header,
+    const char        *name,
+    struct xdr_struct *xdr_structp,
+    struct xdr_union  *xdr_unionp)
+{
+    struct xdr_struct_member *member;
+    struct xdr_union_case    *casep;
+
+    fprintf(header, "int view_%s(\n", name);
+    fprintf(header, "    struct %s_view *view,\n", name);
+    fprintf(header, "    xdr_iovec *iov,\n");
+    fprintf(header, "    int niov);\n\n");
+
+    if (xdr_structp) {
+        DL_FOREACH(xdr_structp->members, member)
+        {
+            if (xdr_structp->linkedlist && strncmp(member->name, "next", 4) == 0) {
+                continue;
+            }
+
+            emit_view_member_headers(header, name, member->name, member->type);
+        }
+    } else {
+        emit_view_member_headers(header, name, xdr_unionp->pivot_name, NULL);
+
+        DL_FOREACH(xdr_unionp->cases, casep)
+        {
+            if (casep->type && !casep->voided) {
+                emit_view_member_headers(header, name, casep->name, casep->type);
+            }
+        }
+    }
+} /* emit_view_headers */
+
+static void
+emit_view_sub(
+    FILE            *source,
+    const char      *name,
+    const char      *member,
+    struct xdr_type *type)
+{
+    fprintf(source, "int\n");
+    fprintf(source, "view_%s_%s_view(\n", name, member);
+    fprintf(source, "    struct %s_view *view,\n", name);
+    fprintf(source, "    struct %s_view *sub) {\n", type->name);
+} /* emit_view_sub */
+
+static void
+emit_view_sub_tail(
+    FILE            *source,
+    struct xdr_type *type,
+    const char      *offset)
+{
+    struct xdr_identifier *chk;
+
+    HASH_FIND_STR(xdr_identifiers, type->name, chk);
+
+    fprintf(source, "    if (unlikely(xdr_view_sub(&view->view, &sub->view, %s) < 0)) return -1;\n", offset);
+
+    if (chk->type == XDR_STRUCT) {
+        fprintf(source, "    sub->indexed = 0;\n");
+    }
+
+    fprintf(source, "    return 0;\n");
+    fprintf(source, "}\n\n");
+} /* emit_view_sub_tail */
+
+static void
+emit_view_init(
+    FILE       *source,
+    const char *name,
+    int         is_struct)
+{
+    fprintf(source, "int\n");
+    fprintf(source, "view_%s(\n", name);
+    fprintf(source, "    struct %s_view *view,\n", name);
+    fprintf(source, "    xdr_iovec *iov,\n");
+    fprintf(source, "    int niov) {\n");
+    fprintf(source, "    if (unlikely(niov < 1)) return -1;\n");
+    fprintf(source, "    view->view.iov    = iov;\n");
+    fprintf(source, "    view->view.niov   = niov;\n");
+    fprintf(source, "    view->view.offset = 0;\n");
+
+    if (is_struct) {
+        fprintf(source, "    view->indexed     = 0;\n");
+    }
+
+    fprintf(source, "    return 0;\n");
+    fprintf(source, "}\n\n");
+} /* emit_view_init */
+
+void
+emit_view_struct(
+    FILE              *source,
+    const char        *name,
+    struct xdr_struct *xdr_structp)
+{
+    struct xdr_struct_member *member;
+    char                      offset[80];
+    int                       fixed = 0, index = -1, size;
+    int                       nindex = struct_view_nindex(xdr_structp);
+
+    emit_view_init(source, name, 1);
+
+    if (nindex) {
+        /* Walk from the first variable-length member, recording offsets */
+        DL_FOREACH(xdr_structp->members, member)
+        {
+            if (xdr_structp->linkedlist && strncmp(member->name, "next", 4) == 0) {
+                continue;
+            }
+
+            size = type_fixed_wire_size(member->type);
+
+            if (size < 0) {
+                break;
+            }
+
+            fixed += size;
+        }
+
+        fprintf(source, "static int\n");
+        fprintf(source, "__view_index_%s(struct %s_view *view) {\n", name, name);
+        fprintf(source, "    struct xdr_read_cursor cursor_s, *cursor = &cursor_s;\n");
+        fprintf(source, "    int rc, len = %d;\n", fixed);
+        fprintf(source, "    if (unlikely(xdr_view_seek(&view->view, cursor, len) < 0)) return -1;\n");
+
+        for (index = 0; member; member = member->next) {
+            if (xdr_structp->linkedlist && strncmp(member->name, "next", 4) == 0) {
+                continue;
+            }
+
+            if (index == nindex) {
+                break;
+            }
+
+            emit_skip(source, member->type, "vector");
+            fprintf(source, "    view->index[%d] = len;\n", index++);
+        }
+
+        fprintf(source, "    view->indexed = 1;\n");
+        fprintf(source, "    return 0;\n");
+        fprintf(source, "}\n\n");
+    }
+
+    fixed = 0;
+    index = -1;
+
+    DL_FOREACH(xdr_structp->members, member)
+    {
+        if (xdr_structp->linkedlist && strncmp(member->name, "next", 4) == 0) {
+            continue;
+        }
+
+        if (index < 0) {
+            snprintf(offset, sizeof(offset), "%d", fixed);
+        } else {
+            snprintf(offset, sizeof(offset), "view->index[%d]", index);
+        }
+
+        fprintf(source, "int\n");
+        fprintf(source, "view_%s_%s(\n", name, member->name);
+        fprintf(source, "    struct %s_view *view,\n", name);
+        fprintf(source, "    struct %s *out,\n", name);
+        fprintf(source, "    xdr_dbuf *dbuf) {\n");
+        fprintf(source, "    struct xdr_read_cursor cursor_s, *cursor = &cursor_s;\n");
+        fprintf(source, "    int rc, len = 0;\n");
+        if (index >= 0) {
+            fprintf(source,
+                    "    if (!view->indexed && unlikely(__view_index_%s(view) < 0)) return -1;\n",
+                    name);
+        }
+        fprintf(source,
+                "    if (unlikely(xdr_view_seek(&view->view, cursor, %s) < 0)) return -1;\n",
+                offset);
+        emit_unmarshall(source, member->name, member->type);
+        fprintf(source, "    return len;\n");
+        fprintf(source, "}\n\n");
+
+        if (is_viewable(member->type)) {
+            emit_view_sub(source, name, member->name, member->type);
+            if (index >= 0) {
+                fprintf(source,
+                        "    if (!view->indexed && unlikely(__view_index_%s(view) < 0)) return -1;\n",
+                        name);
+            }
+            emit_view_sub_tail(source, member->type, offset);
+        }
+
+        size = type_fixed_wire_size(member->type);
+
+        if (index >= 0) {
+            index++;
+        } else if (size >= 0) {
+            fixed += size;
+        } else {
+            index = 0;
+        }
+    }
+} /* emit_view_struct */
+
+/*
+ * Emit a check that the union discriminant in var selects the given arm,
+ * following the case order and fallthrough of the generated switches.
+ */
+static void
+emit_view_arm_check(
+    FILE                  *source,
+    struct xdr_union      *xdr_unionp,
+    struct xdr_union_case *arm,
+    const char            *var)
+{
+    struct xdr_union_case *casep, *owner, *dflt = NULL;
+    int                    is_default = strcmp(arm->label, "default") == 0;
+    int                    nlabels    = 0;
+
+    DL_FOREACH(xdr_unionp->cases, casep)
+    {
+        if (strcmp(casep->label, "default") == 0) {
+            dflt = casep;
+        }
+    }
+
+    DL_FOREACH(xdr_unionp->cases, casep)
+    {
+        if (casep == dflt) {
+            continue;
+        }
+
+        for (owner = casep; owner; owner = owner->next) {
+            if (owner != dflt && (owner->type || owner->voided)) {
+                break;
+            }
+        }
+
+        if (!owner) {
+            owner = dflt;
+        }
+
+        if ((owner == arm) != is_default) {
+            if (nlabels++ == 0) {
+                fprintf(source, "    switch (%s) {\n", var);
+            }
+            fprintf(source, "    case %s:\n", casep->label);
+        }
+    }
+
+    if (nlabels == 0) {
+        return;
+    }
+
+    if (is_default) {
+        fprintf(source, "        return -1;\n");
+        fprintf(source, "    default:\n");
+        fprintf(source, "        break;\n");
+    } else {
+        fprintf(source, "        break;\n");
+        fprintf(source, "    default:\n");
+        fprintf(source, "        return -1;\n");
+    }
+
+    fprintf(source, "    }\n");
+} /* emit_view_arm_check */
+
+void
+emit_view_union(
+    FILE             *source,
+    const char       *name,
+    struct xdr_union *xdr_unionp)
+{
+    struct xdr_union_case *casep;
+    const char            *offset;
+    char                   pivot[80];
+
+    emit_view_init(source, name, 0);
+
+    fprintf(source, "int\n");
+    fprintf(source, "view_%s_%s(\n", name, xdr_unionp->pivot_name);
+    fprintf(source, "    struct %s_view *view,\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    xdr_dbuf *dbuf) {\n");
+    fprintf(source, "    struct xdr_read_cursor cursor_s, *cursor = &cursor_s;\n");
+    fprintf(source, "    int rc, len = 0;\n");
+    fprintf(source, "    if (unlikely(xdr_view_seek(&view->view, cursor, 0) < 0)) return -1;\n");
+    emit_unmarshall(source, xdr_unionp->pivot_name, xdr_unionp->pivot_type);
+    fprintf(source, "    return len;\n");
+    fprintf(source, "}\n\n");
+
+    DL_FOREACH(xdr_unionp->cases, casep)
+    {
+        if (!casep->type || casep->voided) {
+            continue;
+        }
+
+        offset = (xdr_unionp->opaque && !is_varlen_opaque(casep->type)) ? "8" : "4";
+
+        fprintf(source, "int\n");
+        fprintf(source, "view_%s_%s(\n", name, casep->name);
+        fprintf(source, "    struct %s_view *view,\n", name);
+        fprintf(source, "    struct %s *out,\n", name);
+        fprintf(source, "    xdr_dbuf *dbuf) {\n");
+        fprintf(source, "    struct xdr_read_cursor cursor_s, *cursor = &cursor_s;\n");
+        fprintf(source, "    int rc, len = 0;\n");
+        fprintf(source, "    if (unlikely(xdr_view_seek(&view->view, cursor, 0) < 0)) return -1;\n");
+        emit_unmarshall(source, xdr_unionp->pivot_name, xdr_unionp->pivot_type);
+        snprintf(pivot, sizeof(pivot), "out->%s", xdr_unionp->pivot_name);
+        emit_view_arm_check(source, xdr_unionp, casep, pivot);
+        if (offset[0] == '8') {
+            fprintf(source, "    rc = xdr_read_cursor_vector_skip(cursor, 4);\n");
+            fprintf(source, "    if (unlikely(rc < 0)) return rc;\n");
+            fprintf(source, "    len += rc;\n");
+        }
+        emit_unmarshall(source, casep->name, casep->type);
+        fprintf(source, "    return len;\n");
+        fprintf(source, "}\n\n");
+
+        if (is_viewable(casep->type)) {
+            emit_view_sub(source, name, casep->name, casep->type);
+            fprintf(source, "    struct xdr_read_cursor cursor;\n");
+            fprintf(source, "    %s pivot;\n", xdr_unionp->pivot_type->name);
+            fprintf(source, "    if (unlikely(xdr_view_seek(&view->view, &cursor, 0) < 0)) return -1;\n");
+            fprintf(source, "    if (unlikely(__unmarshall_%s_vector(&pivot, &cursor, NULL) < 0)) return -1;\n",
+                    xdr_unionp->pivot_type->name);
+            emit_view_arm_check(source, xdr_unionp, casep, "pivot");
+            emit_view_sub_tail(source, casep->type, offset);
+        }
+    }
+} /* emit_view_union */
+
+/*
+ * Expression probing whether a member can be decoded in one step from
+ * the bytes available, or NULL if the member must be resumed piecewise.
+ */
+static const char *
+resume_probe(
+    struct xdr_type *type,
+    char            *buf,
+    size_t           bufsize)
+{
+    struct xdr_identifier *chk;
+    int                    size, width;
+
+    size  = type_fixed_wire_size(type);
+    width = type_element_wire_size(type);
+
+    if (size >= 0) {
+        snprintf(buf, bufsize, "xdr_read_cursor_vector_skip(&probe, %d)", size);
+    } else if (type->opaque || strcmp(type->name, "xdr_string") == 0) {
+        snprintf(buf, bufsize, "__skip_opaque_vector(&probe)");
+    } else if (type->vector && width > 0) {
+        snprintf(buf, bufsize, "__skip_fixed_vector(&probe, %d)", width);
+    } else {
+        HASH_FIND_STR(xdr_identifiers, type->name, chk);
+
+        /* opaque unions are waited for whole, their length is up front */
+        if (!chk || chk->type != XDR_UNION || !((struct xdr_union *) chk->ptr)->opaque ||
+            type->vector || type->array || type->optional || type->linkedlist) {
+            return NULL;
+        }
+
+        snprintf(buf, bufsize, "__skip_%s_vector(&probe)", type->name);
+    }
+
+    return buf;
+} /* resume_probe */
+
+static void
+emit_resume_leaf(
+    FILE       *source,
+    const char *probe)
+{
+    fprintf(source, "    {\n");
+    fprintf(source, "        struct xdr_read_cursor probe = *cursor;\n");
+    fprintf(source, "        if (%s < 0) return 1;\n", probe);
+    fprintf(source, "    }\n");
+} /* emit_resume_leaf */
+
+static void
+emit_resume_alloc(
+    FILE       *source,
+    const char *ptr,
+    const char *size)
+{
+    fprintf(source, "    %s = XDR_PTR_CAST(%s) xdr_dbuf_alloc_space(%s, dbuf);\n", ptr, ptr, size);
+    fprintf(source, "    if (unlikely(%s == NULL)) return -1;\n", ptr);
+} /* emit_resume_alloc */
+
+/* Emit resumable decoding of one member, suspending with return 1 */
+static void
+emit_resume_member(
+    FILE            *source,
+    const char      *name,
+    struct xdr_type *type)
+{
+    struct xdr_identifier *chk;
+    struct xdr_struct     *liststruct;
+    const char            *probe;
+    char                   buf[160], ptr[160];
+
+    probe = resume_probe(type, buf, sizeof(buf));
+
+    if (type->opaque && type->array) {
+        /* Fixed opaques are copied as they arrive, frame->index counts the bytes */
+        fprintf(source, "    frame->index += xdr_read_cursor_vector_extract_partial(cursor, (char *) out->%s + frame->index, %s - frame->index);\n",
+                name, type->array_size);
+        fprintf(source, "    if (frame->index < %s) return 1;\n", type->array_size);
+    } else if ((type->opaque && !type->zerocopy) || strcmp(type->name, "xdr_string") == 0) {
+        /* Referenced in place once whole, otherwise copied as it arrives */
+        fprintf(source, "    {\n");
+        fprintf(source, "        struct xdr_read_cursor probe = *cursor;\n");
+        fprintf(source, "        if (frame->phase == 0 && %s >= 0) {\n", probe);
+        emit_unmarshall(source, name, type);
+        fprintf(source, "        } else {\n");
+        fprintf(source, "            rc = xdr_resume_opaque(frame, cursor, &out->%s.len, (void **) &out->%s.%s, %s, dbuf);\n",
+                name, name, type->opaque ? "data" : "str", type->vector_bound ? type->vector_bound : "0");
+        fprintf(source, "            if (rc) return rc;\n");
+        fprintf(source, "        }\n");
+        fprintf(source, "    }\n");
+    } else if (probe) {
+        emit_resume_leaf(source, probe);
+        emit_unmarshall(source, name, type);
+    } else if (type->linkedlist) {
+        HASH_FIND_STR(xdr_identifiers, type->name, chk);
+
+        liststruct = (struct xdr_struct *) chk->ptr;
+
+        /* phase 0: at the head, 1: decoding frame->node, 2: node complete */
+        fprintf(source, "    for (;;) {\n");
+        fprintf(source, "        if (frame->phase == 1) {\n");
+        fprintf(source, "            rc = __resume_%s((struct %s *) frame->node, ctx, cursor, dbuf, depth + 1);\n",
+                type->name, type->name);
+        fprintf(source, "            if (rc) return rc;\n");
+        fprintf(source, "            ((struct %s *) frame->node)->%s = NULL;\n",
+                type->name, liststruct->nextmember);
+        fprintf(source, "            frame->phase = 2;\n");
+        fprintf(source, "        }\n");
+        fprintf(source, "        uint32_t more;\n");
+        emit_resume_leaf(source, "xdr_read_cursor_vector_skip(&probe, 4)");
+        fprintf(source, "        rc = __unmarshall_uint32_t_vector(&more, cursor, dbuf);\n");
+        fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "        if (!more) {\n");
+        fprintf(source, "            if (frame->phase == 0) out->%s = NULL;\n", name);
+        fprintf(source, "            break;\n");
+        fprintf(source, "        }\n");
+        fprintf(source, "        struct %s *node;\n", type->name);
+        emit_resume_alloc(source, "node", "sizeof(*node)");
+        fprintf(source, "        if (frame->phase == 0) {\n");
+        fprintf(source, "            out->%s = node;\n", name);
+        fprintf(source, "        } else {\n");
+        fprintf(source, "            ((struct %s *) frame->node)->%s = node;\n",
+                type->name, liststruct->nextmember);
+        fprintf(source, "        }\n");
+        fprintf(source, "        frame->node  = node;\n");
+        fprintf(source, "        frame->phase = 1;\n");
+        fprintf(source, "    }\n");
+    } else if (type->optional) {
+        fprintf(source, "    if (frame->phase == 0) {\n");
+        fprintf(source, "        uint32_t more;\n");
+        emit_resume_leaf(source, "xdr_read_cursor_vector_skip(&probe, 4)");
+        fprintf(source, "        rc = __unmarshall_uint32_t_vector(&more, cursor, dbuf);\n");
+        fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+        fprintf(source, "        out->%s = NULL;\n", name);
+        fprintf(source, "        if (more) {\n");
+        snprintf(ptr, sizeof(ptr), "out->%s", name);
+        snprintf(buf, sizeof(buf), "sizeof(*out->%s)", name);
+        emit_resume_alloc(source, ptr, buf);
+        fprintf(source, "        }\n");
+        fprintf(source, "        frame->phase = 1;\n");
+        fprintf(source, "    }\n");
+        fprintf(source, "    if (out->%s) {\n", name);
+        fprintf(source, "        rc = __resume_%s(out->%s, ctx, cursor, dbuf, depth + 1);\n",
+                type->name, name);
+        fprintf(source, "        if (rc) return rc;\n");
+        fprintf(source, "    }\n");
+    } else if (type->vector || type->array) {
+        if (type->vector) {
+            fprintf(source, "    if (frame->phase == 0) {\n");
+            emit_resume_leaf(source, "xdr_read_cursor_vector_skip(&probe, 4)");
+            fprintf(source, "        rc = __unmarshall_uint32_t_vector(&out->num_%s, cursor, dbuf);\n", name);
+            fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
+            emit_count_check(source, name, type);
+            snprintf(ptr, sizeof(ptr), "out->%s", name);
+            snprintf(buf, sizeof(buf), "out->num_%s * sizeof(*out->%s)", name, name);
+            emit_resume_alloc(source, ptr, buf);
+            fprintf(source, "        frame->phase = 1;\n");
+            fprintf(source, "        frame->index = 0;\n");
+            fprintf(source, "    }\n");
+            snprintf(buf, sizeof(buf), "out->num_%s", name);
+        } else {
+            snprintf(buf, sizeof(buf), "%s", type->array_size);
+        }
+        fprintf(source, "    for (; frame->index < %s; frame->index++) {\n", buf);
+        fprintf(source, "        rc = __resume_%s(&out->%s[frame->index], ctx, cursor, dbuf, depth + 1);\n",
+                type->name, name);
+        fprintf(source, "        if (rc) return rc;\n");
+        fprintf(source, "    }\n");
+    } else {
+        fprintf(source, "    rc = __resume_%s(&out->%s, ctx, cursor, dbuf, depth + 1);\n",
+                type->name, name);
+        fprintf(source, "    if (rc) return rc;\n");
+    }
+} /* emit_resume_member */
+
+void
+emit_resume_headers(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "static int\n");
+    fprintf(source, "__resume_%s(\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    struct xdr_resume *ctx,\n");
+    fprintf(source, "    struct xdr_read_cursor *cursor,\n");
+    fprintf(source, "    xdr_dbuf *dbuf,\n");
+    fprintf(source, "    int depth);\n\n");
+} /* emit_resume_headers */
+
+void
+emit_resume_wrapper_headers(
+    FILE       *header,
+    const char *name)
+{
+    fprintf(header, "int unmarshall_%s_resume(\n", name);
+    fprintf(header, "    struct %s *out,\n", name);
+    fprintf(header, "    struct xdr_resume *ctx,\n");
+    fprintf(header, "    xdr_dbuf *dbuf);\n\n");
+} /* emit_resume_wrapper_headers */
+
+/* Locate this level's frame, starting it afresh on first entry */
+static void
+emit_resume_frame(FILE *source)
+{
+    fprintf(source, "    struct xdr_resume_frame *frame;\n");
+    fprintf(source, "    if (unlikely(depth >= XDR_RESUME_MAX_DEPTH)) return -1;\n");
+    fprintf(source, "    frame = &ctx->stack[depth];\n");
+    fprintf(source, "    if (ctx->depth == depth) {\n");
+    fprintf(source, "        frame->field = 0;\n");
+    fprintf(source, "        frame->phase = 0;\n");
+    fprintf(source, "        frame->index = 0;\n");
+    fprintf(source, "        ctx->depth   = depth + 1;\n");
+    fprintf(source, "    }\n");
+} /* emit_resume_frame */
+
+static void
+emit_resume_prologue(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "static int\n");
+    fprintf(source, "__resume_%s(\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    struct xdr_resume *ctx,\n");
+    fprintf(source, "    struct xdr_read_cursor *cursor,\n");
+    fprintf(source, "    xdr_dbuf *dbuf,\n");
+    fprintf(source, "    int depth) {\n");
+    fprintf(source, "    int rc, len = 0;\n");
+    emit_resume_frame(source);
+} /* emit_resume_prologue */
+
+static void
+emit_resume_next(
+    FILE *source,
+    int   field)
+{
+    fprintf(source, "    frame->field = %d;\n", field);
+    fprintf(source, "    frame->phase = 0;\n");
+    fprintf(source, "    frame->index = 0;\n");
+    fprintf(source, "    /* fallthrough */\n");
+    fprintf(source, "    case %d:\n", field);
+} /* emit_resume_next */
+
+static void
+emit_resume_epilogue(FILE *source)
+{
+    fprintf(source, "    ctx->depth = depth;\n");
+    fprintf(source, "    (void) len;\n");
+    fprintf(source, "    return 0;\n");
+    fprintf(source, "}\n\n");
+} /* emit_resume_epilogue */
+
+void
+emit_resume_struct(
+    FILE              *source,
+    const char        *name,
+    struct xdr_struct *xdr_structp)
+{
+    struct xdr_struct_member *member;
+    int                       field = 0;
+
+    emit_resume_prologue(source, name);
+    fprintf(source, "    switch (frame->field) {\n");
+    fprintf(source, "    case 0:\n");
+
+    DL_FOREACH(xdr_structp->members, member)
+    {
+        if (xdr_structp->linkedlist && strncmp(member->name, "next", 4) == 0) {
+            continue;
+        }
+
+        if (field) {
+            emit_resume_next(source, field);
+        }
+
+        emit_resume_member(source, member->name, member->type);
+        emit_member_hash(source, member);
+        field++;
+    }
+
+    fprintf(source, "    }\n");
+    emit_resume_epilogue(source);
+} /* emit_resume_struct */
+
+void
+emit_resume_union(
+    FILE             *source,
+    const char       *name,
+    struct xdr_union *xdr_unionp)
+{
+    struct xdr_union_case *casep;
+    struct xdr_type        whole;
+    char                   buf[160];
+    int                    is_default;
+
+    emit_resume_prologue(source, name);
+
+    if (xdr_unionp->opaque) {
+        memset(&whole, 0, sizeof(whole));
+        whole.name = (char *) name;
+        emit_resume_leaf(source, resume_probe(&whole, buf, sizeof(buf)));
+        fprintf(source, "    rc = __unmarshall_%s_vector(out, cursor, dbuf);\n", name);
+        fprintf(source, "    if (unlikely(rc < 0)) return rc;\n");
+        emit_resume_epilogue(source);
+        return;
+    }
+
+    fprintf(source, "    switch (frame->field) {\n");
+    fprintf(source, "    case 0:\n");
+    emit_resume_member(source, xdr_unionp->pivot_name, xdr_unionp->pivot_type);
+    emit_resume_next(source, 1);
+    fprintf(source, "    switch (out->%s) {\n", xdr_unionp->pivot_name);
+
+    for (is_default = 0; is_default < 2; is_default++) {
+        DL_FOREACH(xdr_unionp->cases, casep)
+        {
+            if ((strcmp(casep->label, "default") == 0) != is_default) {
+                continue;
+            }
+
+            if (is_default) {
+                fprintf(source, "    default:\n");
+            } else {
+                fprintf(source, "    case %s:\n", casep->label);
+            }
+
+            if (casep->voided) {
+                fprintf(source, "        break;\n");
+            } else if (casep->type) {
+                emit_resume_member(source, casep->name, casep->type);
+                fprintf(source, "        break;\n");
+            }
+        }
+    }
+
+    fprintf(source, "    }\n");
+    fprintf(source, "    }\n");
+    emit_resume_epilogue(source);
+} /* emit_resume_union */
+
+void
+emit_resume_wrapper(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "int WARN_UNUSED_RESULT\n");
+    fprintf(source, "unmarshall_%s_resume(\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    struct xdr_resume *ctx,\n");
+    fprintf(source, "    xdr_dbuf *dbuf) {\n");
+    fprintf(source, "    struct xdr_read_cursor cursor;\n");
+    fprintf(source, "    int rc;\n");
+    fprintf(source, "    if (ctx->niov == 0) return XDR_RESUME_MORE;\n");
+    fprintf(source, "    xdr_read_cursor_vector_init(&cursor, ctx->iov + ctx->cur, ctx->niov - ctx->cur, NULL);\n");
+    fprintf(source, "    cursor.iov_offset = ctx->iov_offset;\n");
+    fprintf(source, "    cursor.offset     = ctx->offset;\n");
+    fprintf(source, "    rc = __resume_%s(out, ctx, &cursor, dbuf, 0);\n", name);
+    fprintf(source, "    if (unlikely(rc < 0)) return -1;\n");
+    fprintf(source, "    ctx->cur        = cursor.cur - ctx->iov;\n");
+    fprintf(source, "    ctx->iov_offset = cursor.iov_offset;\n");
+    fprintf(source, "    ctx->offset     = cursor.offset;\n");
+    fprintf(source, "    return rc ? XDR_RESUME_MORE : (int) ctx->offset;\n");
+    fprintf(source, "}\n\n");
+} /* emit_resume_wrapper */
+
+/* Struct and non-opaque union values are encoded a member at a time */
+static int
+is_resume_composite(struct xdr_type *type)
+{
+    struct xdr_identifier *chk;
+
+    HASH_FIND_STR(xdr_identifiers, type->name, chk);
+
+    if (!chk) {
+        return 0;
+    }
+
+    return chk->type == XDR_STRUCT ||
+           (chk->type == XDR_UNION && !((struct xdr_union *) chk->ptr)->opaque);
+} /* is_resume_composite */
+
+static void
+emit_marshall_resume_mark(FILE *source)
+{
+    fprintf(source, "    xdr_write_cursor_mark(cursor, mark);\n");
+} /* emit_marshall_resume_mark */
+
+/*
+ * Emit resumable encoding of one member.  Leaves are encoded whole from
+ * a mark; any failure returns -1 and the caller rewinds to that mark.
+ * Copied strings and opaques are the exception and are split across
+ * calls, moving the mark past each piece written.
+ */
+static void
+emit_marshall_resume_member(
+    FILE            *source,
+    const char      *name,
+    struct xdr_type *type)
+{
+    struct xdr_identifier *chk;
+    struct xdr_struct     *liststruct;
+
+    if (type->opaque && type->array) {
+        emit_marshall_resume_mark(source);
+        fprintf(source, "    if (unlikely(xdr_marshall_resume_opaque(frame, cursor, mark, in->%s, %s, 0) < 0)) return -1;\n",
+                name, type->array_size);
+    } else if ((type->opaque && !type->zerocopy) || strcmp(type->name, "xdr_string") == 0) {
+        emit_marshall_resume_mark(source);
+        fprintf(source, "    if (unlikely(xdr_marshall_resume_opaque(frame, cursor, mark, in->%s.%s, in->%s.len, 1) < 0)) return -1;\n",
+                name, type->opaque ? "data" : "str", name);
+    } else if (!is_resume_composite(type)) {
+        emit_marshall_resume_mark(source);
+        emit_marshall(source, name, type);
+    } else if (type->linkedlist) {
+        HASH_FIND_STR(xdr_identifiers, type->name, chk);
+
+        liststruct = (struct xdr_struct *) chk->ptr;
+
+        /* phase 1: marker for frame->node is next, 2: frame->node itself */
+        fprintf(source, "    if (frame->phase == 0) {\n");
+        fprintf(source, "        frame->node  = in->%s;\n", name);
+        fprintf(source, "        frame->phase = 1;\n");
+        fprintf(source, "    }\n");
+        fprintf(source, "    for (;;) {\n");
+        fprintf(source, "        struct %s *node = (struct %s *) frame->node;\n", type->name, type->name);
+        fprintf(source, "        if (frame->phase == 1) {\n");
+        fprintf(source, "            uint32_t more = !!node;\n");
+        emit_marshall_resume_mark(source);
+        fprintf(source, "            if (unlikely(__marshall_uint32_t(&more, cursor) < 0)) return -1;\n");
+        fprintf(source, "            if (!more) break;\n");
+        fprintf(source, "            frame->phase = 2;\n");
+        fprintf(source, "        }\n");
+        fprintf(source, "        rc = __marshall_resume_%s(node, ctx, cursor, mark, depth + 1);\n",
+                type->name);
+        fprintf(source, "        if (rc) return rc;\n");
+        fprintf(source, "        frame->node  = node->%s;\n", liststruct->nextmember);
+        fprintf(source, "        frame->phase = 1;\n");
+        fprintf(source, "    }\n");
+    } else if (type->optional) {
+        fprintf(source, "    if (frame->phase == 0) {\n");
+        fprintf(source, "        uint32_t more = !!in->%s;\n", name);
+        emit_marshall_resume_mark(source);
+        fprintf(source, "        if (unlikely(__marshall_uint32_t(&more, cursor) < 0)) return -1;\n");
+        fprintf(source, "        frame->phase = 1;\n");
+        fprintf(source, "    }\n");
+        fprintf(source, "    if (in->%s) {\n", name);
+        fprintf(source, "        rc = __marshall_resume_%s(in->%s, ctx, cursor, mark, depth + 1);\n",
+                type->name, name);
+        fprintf(source, "        if (rc) return rc;\n");
+        fprintf(source, "    }\n");
+    } else if (type->vector || type->array) {
+        if (type->vector) {
+            fprintf(source, "    if (frame->phase == 0) {\n");
+            emit_marshall_resume_mark(source);
+            fprintf(source, "        if (unlikely(__marshall_uint32_t(&in->num_%s, cursor) < 0)) return -1;\n",
+                    name);
+            fprintf(source, "        frame->phase = 1;\n");
+            fprintf(source, "    }\n");
+            fprintf(source, "    for (; frame->index < in->num_%s; frame->index++) {\n", name);
+        } else {
+            fprintf(source, "    for (; frame->index < %s; frame->index++) {\n", type->array_size);
+        }
+        fprintf(source, "        rc = __marshall_resume_%s(&in->%s[frame->index], ctx, cursor, mark, depth + 1);\n",
+                type->name, name);
+        fprintf(source, "        if (rc) return rc;\n");
+        fprintf(source, "    }\n");
+    } else {
+        fprintf(source, "    rc = __marshall_resume_%s(&in->%s, ctx, cursor, mark, depth + 1);\n",
+                type->name, name);
+        fprintf(source, "    if (rc) return rc;\n");
+    }
+} /* emit_marshall_resume_member */
+
+void
+emit_marshall_resume_headers(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "static int\n");
+    fprintf(source, "__marshall_resume_%s(\n", name);
+    fprintf(source, "    struct %s *in,\n", name);
+    fprintf(source, "    struct xdr_resume *ctx,\n");
+    fprintf(source, "    struct xdr_write_cursor *cursor,\n");
+    fprintf(source, "    struct xdr_write_mark *mark,\n");
+    fprintf(source, "    int depth);\n\n");
+} /* emit_marshall_resume_headers */
+
+void
+emit_marshall_resume_wrapper_headers(
+    FILE       *header,
+    const char *name)
+{
+    fprintf(header, "int marshall_%s_resume(\n", name);
+    fprintf(header, "    struct %s *in,\n", name);
+    fprintf(header, "    struct xdr_resume *ctx,\n");
+    fprintf(header, "    xdr_iovec *iov_in,\n");
+    fprintf(header, "    xdr_iovec *iov_out,\n");
+    fprintf(header, "    int *niov_out,\n");
+    fprintf(header, "    int out_offset);\n\n");
+} /* emit_marshall_resume_wrapper_headers */
+
+static void
+emit_marshall_resume_prologue(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "static int\n");
+    fprintf(source, "__marshall_resume_%s(\n", name);
+    fprintf(source, "    struct %s *in,\n", name);
+    fprintf(source, "    struct xdr_resume *ctx,\n");
+    fprintf(source, "    struct xdr_write_cursor *cursor,\n");
+    fprintf(source, "    struct xdr_write_mark *mark,\n");
+    fprintf(source, "    int depth) {\n");
+    fprintf(source, "    int rc;\n");
+    /* Mark here so the caller's rewind keeps everything encoded so far */
+    fprintf(source, "    if (unlikely(depth >= XDR_RESUME_MAX_DEPTH)) {\n");
+    fprintf(source, "        xdr_write_cursor_mark(cursor, mark);\n");
+    fprintf(source, "        return -1;\n");
+    fprintf(source, "    }\n");
+    emit_resume_frame(source);
+} /* emit_marshall_resume_prologue */
+
+static void
+emit_marshall_resume_epilogue(FILE *source)
+{
+    fprintf(source, "    ctx->depth = depth;\n");
+    fprintf(source, "    (void) rc;\n");
+    fprintf(source, "    return 0;\n");
+    fprintf(source, "}\n\n");
+} /* emit_marshall_resume_epilogue */
+
+void
+emit_marshall_resume_struct(
+    FILE              *source,
+    const char        *name,
+    struct xdr_struct *xdr_structp)
+{
+    struct xdr_struct_member *member;
+    int                       field = 0;
+
+    emit_marshall_resume_prologue(source, name);
+    fprintf(source, "    switch (frame->field) {\n");
+    fprintf(source, "    case 0:\n");
+
+    DL_FOREACH(xdr_structp->members, member)
+    {
+        if (xdr_structp->linkedlist && strncmp(member->name, "next", 4) == 0) {
+            continue;
+        }
+
+        if (field) {
+            emit_resume_next(source, field);
+        }
+
+        emit_marshall_resume_member(source, member->name, member->type);
+        field++;
+    }
+
+    fprintf(source, "    }\n");
+    emit_marshall_resume_epilogue(source);
+} /* emit_marshall_resume_struct */
 
 void
-emit_length_union(
+emit_marshall_resume_union(
     FILE             *source,
     const char       *name,
     struct xdr_union *xdr_unionp)
 {
     struct xdr_union_case *casep;
-    int                    is_recursive = is_type_recursive(name);
+    int                    is_default;
 
-    if (is_recursive) {
-        fprintf(source,
-                "static int __marshall_length_%s(const struct %s *in)\n",
-                name, name);
-    } else {
-        fprintf(source,
-                "static FORCE_INLINE int __marshall_length_%s(const struct %s *in)\n",
-                name, name);
+    emit_marshall_resume_prologue(source, name);
+
+    if (xdr_unionp->opaque) {
+        emit_marshall_resume_mark(source);
+        fprintf(source, "    if (unlikely(__marshall_%s(in, cursor) < 0)) return -1;\n", name);
+        emit_marshall_resume_epilogue(source);
+        return;
     }
-    fprintf(source, "{\n");
-    fprintf(source, "    uint32_t length = 0;\n");
-    emit_length_member(source, xdr_unionp->pivot_name, xdr_unionp->pivot_type);
+
+    fprintf(source, "    switch (frame->field) {\n");
+    fprintf(source, "    case 0:\n");
+    emit_marshall_resume_member(source, xdr_unionp->pivot_name, xdr_unionp->pivot_type);
+    emit_resume_next(source, 1);
     fprintf(source, "    switch (in->%s) {\n", xdr_unionp->pivot_name);
 
-    DL_FOREACH(xdr_unionp->cases, casep)
-    {
-        if (strcmp(casep->label, "default") != 0) {
-            fprintf(source, "    case %s:\n", casep->label);
-            /*
-             * For opaque_union, add body_len prefix (4 bytes) except for
-             * varlen opaque types which have their own length prefix.
-             */
-            if (xdr_unionp->opaque && !is_varlen_opaque(casep->type)) {
-                fprintf(source, "        length += 4; /* opaque union body length prefix */\n");
-            }
-            if (casep->type) {
-                emit_length_member(source, casep->name, casep->type);
+    for (is_default = 0; is_default < 2; is_default++) {
+        DL_FOREACH(xdr_unionp->cases, casep)
+        {
+            if ((strcmp(casep->label, "default") == 0) != is_default) {
+                continue;
             }
-            fprintf(source, "        break;\n");
-        }
-    }
 
-    DL_FOREACH(xdr_unionp->cases, casep)
-    {
-        if (strcmp(casep->label, "default") == 0) {
-            fprintf(source, "    default:\n");
-            /*
-             * For opaque_union, add body_len prefix (4 bytes) except for
-             * varlen opaque types which have their own length prefix.
-             */
-            if (xdr_unionp->opaque && !is_varlen_opaque(casep->type)) {
-                fprintf(source, "        length += 4; /* opaque union body length prefix */\n");
+            if (is_default) {
+                fprintf(source, "    default:\n");
+            } else {
+                fprintf(source, "    case %s:\n", casep->label);
             }
-            if (casep->type) {
-                emit_length_member(source, casep->name, casep->type);
+
+            if (casep->voided) {
+                fprintf(source, "        break;\n");
+            } else if (casep->type) {
+                emit_marshall_resume_member(source, casep->name, casep->type);
+                fprintf(source, "        break;\n");
             }
-            fprintf(source, "        break;\n");
         }
     }
 
     fprintf(source, "    }\n");
-    fprintf(source, "    return length;\n");
-    fprintf(source, "}\n\n");
+    fprintf(source, "    }\n");
+    emit_marshall_resume_epilogue(source);
+} /* emit_marshall_resume_union */
 
-    fprintf(source, "int marshall_length_%s(const struct %s *in)\n",
-            name, name);
-    fprintf(source, "{\n");
-    fprintf(source, "    return __marshall_length_%s(in);\n", name);
+/*
+ * One output iovec is held back while encoding so that the final
+ * scratch run can always be flushed.  A call that cannot fit even the
+ * next leaf into fresh buffers fails rather than returning no progress.
+ */
+void
+emit_marshall_resume_wrapper(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "int WARN_UNUSED_RESULT\n");
+    fprintf(source, "marshall_%s_resume(\n", name);
+    fprintf(source, "    struct %s *in,\n", name);
+    fprintf(source, "    struct xdr_resume *ctx,\n");
+    fprintf(source, "    xdr_iovec *iov_in,\n");
+    fprintf(source, "    xdr_iovec *iov_out,\n");
+    fprintf(source, "    int *niov_out,\n");
+    fprintf(source, "    int out_offset) {\n");
+    fprintf(source, "    struct xdr_write_cursor cursor;\n");
+    fprintf(source, "    struct xdr_write_mark mark;\n");
+    fprintf(source, "    int rc;\n");
+    fprintf(source, "    if (unlikely(*niov_out < 2)) return -1;\n");
+    fprintf(source, "    xdr_write_cursor_init(&cursor, iov_in, iov_out, *niov_out - 1, NULL, out_offset);\n");
+    fprintf(source, "    xdr_write_cursor_mark(&cursor, &mark);\n");
+    fprintf(source, "    rc = __marshall_resume_%s(in, ctx, &cursor, &mark, 0);\n", name);
+    fprintf(source, "    if (rc) {\n");
+    fprintf(source, "        xdr_write_cursor_rewind(&cursor, &mark);\n");
+    fprintf(source, "        if (cursor.niov == 0 && cursor.scratch_used == out_offset) return -1;\n");
+    fprintf(source, "    }\n");
+    fprintf(source, "    cursor.maxiov++;\n");
+    fprintf(source, "    if (unlikely(xdr_write_cursor_flush(&cursor) < 0)) return -1;\n");
+    fprintf(source, "    *niov_out    = cursor.niov;\n");
+    fprintf(source, "    ctx->offset += cursor.total - out_offset;\n");
+    fprintf(source, "    return rc ? XDR_RESUME_MORE : (int) ctx->offset;\n");
     fprintf(source, "}\n\n");
-} /* emit_length_union */
+} /* emit_marshall_resume_wrapper */
 
 /* Helper function to format type for function parameter (adds "struct" for non-builtin types) */
 static void
@@ -1231,8 +4196,8 @@ emit_program(
             fprintf(source, "        %s *%s_arg;\n",
                     call_type_buf,
                     functionp->name);
-            fprintf(source, "        %s_arg = xdr_dbuf_alloc_space(sizeof(*%s_arg), encoding->dbuf);\n",
-                    functionp->name, functionp->name);
+            fprintf(source, "        %s_arg = XDR_PTR_CAST(%s_arg) xdr_dbuf_alloc_space(sizeof(*%s_arg), encoding->dbuf);\n",
+                    functionp->name, functionp->name, functionp->name);
             fprintf(source, "        if (unlikely(%s_arg == NULL)) return 1;\n",
                     functionp->name);
             fprintf(source,
@@ -1304,11 +4269,11 @@ emit_program(
                     reply_type_buf,
                     functionp->name);
             if (functionp->reply_type->array) {
-                fprintf(source, "        %s_arg = xdr_dbuf_alloc_space(sizeof(*%s_arg) * %s, dbuf);\n",
-                        functionp->name, functionp->name, functionp->reply_type->array_size);
+                fprintf(source, "        %s_arg = XDR_PTR_CAST(%s_arg) xdr_dbuf_alloc_space(sizeof(*%s_arg) * %s, dbuf);\n",
+                        functionp->name, functionp->name, functionp->name, functionp->reply_type->array_size);
             } else {
-                fprintf(source, "        %s_arg = xdr_dbuf_alloc_space(sizeof(*%s_arg), dbuf);\n",
-                        functionp->name, functionp->name);
+                fprintf(source, "        %s_arg = XDR_PTR_CAST(%s_arg) xdr_dbuf_alloc_space(sizeof(*%s_arg), dbuf);\n",
+                        functionp->name, functionp->name, functionp->name);
             }
             fprintf(source, "        if (unlikely(%s_arg == NULL)) return 1;\n",
                     functionp->name);
@@ -1401,7 +4366,7 @@ emit_program(
             fprintf(source, "    struct evpl_rpc2_rdma_chunk *write_chunk = encoding->write_chunk;\n");
             fprintf(source, "    struct evpl_iovec iov, *msg_iov;\n");
             fprintf(source, "    int niov, msg_niov = 260,len;\n");
-            fprintf(source, "    msg_iov = xdr_dbuf_alloc_space(sizeof(*msg_iov) * 260, encoding->dbuf);\n");
+            fprintf(source, "    msg_iov = XDR_PTR_CAST(msg_iov) xdr_dbuf_alloc_space(sizeof(*msg_iov) * 260, encoding->dbuf);\n");
             fprintf(source, "    if (unlikely(msg_iov == NULL)) return 1;\n");
             fprintf(source,
                     "    niov = evpl_iovec_reserve(evpl, 128*1024, 8, 1, &iov);\n");
@@ -1507,7 +4472,7 @@ emit_program(
             fprintf(source, "    rdma_chunk.max_length = conn->rdma && ddp ? UINT32_MAX : 0;\n");
             fprintf(source, "    rdma_chunk.niov = 0;\n");
             fprintf(source, "    xdr_dbuf_reset(dbuf);\n");
-            fprintf(source, "    msg_iov = xdr_dbuf_alloc_space(sizeof(*msg_iov) * 260, dbuf);\n");
+            fprintf(source, "    msg_iov = XDR_PTR_CAST(msg_iov) xdr_dbuf_alloc_space(sizeof(*msg_iov) * 260, dbuf);\n");
             fprintf(source, "    if (unlikely(msg_iov == NULL)) {\n");
             fprintf(source, "        xdr_dbuf_free(dbuf);\n");
             fprintf(source, "        return;\n");
@@ -1652,23 +4617,156 @@ emit_member(
     }
 } /* emit_member */
 
-void
-emit_wrappers(
+/*
+ * Prefetch what a later message of the batch points to, which is the
+ * only input the hardware prefetcher cannot follow.  Limited to the first
+ * few pointer members, so wide structs do not issue a prefetch flood.
+ */
+#define BATCH_PREFETCH_MAX 4
+
+static void
+emit_batch_prefetch(
+    FILE              *source,
+    struct xdr_struct *xdr_structp)
+{
+    struct xdr_struct_member *member;
+    struct xdr_type          *type;
+    const char               *field;
+    int                       count = 0;
+
+    if (!xdr_structp || xdr_structp->linkedlist) {
+        return;
+    }
+
+    DL_FOREACH(xdr_structp->members, member)
+    {
+        type = member->type;
+
+        if (type->opaque && type->zerocopy) {
+            field = ".iov";
+        } else if (type->opaque && !type->array) {
+            field = ".data";
+        } else if (!type->array && strcmp(type->name, "xdr_string") == 0) {
+            field = ".str";
+        } else if (type->vector || type->optional || type->linkedlist) {
+            field = "";
+        } else {
+            continue;
+        }
+
+        if (count == 0) {
+            fprintf(source, "        if (i + XDR_BATCH_PREFETCH_DISTANCE < n) {\n");
+        }
+
+        fprintf(source, "            __builtin_prefetch(in[i + XDR_BATCH_PREFETCH_DISTANCE].%s%s, 0);\n",
+                member->name, field);
+
+        if (++count == BATCH_PREFETCH_MAX) {
+            break;
+        }
+    }
+
+    if (count) {
+        fprintf(source, "        }\n");
+    }
+} /* emit_batch_prefetch */
+
+/*
+ * Batch entry points encode or decode n back-to-back values with one
+ * cursor, prefetching the payload of a later value while the current
+ * one is handled.
+ */
+static void
+emit_batch_wrappers(
     FILE              *source,
     const char        *name,
     struct xdr_struct *xdr_structp)
 {
+    int mode;
+
     fprintf(source, "int WARN_UNUSED_RESULT\n");
-    fprintf(source, "marshall_%s(\n", name);
-    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "marshall_%s_batch(\n", name);
+    fprintf(source, "    struct %s *in,\n", name);
+    fprintf(source, "    int n,\n");
     fprintf(source, "    xdr_iovec *iov_in,\n");
     fprintf(source, "    xdr_iovec *iov_out,\n");
     fprintf(source, "    int *niov_out,\n");
     fprintf(source, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
-    fprintf(source, "    int out_offset) {\n");
+    fprintf(source, "    int out_offset,\n");
+    fprintf(source, "    uint32_t *lengths) {\n");
     fprintf(source, "    struct xdr_write_cursor cursor;\n");
+    fprintf(source, "    int i, start;\n");
     fprintf(source,
             "    xdr_write_cursor_init(&cursor, iov_in, iov_out, *niov_out, rdma_chunk, out_offset);\n");
+    fprintf(source, "    for (i = 0; i < n; i++) {\n");
+    emit_batch_prefetch(source, xdr_structp);
+    fprintf(source, "        start = cursor.total + cursor.scratch_used;\n");
+
+    if (xdr_structp && xdr_structp->linkedlist) {
+        fprintf(source, "        if (unlikely(marshall_%s_cursor(&in[i], &cursor) < 0)) return -1;\n", name);
+    } else {
+        fprintf(source, "        if (unlikely(__marshall_%s(&in[i], &cursor) < 0)) return -1;\n", name);
+    }
+
+    fprintf(source, "        if (lengths) lengths[i] = cursor.total + cursor.scratch_used - start;\n");
+    fprintf(source, "    }\n");
+    fprintf(source, "    if (unlikely(xdr_write_cursor_flush(&cursor) < 0)) return -1;\n");
+    fprintf(source, "    *niov_out = cursor.niov;\n");
+    fprintf(source, "    return cursor.total;\n");
+    fprintf(source, "}\n\n");
+
+    fprintf(source, "int WARN_UNUSED_RESULT\n");
+    fprintf(source, "unmarshall_%s_batch(\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    int n,\n");
+    fprintf(source, "    xdr_iovec *iov,\n");
+    fprintf(source, "    int niov,\n");
+    fprintf(source, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
+    fprintf(source, "    xdr_dbuf *dbuf,\n");
+    fprintf(source, "    uint32_t *lengths) {\n");
+    fprintf(source, "    struct xdr_read_cursor cursor;\n");
+    fprintf(source, "    int i, rc, len = 0;\n");
+
+    for (mode = 0; mode < 2; mode++) {
+        if (mode == 0) {
+            fprintf(source, "    if (niov == 1) {\n");
+            fprintf(source, "        xdr_read_cursor_contig_init(&cursor, iov, rdma_chunk);\n");
+        } else {
+            fprintf(source, "    } else {\n");
+            fprintf(source, "        xdr_read_cursor_vector_init(&cursor, iov, niov, rdma_chunk);\n");
+        }
+
+        fprintf(source, "        for (i = 0; i < n; i++) {\n");
+        fprintf(source, "            rc = __unmarshall_%s_%s(&out[i], &cursor, dbuf);\n",
+                name, mode ? "vector" : "contig");
+        fprintf(source, "            if (unlikely(rc < 0)) return -1;\n");
+        fprintf(source, "            if (lengths) lengths[i] = rc;\n");
+        fprintf(source, "            len += rc;\n");
+        fprintf(source, "        }\n");
+    }
+
+    fprintf(source, "    }\n");
+    fprintf(source, "    return len;\n");
+    fprintf(source, "}\n\n");
+} /* emit_batch_wrappers */
+
+void
+emit_wrappers(
+    FILE              *source,
+    const char        *name,
+    struct xdr_struct *xdr_structp,
+    int                message,
+    int                footprints)
+{
+    /* Only message types export the cursor encoder; elsewhere it folds into marshall_X() */
+    if (message) {
+        fprintf(source, "int WARN_UNUSED_RESULT\n");
+    } else {
+        fprintf(source, "static int WARN_UNUSED_RESULT\n");
+    }
+    fprintf(source, "marshall_%s_cursor(\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    struct xdr_write_cursor *cursor) {\n");
 
     if (xdr_structp && xdr_structp->linkedlist) {
         /* For linked list structs, iterate through the list with value-follows markers */
@@ -1676,38 +4774,210 @@ emit_wrappers(
         fprintf(source, "    struct %s *current = out;\n", name);
         fprintf(source, "    while (current != NULL) {\n");
         fprintf(source, "        more = 1;\n");
-        fprintf(source, "        if (unlikely(__marshall_uint32_t(&more, &cursor) < 0)) return -1;\n");
-        fprintf(source, "        if (unlikely(__marshall_%s(current, &cursor) < 0)) return -1;\n", name);
+        fprintf(source, "        if (unlikely(__marshall_uint32_t(&more, cursor) < 0)) return -1;\n");
+        fprintf(source, "        if (unlikely(__marshall_%s(current, cursor) < 0)) return -1;\n", name);
         fprintf(source, "        current = current->%s;\n", xdr_structp->nextmember);
         fprintf(source, "    }\n");
         fprintf(source, "    more = 0;\n");
-        fprintf(source, "    if (unlikely(__marshall_uint32_t(&more, &cursor) < 0)) return -1;\n");
+        fprintf(source, "    if (unlikely(__marshall_uint32_t(&more, cursor) < 0)) return -1;\n");
     } else {
-        fprintf(source, "    if (unlikely(__marshall_%s(out, &cursor) < 0)) return -1;\n", name);
+        fprintf(source, "    if (unlikely(__marshall_%s(out, cursor) < 0)) return -1;\n", name);
+    }
+
+    fprintf(source, "    return 0;\n");
+    fprintf(source, "}\n\n");
+
+    fprintf(source, "int WARN_UNUSED_RESULT\n");
+    fprintf(source, "marshall_%s(\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    xdr_iovec *iov_in,\n");
+    fprintf(source, "    xdr_iovec *iov_out,\n");
+    fprintf(source, "    int *niov_out,\n");
+    fprintf(source, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
+    fprintf(source, "    int out_offset) {\n");
+    fprintf(source, "    struct xdr_write_cursor cursor;\n");
+
+    /* Test builds check the dry run against every real encode */
+    if (footprints) {
+        fprintf(source, "#ifdef XDR_CHECK_REQUIREMENTS\n");
+        fprintf(source, "    int check_niov = 0, check_scratch = -1;\n");
+        fprintf(source, "    if (rdma_chunk == NULL) {\n");
+        fprintf(source, "        check_scratch = marshall_requirements_%s(out, out_offset, NULL, &check_niov);\n",
+                name);
+        fprintf(source, "    }\n");
+        fprintf(source, "#endif /* ifdef XDR_CHECK_REQUIREMENTS */\n");
+    }
+
+    fprintf(source,
+            "    xdr_write_cursor_init(&cursor, iov_in, iov_out, *niov_out, rdma_chunk, out_offset);\n");
+    fprintf(source, "    if (unlikely(marshall_%s_cursor(out, &cursor) < 0)) return -1;\n", name);
+    fprintf(source, "    if (unlikely(xdr_write_cursor_flush(&cursor) < 0)) return -1;\n");
+    fprintf(source, "    *niov_out = cursor.niov;\n");
+
+    if (footprints) {
+        fprintf(source, "#ifdef XDR_CHECK_REQUIREMENTS\n");
+        fprintf(source, "    if (rdma_chunk == NULL) {\n");
+        fprintf(source, "        xdr_check_requirements(\"%s\", check_scratch, check_niov, iov_in, cursor.niov);\n",
+                name);
+        fprintf(source, "    }\n");
+        fprintf(source, "#endif /* ifdef XDR_CHECK_REQUIREMENTS */\n");
     }
 
+    fprintf(source, "    return cursor.total;\n");
+    fprintf(source, "}\n\n");
+
+    /* The vector decoder is instantiated once, here, and shared with unmarshall_X() */
+    fprintf(source, "int WARN_UNUSED_RESULT __attribute__((noinline))\n");
+    fprintf(source, "unmarshall_%s_cursor(\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    struct xdr_read_cursor *cursor,\n");
+    fprintf(source, "    xdr_dbuf *dbuf) {\n");
+    fprintf(source, "    return __unmarshall_%s_vector(out, cursor, dbuf);\n", name);
+    fprintf(source, "}\n\n");
+
+    fprintf(source, "int WARN_UNUSED_RESULT\n");
+    fprintf(source, "unmarshall_%s(\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    xdr_iovec *iov,\n");
+    fprintf(source, "    int niov,\n");
+    fprintf(source, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
+    fprintf(source, "    xdr_dbuf *dbuf) {\n");
+    fprintf(source, "    struct xdr_read_cursor cursor;\n");
+    fprintf(source, "    if (niov == 1) {\n");
+    fprintf(source, "        xdr_read_cursor_contig_init(&cursor, iov, rdma_chunk);\n");
+    fprintf(source, "        return __unmarshall_%s_contig(out, &cursor, dbuf);\n", name);
+    fprintf(source, "    } else {\n");
+    fprintf(source, "        xdr_read_cursor_vector_init(&cursor, iov, niov, rdma_chunk);\n");
+    fprintf(source, "        return unmarshall_%s_cursor(out, &cursor, dbuf);\n", name);
+    fprintf(source, "    }\n");
+    fprintf(source, "}\n\n");
+} /* emit_wrappers */
+
+void
+emit_digest_wrappers(
+    FILE       *source,
+    const char *name)
+{
+    fprintf(source, "int WARN_UNUSED_RESULT\n");
+    fprintf(source, "marshall_%s_digest(\n", name);
+    fprintf(source, "    struct %s *in,\n", name);
+    fprintf(source, "    xdr_iovec *iov_in,\n");
+    fprintf(source, "    xdr_iovec *iov_out,\n");
+    fprintf(source, "    int *niov_out,\n");
+    fprintf(source, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
+    fprintf(source, "    int out_offset,\n");
+    fprintf(source, "    uint32_t *digest) {\n");
+    fprintf(source, "    struct xdr_write_cursor cursor;\n");
+    fprintf(source,
+            "    xdr_write_cursor_init(&cursor, iov_in, iov_out, *niov_out, rdma_chunk, out_offset);\n");
+    fprintf(source, "    xdr_write_cursor_set_digest(&cursor, 1);\n");
+    fprintf(source, "    if (unlikely(marshall_%s_cursor(in, &cursor) < 0)) return -1;\n", name);
     fprintf(source, "    if (unlikely(xdr_write_cursor_flush(&cursor) < 0)) return -1;\n");
     fprintf(source, "    *niov_out = cursor.niov;\n");
+    fprintf(source, "    *digest   = xdr_write_cursor_digest(&cursor);\n");
     fprintf(source, "    return cursor.total;\n");
     fprintf(source, "}\n\n");
 
-    fprintf(source, "int WARN_UNUSED_RESULT\n");
-    fprintf(source, "unmarshall_%s(\n", name);
-    fprintf(source, "    struct %s *out,\n", name);
-    fprintf(source, "    xdr_iovec *iov,\n");
-    fprintf(source, "    int niov,\n");
-    fprintf(source, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
-    fprintf(source, "    xdr_dbuf *dbuf) {\n");
-    fprintf(source, "    struct xdr_read_cursor cursor;\n");
-    fprintf(source, "    if (niov == 1) {\n");
-    fprintf(source, "        xdr_read_cursor_contig_init(&cursor, iov, rdma_chunk);\n");
-    fprintf(source, "        return __unmarshall_%s_contig(out, &cursor, dbuf);\n", name);
-    fprintf(source, "    } else {\n");
-    fprintf(source, "        xdr_read_cursor_vector_init(&cursor, iov, niov, rdma_chunk);\n");
-    fprintf(source, "        return __unmarshall_%s_vector(out, &cursor, dbuf);\n", name);
-    fprintf(source, "    }\n");
-    fprintf(source, "}\n\n");
-} /* emit_wrappers */
+    fprintf(source, "int WARN_UNUSED_RESULT\n");
+    fprintf(source, "unmarshall_%s_digest(\n", name);
+    fprintf(source, "    struct %s *out,\n", name);
+    fprintf(source, "    xdr_iovec *iov,\n");
+    fprintf(source, "    int niov,\n");
+    fprintf(source, "    struct evpl_rpc2_rdma_chunk *rdma_chunk,\n");
+    fprintf(source, "    xdr_dbuf *dbuf,\n");
+    fprintf(source, "    uint32_t *digest) {\n");
+    fprintf(source, "    struct xdr_read_cursor cursor;\n");
+    fprintf(source, "    int rc;\n");
+    fprintf(source, "    xdr_read_cursor_vector_init(&cursor, iov, niov, rdma_chunk);\n");
+    fprintf(source, "    xdr_read_cursor_set_digest(&cursor, 1);\n");
+    fprintf(source, "    if (niov == 1) {\n");
+    fprintf(source, "        rc = __unmarshall_%s_contig(out, &cursor, dbuf);\n", name);
+    fprintf(source, "    } else {\n");
+    fprintf(source, "        rc = unmarshall_%s_cursor(out, &cursor, dbuf);\n", name);
+    fprintf(source, "    }\n");
+    fprintf(source, "    if (unlikely(rc < 0)) return -1;\n");
+    fprintf(source, "    *digest = xdr_read_cursor_digest(&cursor);\n");
+    fprintf(source, "    return rc;\n");
+    fprintf(source, "}\n\n");
+} /* emit_digest_wrappers */
+
+/* C++ trait and codec specializations for one type, emitted with -x c++ */
+void
+emit_cxx_type(
+    FILE              *header,
+    const char        *name,
+    struct xdr_struct *xdr_structp)
+{
+    struct xdr_type type;
+
+    memset(&type, 0, sizeof(type));
+    type.name = (char *) name;
+
+    /* Matches the XDR_WIRE_SIZE_X constants from emit_wire_size() */
+    if (xdr_structp && !xdr_structp->linkedlist && type_fixed_wire_size(&type) >= 0) {
+        fprintf(header, "template <>\n");
+        fprintf(header, "struct wire_size<%s> : std::integral_constant<int, XDR_WIRE_SIZE_%s> {};\n\n",
+                name, name);
+    }
+
+    fprintf(header, "template <>\n");
+    fprintf(header, "struct limits<%s> {\n", name);
+    fprintf(header, "    static constexpr int64_t max_wire_size = XDR_MAX_WIRE_SIZE_%s;\n", name);
+    fprintf(header, "    static constexpr int64_t max_iov       = XDR_MAX_IOV_%s;\n", name);
+    fprintf(header, "    static constexpr int64_t\n");
+    fprintf(header, "    max_dbuf(int niov)\n");
+    fprintf(header, "    {\n");
+    fprintf(header, "        return XDR_MAX_DBUF_%s(niov);\n", name);
+    fprintf(header, "    }\n");
+    fprintf(header, "};\n\n");
+
+    fprintf(header, "template <>\n");
+    fprintf(header, "struct codec<%s> {\n", name);
+    fprintf(header, "    static FORCE_INLINE int WARN_UNUSED_RESULT\n");
+    fprintf(header, "    marshall(\n");
+    fprintf(header, "        const %s &in,\n", name);
+    fprintf(header, "        struct xdr_write_cursor *cursor)\n");
+    fprintf(header, "    {\n");
+
+    if (xdr_structp && xdr_structp->linkedlist) {
+        /* Same value-follows framing as marshall_X_cursor() */
+        fprintf(header, "        uint32_t more = 1;\n");
+        fprintf(header, "        for (const %s *current = &in; current; current = current->%s) {\n",
+                name, xdr_structp->nextmember);
+        fprintf(header, "            if (unlikely(__marshall_uint32_t(&more, cursor) < 0)) return -1;\n");
+        fprintf(header,
+                "            if (unlikely(__marshall_%s(const_cast<%s *>(current), cursor) < 0)) return -1;\n",
+                name, name);
+        fprintf(header, "        }\n");
+        fprintf(header, "        more = 0;\n");
+        fprintf(header, "        return __marshall_uint32_t(&more, cursor);\n");
+    } else {
+        fprintf(header, "        return __marshall_%s(const_cast<%s *>(&in), cursor);\n", name, name);
+    }
+
+    fprintf(header, "    }\n\n");
+
+    fprintf(header, "    template <typename Kind>\n");
+    fprintf(header, "    static FORCE_INLINE int WARN_UNUSED_RESULT\n");
+    fprintf(header, "    unmarshall(\n");
+    fprintf(header, "        %s &out,\n", name);
+    fprintf(header, "        struct xdr_read_cursor *cursor,\n");
+    fprintf(header, "        xdr_dbuf *dbuf)\n");
+    fprintf(header, "    {\n");
+    fprintf(header, "        if constexpr (std::is_same_v<Kind, contig_cursor>) {\n");
+    fprintf(header, "            return __unmarshall_%s_contig(&out, cursor, dbuf);\n", name);
+    fprintf(header, "        } else {\n");
+    fprintf(header, "            return __unmarshall_%s_vector(&out, cursor, dbuf);\n", name);
+    fprintf(header, "        }\n");
+    fprintf(header, "    }\n\n");
+
+    fprintf(header, "    static FORCE_INLINE int\n");
+    fprintf(header, "    length(const %s &in)\n", name);
+    fprintf(header, "    {\n");
+    fprintf(header, "        return __marshall_length_%s(&in);\n", name);
+    fprintf(header, "    }\n");
+    fprintf(header, "};\n\n");
+} /* emit_cxx_type */
 
 void
 print_usage(const char *prog_name)
@@ -1715,6 +4985,15 @@ print_usage(const char *prog_name)
     fprintf(stderr, "Usage: %s <input.x> <output.c> <output.h>\n", prog_name);
     fprintf(stderr, "Options:\n");
     fprintf(stderr, "  -h            Display this help message and exit\n");
+    fprintf(stderr, "  -r            Generate RPC2 program bindings\n");
+    fprintf(stderr, "  -V            Generate lazy view accessors\n");
+    fprintf(stderr, "  -F            Generate unmarshall footprint and marshall requirements functions\n");
+    fprintf(stderr, "  -C            Generate validate functions\n");
+    fprintf(stderr, "  -i            Generate resumable incremental marshall and unmarshall\n");
+    fprintf(stderr, "  -t            Use table-driven code for all structs\n");
+    fprintf(stderr, "  -T <type>     Use table-driven code for the given struct, may be repeated\n");
+    fprintf(stderr, "  -M <type>     Generate digest and batch functions for the given type, may be repeated\n");
+    fprintf(stderr, "  -x <lang>     Output language, c (default) or c++\n");
 } /* print_usage */
 
 int
@@ -1725,23 +5004,29 @@ main(
     struct xdr_struct        *xdr_structp;
     struct xdr_struct_member *xdr_struct_memberp;
     struct xdr_union         *xdr_unionp;
-    struct xdr_union_case    *xdr_union_casep;
+    struct xdr_union_case    *xdr_union_casep, *armp;
     struct xdr_typedef       *xdr_typedefp;
     struct xdr_enum          *xdr_enump;
     struct xdr_enum_entry    *xdr_enum_entryp;
     struct xdr_program       *xdr_programp;
     struct xdr_version       *xdr_versionp;
+    struct xdr_function      *xdr_functionp;
     struct xdr_const         *xdr_constp;
     struct xdr_buffer        *xdr_buffer;
     struct xdr_identifier    *xdr_identp, *xdr_identp_tmp, *chk, *chkm;
-    int                       unemitted, ready, emit_rpc2 = 0;
-    FILE                     *header, *source;
+    int                       unemitted, ready, emit_rpc2 = 0, emit_views = 0, emit_resume = 0;
+    int                       emit_footprints = 0, emit_validators = 0;
+    int                       varlen_default;
+    FILE                     *header, *source, *codec;
     const char               *input_file;
     const char               *output_c;
     const char               *output_h;
-    int                       opt;
+    int                       opt, table_all = 0, num_table_names = 0, cxx = 0;
+    const char               *table_names[256];
+    int                       num_message_names = 0;
+    const char               *message_names[256];
 
-    while ((opt = getopt(argc, argv, "hr")) != -1) {
+    while ((opt = getopt(argc, argv, "hrVFCitT:M:x:")) != -1) {
         switch (opt) {
             case 'h':
                 print_usage(argv[0]);
@@ -1749,6 +5034,46 @@ main(
             case 'r':
                 emit_rpc2 = 1;
                 break;
+            case 'V':
+                emit_views = 1;
+                break;
+            case 'F':
+                emit_footprints = 1;
+                break;
+            case 'C':
+                emit_validators = 1;
+                break;
+            case 'i':
+                emit_resume = 1;
+                break;
+            case 't':
+                table_all = 1;
+                break;
+            case 'T':
+                if (num_table_names == (int) (sizeof(table_names) / sizeof(table_names[0]))) {
+                    fprintf(stderr, "Error: Too many -T types.\n");
+                    return 1;
+                }
+                table_names[num_table_names++] = optarg;
+                break;
+            case 'M':
+                if (num_message_names == (int) (sizeof(message_names) / sizeof(message_names[0]))) {
+                    fprintf(stderr, "Error: Too many -M types.\n");
+                    return 1;
+                }
+                message_names[num_message_names++] = optarg;
+                break;
+            case 'x':
+                if (strcmp(optarg, "c") == 0) {
+                    cxx = 0;
+                } else if (strcmp(optarg, "c++") == 0) {
+                    cxx = 1;
+                } else {
+                    fprintf(stderr, "Error: Unknown output language %s.\n", optarg);
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
             default:
                 print_usage(argv[0]);
                 return 1;
@@ -1910,6 +5235,60 @@ main(
         } /* switch */
     }
 
+    DL_FOREACH(xdr_structs, xdr_structp)
+    {
+        DL_FOREACH(xdr_structp->members, xdr_struct_memberp)
+        {
+            struct xdr_type *type = xdr_struct_memberp->type;
+
+            if (xdr_struct_memberp->hash &&
+                !(strcmp(type->name, "xdr_string") == 0 ||
+                  (type->opaque && !type->zerocopy && !type->array))) {
+                fprintf(stderr,
+                        "struct %s element %s: hash requires a string or variable length opaque\n",
+                        xdr_structp->name, xdr_struct_memberp->name);
+                exit(1);
+            }
+        }
+    }
+
+    for (opt = 0; opt < num_table_names; opt++) {
+        HASH_FIND_STR(xdr_identifiers, table_names[opt], chk);
+
+        if (!chk || chk->type != XDR_STRUCT) {
+            fprintf(stderr, "-T %s does not name a struct\n", table_names[opt]);
+            exit(1);
+        }
+
+        ((struct xdr_struct *) chk->ptr)->table = 1;
+    }
+
+    /* Digest and batch entry points are only generated for top-level message types */
+    DL_FOREACH(xdr_programs, xdr_programp)
+    {
+        DL_FOREACH(xdr_programp->versions, xdr_versionp)
+        {
+            DL_FOREACH(xdr_versionp->functions, xdr_functionp)
+            {
+                mark_message_type(xdr_functionp->call_type->name);
+                mark_message_type(xdr_functionp->reply_type->name);
+            }
+        }
+    }
+
+    for (opt = 0; opt < num_message_names; opt++) {
+        if (mark_message_type(message_names[opt]) < 0) {
+            fprintf(stderr, "-M %s does not name a struct or union\n", message_names[opt]);
+            exit(1);
+        }
+    }
+
+    DL_FOREACH(xdr_structs, xdr_structp)
+    {
+        /* List nodes stay inlined, their length covers the rest of the list */
+        xdr_structp->table = (xdr_structp->table || table_all) && !xdr_structp->linkedlist;
+    }
+
     header = fopen(output_h, "w");
 
     if (!header) {
@@ -1933,7 +5312,16 @@ main(
 
     DL_FOREACH(xdr_enums, xdr_enump)
     {
-        fprintf(header, "typedef enum {\n");
+        /*
+         * Enum members are coded as uint32_t, and C++ will not convert an
+         * enum pointer to uint32_t *, so there the type is uint32_t itself.
+         */
+        if (cxx) {
+            fprintf(header, "typedef uint32_t %s;\n\n", xdr_enump->name);
+            fprintf(header, "enum {\n");
+        } else {
+            fprintf(header, "typedef enum {\n");
+        }
 
         DL_FOREACH(xdr_enump->entries, xdr_enum_entryp)
         {
@@ -1942,7 +5330,11 @@ main(
                     xdr_enum_entryp->value);
         }
 
-        fprintf(header, "} %s;\n\n", xdr_enump->name);
+        if (cxx) {
+            fprintf(header, "};\n\n");
+        } else {
+            fprintf(header, "} %s;\n\n", xdr_enump->name);
+        }
     }
 
     fprintf(header, "\n");
@@ -1987,6 +5379,11 @@ main(
             {
                 emit_member(header, xdr_struct_memberp->name,
                             xdr_struct_memberp->type);
+
+                if (xdr_struct_memberp->hash) {
+                    fprintf(header, "    uint32_t  %s_hash;\n",
+                            xdr_struct_memberp->name);
+                }
             }
             fprintf(header, "};\n\n");
 
@@ -2067,14 +5464,83 @@ main(
 
     DL_FOREACH(xdr_structs, xdr_structp)
     {
-        emit_wrapper_headers(header, xdr_structp->name);
+        emit_wire_size(header, xdr_structp);
+        emit_max_size(header, xdr_structp->name, xdr_structp, NULL);
+    }
+
+    DL_FOREACH(xdr_unions, xdr_unionp)
+    {
+        emit_max_size(header, xdr_unionp->name, NULL, xdr_unionp);
+    }
+
+    fprintf(header, "\n");
+
+    if (emit_views) {
+        DL_FOREACH(xdr_structs, xdr_structp)
+        {
+            emit_view_type(header, xdr_structp->name, xdr_structp);
+        }
+
+        DL_FOREACH(xdr_unions, xdr_unionp)
+        {
+            emit_view_type(header, xdr_unionp->name, NULL);
+        }
+    }
+
+    DL_FOREACH(xdr_structs, xdr_structp)
+    {
+        emit_wrapper_headers(header, xdr_structp->name, xdr_structp->message);
         emit_dump_headers(header, xdr_structp->name);
+
+        if (emit_views) {
+            emit_view_headers(header, xdr_structp->name, xdr_structp, NULL);
+        }
+
+        if (xdr_structp->message) {
+            emit_digest_wrapper_headers(header, xdr_structp->name);
+            emit_batch_wrapper_headers(header, xdr_structp->name);
+        }
+
+        if (emit_validators) {
+            emit_validate_wrapper_headers(header, xdr_structp->name);
+        }
+
+        if (emit_footprints) {
+            emit_footprint_wrapper_headers(header, xdr_structp->name);
+        }
+
+        if (emit_resume) {
+            emit_resume_wrapper_headers(header, xdr_structp->name);
+            emit_marshall_resume_wrapper_headers(header, xdr_structp->name);
+        }
     }
 
     DL_FOREACH(xdr_unions, xdr_unionp)
     {
-        emit_wrapper_headers(header, xdr_unionp->name);
+        emit_wrapper_headers(header, xdr_unionp->name, xdr_unionp->message);
         emit_dump_headers(header, xdr_unionp->name);
+
+        if (emit_views) {
+            emit_view_headers(header, xdr_unionp->name, NULL, xdr_unionp);
+        }
+
+        if (xdr_unionp->message) {
+            emit_digest_wrapper_headers(header, xdr_unionp->name);
+            emit_batch_wrapper_headers(header, xdr_unionp->name);
+        }
+
+        if (emit_validators) {
+            emit_validate_wrapper_headers(header, xdr_unionp->name);
+        }
+
+        if (emit_footprints) {
+            emit_footprint_wrapper_headers(header, xdr_unionp->name);
+        }
+
+        if (emit_resume) {
+            emit_resume_wrapper_headers(header, xdr_unionp->name);
+            emit_marshall_resume_wrapper_headers(header, xdr_unionp->name);
+        }
     }
 
 
@@ -2088,7 +5554,24 @@ main(
         }
     }
 
-    fclose(header);
+    /*
+     * With -x c++ the codec itself goes in the header, after the builtin
+     * runtime, so C++ callers can inline it; the output .c then holds the
+     * out-of-line C API and must be compiled as C++.
+     */
+    if (cxx) {
+        fprintf(header, "\n#include <stdio.h>\n\n");
+        fprintf(header, "#pragma GCC diagnostic push\n");
+        fprintf(header, "#pragma GCC diagnostic ignored \"-Wpointer-arith\"\n");
+        fprintf(header, "#pragma GCC diagnostic ignored \"-Wtype-limits\"\n");
+        fprintf(header, "#pragma GCC diagnostic ignored \"-Wunused-function\"\n");
+        fprintf(header, "#pragma GCC diagnostic ignored \"-Wunused-variable\"\n\n");
+        fprintf(header, "%s", embedded_builtin_c);
+        fprintf(header, "\n");
+        codec = header;
+    } else {
+        fclose(header);
+    }
 
     source = fopen(output_c, "w");
 
@@ -2103,103 +5586,150 @@ main(
 
     fprintf(source, "\n");
 
-    fprintf(source, "%s", embedded_builtin_c);
-
-    fprintf(source, "\n");
+    if (!cxx) {
+        fprintf(source, "%s", embedded_builtin_c);
+        fprintf(source, "\n");
+        codec = source;
+    }
 
     DL_FOREACH(xdr_structs, xdr_structp)
     {
-        emit_internal_headers(source, xdr_structp->name);
+        emit_internal_headers(codec, xdr_structp->name);
         emit_dump_internal(source, xdr_structp->name);
+        emit_skip_headers(source, xdr_structp->name);
+
+        if (emit_validators) {
+            emit_validate_headers(source, xdr_structp->name);
+        }
+
+        if (emit_footprints) {
+            emit_footprint_headers(source, xdr_structp->name);
+        }
+
+        if (is_run_struct(xdr_structp)) {
+            emit_pack_headers(codec, xdr_structp->name);
+        }
+
+        if (emit_resume) {
+            emit_resume_headers(source, xdr_structp->name);
+            emit_marshall_resume_headers(source, xdr_structp->name);
+        }
     }
 
     DL_FOREACH(xdr_unions, xdr_unionp)
     {
-        emit_internal_headers(source, xdr_unionp->name);
+        emit_internal_headers(codec, xdr_unionp->name);
         emit_dump_internal(source, xdr_unionp->name);
+        emit_skip_headers(source, xdr_unionp->name);
+
+        if (emit_validators) {
+            emit_validate_headers(source, xdr_unionp->name);
+        }
+
+        if (emit_footprints) {
+            emit_footprint_headers(source, xdr_unionp->name);
+        }
+
+        if (emit_resume) {
+            emit_resume_headers(source, xdr_unionp->name);
+            emit_marshall_resume_headers(source, xdr_unionp->name);
+        }
     }
 
+    emit_tables(codec, cxx);
+
     DL_FOREACH(xdr_structs, xdr_structp)
     {
         int is_recursive = is_type_recursive(xdr_structp->name);
 
-        if (is_recursive) {
-            fprintf(source, "static int WARN_UNUSED_RESULT\n");
-        } else {
-            fprintf(source, "static FORCE_INLINE int WARN_UNUSED_RESULT\n");
+        if (is_run_struct(xdr_structp)) {
+            emit_pack_struct(codec, xdr_structp->name, xdr_structp);
         }
-        fprintf(source, "__marshall_%s(\n", xdr_structp->name);
-        fprintf(source, "    struct %s *in,\n", xdr_structp->name);
-        fprintf(source, "    struct xdr_write_cursor *cursor) {\n");
 
-        DL_FOREACH(xdr_structp->members, xdr_struct_memberp)
-        {
-            if (xdr_structp->linkedlist &&
-                strncmp(xdr_struct_memberp->name, "next", 4) == 0) {
-                continue;
+        if (xdr_structp->table) {
+            emit_table_stubs(codec, xdr_structp->name);
+        } else {
+            if (is_recursive) {
+                fprintf(codec, "static int WARN_UNUSED_RESULT\n");
+            } else {
+                fprintf(codec, "static FORCE_INLINE int WARN_UNUSED_RESULT\n");
             }
+            fprintf(codec, "__marshall_%s(\n", xdr_structp->name);
+            fprintf(codec, "    struct %s *in,\n", xdr_structp->name);
+            fprintf(codec, "    struct xdr_write_cursor *cursor) {\n");
 
-            emit_marshall(source, xdr_struct_memberp->name,
-                          xdr_struct_memberp->type);
-        }
+            emit_struct_members(codec, xdr_structp, "marshall");
 
-        fprintf(source, "    return 0;\n");
-        fprintf(source, "}\n\n");
+            fprintf(codec, "    return 0;\n");
+            fprintf(codec, "}\n\n");
 
-        if (is_recursive) {
-            fprintf(source, "static int WARN_UNUSED_RESULT\n");
-        } else {
-            fprintf(source, "static FORCE_INLINE int WARN_UNUSED_RESULT\n");
+            if (is_recursive) {
+                fprintf(codec, "static int WARN_UNUSED_RESULT\n");
+            } else {
+                fprintf(codec, "static FORCE_INLINE int WARN_UNUSED_RESULT\n");
+            }
+            fprintf(codec, "__unmarshall_%s_vector(\n", xdr_structp->name);
+            fprintf(codec, "    struct %s *out,\n", xdr_structp->name);
+            fprintf(codec, "    struct xdr_read_cursor *cursor,\n");
+            fprintf(codec, "    xdr_dbuf *dbuf) {\n");
+            fprintf(codec, "    int rc, len = 0;\n");
+
+            emit_struct_members(codec, xdr_structp, "vector");
+            fprintf(codec, "    return len;\n");
+            fprintf(codec, "}\n\n");
+
+            if (is_recursive) {
+                fprintf(codec, "static int WARN_UNUSED_RESULT\n");
+            } else {
+                fprintf(codec, "static FORCE_INLINE int WARN_UNUSED_RESULT\n");
+            }
+            fprintf(codec, "__unmarshall_%s_contig(\n", xdr_structp->name);
+            fprintf(codec, "    struct %s *out,\n", xdr_structp->name);
+            fprintf(codec, "    struct xdr_read_cursor *cursor,\n");
+            fprintf(codec, "    xdr_dbuf *dbuf) {\n");
+            fprintf(codec, "    int rc, len = 0;\n");
+
+            emit_struct_members(codec, xdr_structp, "contig");
+            fprintf(codec, "    return len;\n");
+            fprintf(codec, "}\n\n");
         }
-        fprintf(source, "__unmarshall_%s_vector(\n", xdr_structp->name);
-        fprintf(source, "    struct %s *out,\n", xdr_structp->name);
-        fprintf(source, "    struct xdr_read_cursor *cursor,\n");
-        fprintf(source, "    xdr_dbuf *dbuf) {\n");
-        fprintf(source, "    int rc, len = 0;\n");
-
-        DL_FOREACH(xdr_structp->members, xdr_struct_memberp)
-        {
 
-            if (xdr_structp->linkedlist &&
-                strncmp(xdr_struct_memberp->name, "next", 4) == 0) {
-                continue;
-            }
+        emit_wrappers(source, xdr_structp->name, xdr_structp, xdr_structp->message, emit_footprints);
 
-            emit_unmarshall(source, xdr_struct_memberp->name, xdr_struct_memberp
-                            ->type);
+        if (xdr_structp->message) {
+            emit_digest_wrappers(source, xdr_structp->name);
+            emit_batch_wrappers(source, xdr_structp->name, xdr_structp);
         }
-        fprintf(source, "    return len;\n");
-        fprintf(source, "}\n\n");
 
-        if (is_recursive) {
-            fprintf(source, "static int WARN_UNUSED_RESULT\n");
-        } else {
-            fprintf(source, "static FORCE_INLINE int WARN_UNUSED_RESULT\n");
-        }
-        fprintf(source, "__unmarshall_%s_contig(\n", xdr_structp->name);
-        fprintf(source, "    struct %s *out,\n", xdr_structp->name);
-        fprintf(source, "    struct xdr_read_cursor *cursor,\n");
-        fprintf(source, "    xdr_dbuf *dbuf) {\n");
-        fprintf(source, "    int rc, len = 0;\n");
+        emit_dump_struct(source, xdr_structp->name, xdr_structp);
+        emit_length_struct(codec, xdr_structp->name, xdr_structp);
+        emit_length_wrapper(source, xdr_structp->name);
 
-        DL_FOREACH(xdr_structp->members, xdr_struct_memberp)
-        {
+        emit_skip_struct(source, xdr_structp->name, xdr_structp, "vector");
+        emit_skip_struct(source, xdr_structp->name, xdr_structp, "contig");
+        emit_skip_wrapper(source, xdr_structp->name);
 
-            if (xdr_structp->linkedlist &&
-                strncmp(xdr_struct_memberp->name, "next", 4) == 0) {
-                continue;
-            }
+        if (emit_validators) {
+            emit_validate_struct(source, xdr_structp->name, xdr_structp);
+            emit_validate_wrapper(source, xdr_structp->name);
+        }
 
-            emit_unmarshall_contig(source, xdr_struct_memberp->name, xdr_struct_memberp
-                                   ->type);
+        if (emit_footprints) {
+            emit_footprint_struct(source, xdr_structp->name, xdr_structp, "vector");
+            emit_footprint_struct(source, xdr_structp->name, xdr_structp, "contig");
+            emit_footprint_wrapper(source, xdr_structp->name);
         }
-        fprintf(source, "    return len;\n");
-        fprintf(source, "}\n\n");
 
-        emit_wrappers(source, xdr_structp->name, xdr_structp);
+        if (emit_views) {
+            emit_view_struct(source, xdr_structp->name, xdr_structp);
+        }
 
-        emit_dump_struct(source, xdr_structp->name, xdr_structp);
-        emit_length_struct(source, xdr_structp->name, xdr_structp);
+        if (emit_resume) {
+            emit_resume_struct(source, xdr_structp->name, xdr_structp);
+            emit_resume_wrapper(source, xdr_structp->name);
+            emit_marshall_resume_struct(source, xdr_structp->name, xdr_structp);
+            emit_marshall_resume_wrapper(source, xdr_structp->name);
+        }
     } /* main */
 
     DL_FOREACH(xdr_unions, xdr_unionp)
@@ -2207,94 +5737,30 @@ main(
         int is_recursive = is_type_recursive(xdr_unionp->name);
 
         if (is_recursive) {
-            fprintf(source, "static int WARN_UNUSED_RESULT\n");
+            fprintf(codec, "static int WARN_UNUSED_RESULT\n");
         } else {
-            fprintf(source, "static FORCE_INLINE int WARN_UNUSED_RESULT\n");
+            fprintf(codec, "static FORCE_INLINE int WARN_UNUSED_RESULT\n");
         }
-        fprintf(source, "__marshall_%s(\n", xdr_unionp->name);
-        fprintf(source, "    struct %s *in,\n", xdr_unionp->name);
-        fprintf(source, "    struct xdr_write_cursor *cursor) {\n");
-
-        emit_marshall(source, xdr_unionp->pivot_name, xdr_unionp->pivot_type);
-
-        if (xdr_unionp->opaque) {
-            /*
-             * For opaque unions, calculate and write body length before the body.
-             * Exception: varlen opaque types have their own length prefix, so skip
-             * writing a separate body_len for those cases.
-             */
-            fprintf(source, "    {\n");
-            fprintf(source, "        uint32_t body_len = 0;\n");
-            fprintf(source, "        int skip_body_len = 0;\n");
-            fprintf(source, "        switch (in->%s) {\n", xdr_unionp->pivot_name);
-
-            DL_FOREACH(xdr_unionp->cases, xdr_union_casep)
-            {
-                if (strcmp(xdr_union_casep->label, "default") != 0) {
-                    fprintf(source, "        case %s:\n", xdr_union_casep->label);
-                    if (xdr_union_casep->voided) {
-                        fprintf(source, "            body_len = 0;\n");
-                    } else if (xdr_union_casep->type) {
-                        /* Handle opaque types specially - they don't have __marshall_length_* functions */
-                        if (is_varlen_opaque(xdr_union_casep->type)) {
-                            /* Varlen opaque has its own length prefix - skip body_len */
-                            fprintf(source, "            skip_body_len = 1;\n");
-                        } else if (xdr_union_casep->type->opaque) {
-                            /* Fixed-size opaque array - still need body_len */
-                            fprintf(source, "            body_len = xdr_pad(%s);\n",
-                                    xdr_union_casep->type->array_size);
-                        } else {
-                            fprintf(source, "            body_len = __marshall_length_%s(&in->%s);\n",
-                                    xdr_union_casep->type->name, xdr_union_casep->name);
-                        }
-                    }
-                    fprintf(source, "            break;\n");
-                }
-            }
-
-            DL_FOREACH(xdr_unionp->cases, xdr_union_casep)
-            {
-                if (strcmp(xdr_union_casep->label, "default") == 0) {
-                    fprintf(source, "        default:\n");
-                    if (xdr_union_casep->voided) {
-                        fprintf(source, "            body_len = 0;\n");
-                    } else if (xdr_union_casep->type) {
-                        /* Handle opaque types specially - they don't have __marshall_length_* functions */
-                        if (is_varlen_opaque(xdr_union_casep->type)) {
-                            /* Varlen opaque has its own length prefix - skip body_len */
-                            fprintf(source, "            skip_body_len = 1;\n");
-                        } else if (xdr_union_casep->type->opaque) {
-                            /* Fixed-size opaque array - still need body_len */
-                            fprintf(source, "            body_len = xdr_pad(%s);\n",
-                                    xdr_union_casep->type->array_size);
-                        } else {
-                            fprintf(source, "            body_len = __marshall_length_%s(&in->%s);\n",
-                                    xdr_union_casep->type->name, xdr_union_casep->name);
-                        }
-                    }
-                    fprintf(source, "            break;\n");
-                }
-            }
+        fprintf(codec, "__marshall_%s(\n", xdr_unionp->name);
+        fprintf(codec, "    struct %s *in,\n", xdr_unionp->name);
+        fprintf(codec, "    struct xdr_write_cursor *cursor) {\n");
 
-            fprintf(source, "        }\n");
-            fprintf(source, "        if (!skip_body_len) {\n");
-            fprintf(source, "            if (unlikely(__marshall_uint32_t(&body_len, cursor) < 0)) return -1;\n");
-            fprintf(source, "        }\n");
-            fprintf(source, "    }\n");
-        }
+        emit_marshall(codec, xdr_unionp->pivot_name, xdr_unionp->pivot_type);
 
-        fprintf(source, "    switch (in->%s) {\n", xdr_unionp->pivot_name);
+        fprintf(codec, "    switch (in->%s) {\n", xdr_unionp->pivot_name);
 
         DL_FOREACH(xdr_unionp->cases, xdr_union_casep)
         {
             if (strcmp(xdr_union_casep->label, "default") != 0) {
-                fprintf(source, "    case %s:\n", xdr_union_casep->label);
-                if (xdr_union_casep->voided) {
-                    fprintf(source, "        break;\n");
+                fprintf(codec, "    case %s:\n", xdr_union_casep->label);
+                if (xdr_unionp->opaque) {
+                    emit_marshall_opaque_arm(codec, xdr_union_casep);
+                } else if (xdr_union_casep->voided) {
+                    fprintf(codec, "        break;\n");
                 } else if (xdr_union_casep->type) {
-                    emit_marshall(source, xdr_union_casep->name, xdr_union_casep
+                    emit_marshall(codec, xdr_union_casep->name, xdr_union_casep
                                   ->type);
-                    fprintf(source, "        break;\n");
+                    fprintf(codec, "        break;\n");
                 }
             }
         }
@@ -2302,54 +5768,59 @@ main(
         DL_FOREACH(xdr_unionp->cases, xdr_union_casep)
         {
             if (strcmp(xdr_union_casep->label, "default") == 0) {
-                fprintf(source, "    default:\n");
-                if (xdr_union_casep->voided) {
-                    fprintf(source, "        break;\n");
+                fprintf(codec, "    default:\n");
+                if (xdr_unionp->opaque) {
+                    emit_marshall_opaque_arm(codec, xdr_union_casep);
+                } else if (xdr_union_casep->voided) {
+                    fprintf(codec, "        break;\n");
                 } else if (xdr_union_casep->type) {
-                    emit_marshall(source, xdr_union_casep->name, xdr_union_casep
+                    emit_marshall(codec, xdr_union_casep->name, xdr_union_casep
                                   ->type);
-                    fprintf(source, "        break;\n");
+                    fprintf(codec, "        break;\n");
                 }
             }
         }
 
-        fprintf(source, "    }\n");
-        fprintf(source, "    return 0;\n");
-        fprintf(source, "}\n\n");
+        fprintf(codec, "    }\n");
+        fprintf(codec, "    return 0;\n");
+        fprintf(codec, "}\n\n");
 
         if (is_recursive) {
-            fprintf(source, "static int WARN_UNUSED_RESULT\n");
+            fprintf(codec, "static int WARN_UNUSED_RESULT\n");
         } else {
-            fprintf(source, "static FORCE_INLINE int WARN_UNUSED_RESULT\n");
+            fprintf(codec, "static FORCE_INLINE int WARN_UNUSED_RESULT\n");
         }
-        fprintf(source, "__unmarshall_%s_vector(\n", xdr_unionp->name);
-        fprintf(source, "    struct %s *out,\n", xdr_unionp->name);
-        fprintf(source, "    struct xdr_read_cursor *cursor,\n");
-        fprintf(source, "    xdr_dbuf *dbuf) {\n");
-        fprintf(source, "    int rc, len = 0;\n");
+        fprintf(codec, "__unmarshall_%s_vector(\n", xdr_unionp->name);
+        fprintf(codec, "    struct %s *out,\n", xdr_unionp->name);
+        fprintf(codec, "    struct xdr_read_cursor *cursor,\n");
+        fprintf(codec, "    xdr_dbuf *dbuf) {\n");
+        fprintf(codec, "    int rc, len = 0;\n");
 
         if (xdr_unionp->opaque) {
-            fprintf(source, "    uint32_t expected_body_len = 0;\n");
-            fprintf(source, "    int body_start_len = 0;\n");
-            fprintf(source, "    int skip_body_len_check = 0;\n");
+            fprintf(codec, "    uint32_t expected_body_len = 0;\n");
+            fprintf(codec, "    int body_start_len = 0;\n");
+            fprintf(codec, "    int skip_body_len_check = 0;\n");
         }
 
-        emit_unmarshall(source, xdr_unionp->pivot_name, xdr_unionp->pivot_type);
+        emit_unmarshall(codec, xdr_unionp->pivot_name, xdr_unionp->pivot_type);
 
         if (xdr_unionp->opaque) {
             /*
              * For opaque unions, read the body length, but skip for varlen
              * opaque types which have their own length prefix.
              */
-            fprintf(source, "    switch (out->%s) {\n", xdr_unionp->pivot_name);
+            fprintf(codec, "    switch (out->%s) {\n", xdr_unionp->pivot_name);
+
+            varlen_default = 0;
 
             DL_FOREACH(xdr_unionp->cases, xdr_union_casep)
             {
                 if (strcmp(xdr_union_casep->label, "default") != 0) {
-                    if (is_varlen_opaque(xdr_union_casep->type)) {
-                        fprintf(source, "    case %s:\n", xdr_union_casep->label);
-                        fprintf(source, "        skip_body_len_check = 1;\n");
-                        fprintf(source, "        break;\n");
+                    armp = union_case_arm(xdr_unionp, xdr_union_casep);
+                    if (armp && is_varlen_opaque(armp->type)) {
+                        fprintf(codec, "    case %s:\n", xdr_union_casep->label);
+                        fprintf(codec, "        skip_body_len_check = 1;\n");
+                        fprintf(codec, "        break;\n");
                     }
                 }
             }
@@ -2357,37 +5828,41 @@ main(
             DL_FOREACH(xdr_unionp->cases, xdr_union_casep)
             {
                 if (strcmp(xdr_union_casep->label, "default") == 0) {
-                    if (is_varlen_opaque(xdr_union_casep->type)) {
-                        fprintf(source, "    default:\n");
-                        fprintf(source, "        skip_body_len_check = 1;\n");
-                        fprintf(source, "        break;\n");
+                    armp = union_case_arm(xdr_unionp, xdr_union_casep);
+                    if (armp && is_varlen_opaque(armp->type)) {
+                        fprintf(codec, "    default:\n");
+                        fprintf(codec, "        skip_body_len_check = 1;\n");
+                        fprintf(codec, "        break;\n");
+                        varlen_default = 1;
                     }
                 }
             }
 
-            fprintf(source, "    default:\n");
-            fprintf(source, "        break;\n");
-            fprintf(source, "    }\n");
-            fprintf(source, "    if (!skip_body_len_check) {\n");
-            fprintf(source, "        rc = __unmarshall_uint32_t_vector(&expected_body_len, cursor, dbuf);\n");
-            fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
-            fprintf(source, "        len += rc;\n");
-            fprintf(source, "        body_start_len = len;\n");
-            fprintf(source, "    }\n");
+            if (!varlen_default) {
+                fprintf(codec, "    default:\n");
+                fprintf(codec, "        break;\n");
+            }
+            fprintf(codec, "    }\n");
+            fprintf(codec, "    if (!skip_body_len_check) {\n");
+            fprintf(codec, "        rc = __unmarshall_uint32_t_vector(&expected_body_len, cursor, dbuf);\n");
+            fprintf(codec, "        if (unlikely(rc < 0)) return rc;\n");
+            fprintf(codec, "        len += rc;\n");
+            fprintf(codec, "        body_start_len = len;\n");
+            fprintf(codec, "    }\n");
         }
 
-        fprintf(source, "    switch (out->%s) {\n", xdr_unionp->pivot_name);
+        fprintf(codec, "    switch (out->%s) {\n", xdr_unionp->pivot_name);
 
         DL_FOREACH(xdr_unionp->cases, xdr_union_casep)
         {
             if (strcmp(xdr_union_casep->label, "default") != 0) {
-                fprintf(source, "    case %s:\n", xdr_union_casep->label);
+                fprintf(codec, "    case %s:\n", xdr_union_casep->label);
                 if (xdr_union_casep->voided) {
-                    fprintf(source, "        break;\n");
+                    fprintf(codec, "        break;\n");
                 } else if (xdr_union_casep->type) {
-                    emit_unmarshall(source, xdr_union_casep->name,
+                    emit_unmarshall(codec, xdr_union_casep->name,
                                     xdr_union_casep->type);
-                    fprintf(source, "        break;\n");
+                    fprintf(codec, "        break;\n");
                 }
             }
         }
@@ -2395,61 +5870,64 @@ main(
         DL_FOREACH(xdr_unionp->cases, xdr_union_casep)
         {
             if (strcmp(xdr_union_casep->label, "default") == 0) {
-                fprintf(source, "    default:\n");
+                fprintf(codec, "    default:\n");
                 if (xdr_union_casep->voided) {
-                    fprintf(source, "        break;\n");
+                    fprintf(codec, "        break;\n");
                 } else if (xdr_union_casep->type) {
-                    emit_unmarshall(source, xdr_union_casep->name, xdr_union_casep
+                    emit_unmarshall(codec, xdr_union_casep->name, xdr_union_casep
                                     ->type);
-                    fprintf(source, "        break;\n");
+                    fprintf(codec, "        break;\n");
                 }
             }
         }
 
-        fprintf(source, "    }\n");
+        fprintf(codec, "    }\n");
 
         if (xdr_unionp->opaque) {
             /* Verify consumed bytes match expected length (unless skipped) */
-            fprintf(source,
+            fprintf(codec,
                     "    if (!skip_body_len_check && unlikely((uint32_t)(len - body_start_len) != expected_body_len)) return -1;\n");
         }
 
-        fprintf(source, "    return len;\n");
-        fprintf(source, "}\n\n");
+        fprintf(codec, "    return len;\n");
+        fprintf(codec, "}\n\n");
 
         if (is_recursive) {
-            fprintf(source, "static int WARN_UNUSED_RESULT\n");
+            fprintf(codec, "static int WARN_UNUSED_RESULT\n");
         } else {
-            fprintf(source, "static FORCE_INLINE int WARN_UNUSED_RESULT\n");
+            fprintf(codec, "static FORCE_INLINE int WARN_UNUSED_RESULT\n");
         }
-        fprintf(source, "__unmarshall_%s_contig(\n", xdr_unionp->name);
-        fprintf(source, "    struct %s *out,\n", xdr_unionp->name);
-        fprintf(source, "    struct xdr_read_cursor *cursor,\n");
-        fprintf(source, "    xdr_dbuf *dbuf) {\n");
-        fprintf(source, "    int rc, len = 0;\n");
+        fprintf(codec, "__unmarshall_%s_contig(\n", xdr_unionp->name);
+        fprintf(codec, "    struct %s *out,\n", xdr_unionp->name);
+        fprintf(codec, "    struct xdr_read_cursor *cursor,\n");
+        fprintf(codec, "    xdr_dbuf *dbuf) {\n");
+        fprintf(codec, "    int rc, len = 0;\n");
 
         if (xdr_unionp->opaque) {
-            fprintf(source, "    uint32_t expected_body_len = 0;\n");
-            fprintf(source, "    int body_start_len = 0;\n");
-            fprintf(source, "    int skip_body_len_check = 0;\n");
+            fprintf(codec, "    uint32_t expected_body_len = 0;\n");
+            fprintf(codec, "    int body_start_len = 0;\n");
+            fprintf(codec, "    int skip_body_len_check = 0;\n");
         }
 
-        emit_unmarshall_contig(source, xdr_unionp->pivot_name, xdr_unionp->pivot_type);
+        emit_unmarshall_contig(codec, xdr_unionp->pivot_name, xdr_unionp->pivot_type);
 
         if (xdr_unionp->opaque) {
             /*
              * For opaque unions, read the body length, but skip for varlen
              * opaque types which have their own length prefix.
              */
-            fprintf(source, "    switch (out->%s) {\n", xdr_unionp->pivot_name);
+            fprintf(codec, "    switch (out->%s) {\n", xdr_unionp->pivot_name);
+
+            varlen_default = 0;
 
             DL_FOREACH(xdr_unionp->cases, xdr_union_casep)
             {
                 if (strcmp(xdr_union_casep->label, "default") != 0) {
-                    if (is_varlen_opaque(xdr_union_casep->type)) {
-                        fprintf(source, "    case %s:\n", xdr_union_casep->label);
-                        fprintf(source, "        skip_body_len_check = 1;\n");
-                        fprintf(source, "        break;\n");
+                    armp = union_case_arm(xdr_unionp, xdr_union_casep);
+                    if (armp && is_varlen_opaque(armp->type)) {
+                        fprintf(codec, "    case %s:\n", xdr_union_casep->label);
+                        fprintf(codec, "        skip_body_len_check = 1;\n");
+                        fprintf(codec, "        break;\n");
                     }
                 }
             }
@@ -2457,37 +5935,41 @@ main(
             DL_FOREACH(xdr_unionp->cases, xdr_union_casep)
             {
                 if (strcmp(xdr_union_casep->label, "default") == 0) {
-                    if (is_varlen_opaque(xdr_union_casep->type)) {
-                        fprintf(source, "    default:\n");
-                        fprintf(source, "        skip_body_len_check = 1;\n");
-                        fprintf(source, "        break;\n");
+                    armp = union_case_arm(xdr_unionp, xdr_union_casep);
+                    if (armp && is_varlen_opaque(armp->type)) {
+                        fprintf(codec, "    default:\n");
+                        fprintf(codec, "        skip_body_len_check = 1;\n");
+                        fprintf(codec, "        break;\n");
+                        varlen_default = 1;
                     }
                 }
             }
 
-            fprintf(source, "    default:\n");
-            fprintf(source, "        break;\n");
-            fprintf(source, "    }\n");
-            fprintf(source, "    if (!skip_body_len_check) {\n");
-            fprintf(source, "        rc = __unmarshall_uint32_t_contig(&expected_body_len, cursor, dbuf);\n");
-            fprintf(source, "        if (unlikely(rc < 0)) return rc;\n");
-            fprintf(source, "        len += rc;\n");
-            fprintf(source, "        body_start_len = len;\n");
-            fprintf(source, "    }\n");
+            if (!varlen_default) {
+                fprintf(codec, "    default:\n");
+                fprintf(codec, "        break;\n");
+            }
+            fprintf(codec, "    }\n");
+            fprintf(codec, "    if (!skip_body_len_check) {\n");
+            fprintf(codec, "        rc = __unmarshall_uint32_t_contig(&expected_body_len, cursor, dbuf);\n");
+            fprintf(codec, "        if (unlikely(rc < 0)) return rc;\n");
+            fprintf(codec, "        len += rc;\n");
+            fprintf(codec, "        body_start_len = len;\n");
+            fprintf(codec, "    }\n");
         }
 
-        fprintf(source, "    switch (out->%s) {\n", xdr_unionp->pivot_name);
+        fprintf(codec, "    switch (out->%s) {\n", xdr_unionp->pivot_name);
 
         DL_FOREACH(xdr_unionp->cases, xdr_union_casep)
         {
             if (strcmp(xdr_union_casep->label, "default") != 0) {
-                fprintf(source, "    case %s:\n", xdr_union_casep->label);
+                fprintf(codec, "    case %s:\n", xdr_union_casep->label);
                 if (xdr_union_casep->voided) {
-                    fprintf(source, "        break;\n");
+                    fprintf(codec, "        break;\n");
                 } else if (xdr_union_casep->type) {
-                    emit_unmarshall_contig(source, xdr_union_casep->name,
+                    emit_unmarshall_contig(codec, xdr_union_casep->name,
                                            xdr_union_casep->type);
-                    fprintf(source, "        break;\n");
+                    fprintf(codec, "        break;\n");
                 }
             }
         }
@@ -2495,32 +5977,64 @@ main(
         DL_FOREACH(xdr_unionp->cases, xdr_union_casep)
         {
             if (strcmp(xdr_union_casep->label, "default") == 0) {
-                fprintf(source, "    default:\n");
+                fprintf(codec, "    default:\n");
                 if (xdr_union_casep->voided) {
-                    fprintf(source, "        break;\n");
+                    fprintf(codec, "        break;\n");
                 } else if (xdr_union_casep->type) {
-                    emit_unmarshall_contig(source, xdr_union_casep->name, xdr_union_casep
+                    emit_unmarshall_contig(codec, xdr_union_casep->name, xdr_union_casep
                                            ->type);
-                    fprintf(source, "        break;\n");
+                    fprintf(codec, "        break;\n");
                 }
             }
         }
 
-        fprintf(source, "    }\n");
+        fprintf(codec, "    }\n");
 
         if (xdr_unionp->opaque) {
             /* Verify consumed bytes match expected length (unless skipped) */
-            fprintf(source,
+            fprintf(codec,
                     "    if (!skip_body_len_check && unlikely((uint32_t)(len - body_start_len) != expected_body_len)) return -1;\n");
         }
 
-        fprintf(source, "    return len;\n");
-        fprintf(source, "}\n\n");
+        fprintf(codec, "    return len;\n");
+        fprintf(codec, "}\n\n");
+
+        emit_wrappers(source, xdr_unionp->name, NULL, xdr_unionp->message, emit_footprints);
 
-        emit_wrappers(source, xdr_unionp->name, NULL);
+        if (xdr_unionp->message) {
+            emit_digest_wrappers(source, xdr_unionp->name);
+            emit_batch_wrappers(source, xdr_unionp->name, NULL);
+        }
 
         emit_dump_union(source, xdr_unionp->name, xdr_unionp);
-        emit_length_union(source, xdr_unionp->name, xdr_unionp);
+        emit_length_union(codec, xdr_unionp->name, xdr_unionp);
+        emit_length_wrapper(source, xdr_unionp->name);
+
+        emit_skip_union(source, xdr_unionp->name, xdr_unionp, "vector");
+        emit_skip_union(source, xdr_unionp->name, xdr_unionp, "contig");
+        emit_skip_wrapper(source, xdr_unionp->name);
+
+        if (emit_validators) {
+            emit_validate_union(source, xdr_unionp->name, xdr_unionp);
+            emit_validate_wrapper(source, xdr_unionp->name);
+        }
+
+        if (emit_footprints) {
+            emit_footprint_union(source, xdr_unionp->name, xdr_unionp, "vector");
+            emit_footprint_union(source, xdr_unionp->name, xdr_unionp, "contig");
+            emit_footprint_wrapper(source, xdr_unionp->name);
+        }
+
+        if (emit_views) {
+            emit_view_union(source, xdr_unionp->name, xdr_unionp);
+        }
+
+        if (emit_resume) {
+            emit_resume_union(source, xdr_unionp->name, xdr_unionp);
+            emit_resume_wrapper(source, xdr_unionp->name);
+            emit_marshall_resume_union(source, xdr_unionp->name, xdr_unionp);
+            emit_marshall_resume_wrapper(source, xdr_unionp->name);
+        }
     }
 
     if (emit_rpc2) {
@@ -2535,6 +6049,26 @@ main(
 
     fclose(source);
 
+    if (cxx) {
+        fprintf(header, "#pragma GCC diagnostic pop\n\n");
+        fprintf(header, "%s\n", embedded_builtin_cxx_h);
+        fprintf(header, "namespace xdr {\n\n");
+
+        DL_FOREACH(xdr_structs, xdr_structp)
+        {
+            emit_cxx_type(header, xdr_structp->name, xdr_structp);
+        }
+
+        DL_FOREACH(xdr_unions, xdr_unionp)
+        {
+            emit_cxx_type(header, xdr_unionp->name, NULL);
+        }
+
+        fprintf(header, "} // namespace xdr\n");
+
+        fclose(header);
+    }
+
     HASH_CLEAR(hh, xdr_identifiers);
 
     while (xdr_buffers) {
@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "batch_xdr.h"
+
+#define NUM_MSGS 5
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg msgs[NUM_MSGS], out[NUM_MSGS];
+    struct Stamp stamps[NUM_MSGS], stamps_out[NUM_MSGS];
+    xdr_dbuf    *dbuf;
+    xdr_iovec    iov_in, iov_out[32], iov_one[4], iov_data[NUM_MSGS], iov_split[2];
+    uint8_t      buffer[2048], single[256], wire[2048], expected[2048], data[NUM_MSGS][8];
+    uint32_t     lengths[NUM_MSGS], lengths_out[NUM_MSGS];
+    char         names[NUM_MSGS][8];
+    int          i, rc, len, total, niov_out, niov_one, split;
+
+    for (i = 0; i < NUM_MSGS; i++) {
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].xid = 100 + i;
+        snprintf(names[i], sizeof(names[i]), "msg%d", i * 11);
+        xdr_set_str_static(&msgs[i], name, names[i], strlen(names[i]));
+        memset(data[i], 'a' + i, sizeof(data[i]));
+        xdr_iovec_set_data(&iov_data[i], data[i]);
+        xdr_iovec_set_len(&iov_data[i], i + 1);
+        xdr_set_ref(&msgs[i], data, &iov_data[i], 1, i + 1);
+        msgs[i].stamp.seconds  = -i;
+        msgs[i].stamp.nseconds = i * 7;
+        stamps[i]              = msgs[i].stamp;
+    }
+
+    /* The reference is the concatenation of individually encoded values */
+    total = 0;
+
+    for (i = 0; i < NUM_MSGS; i++) {
+        xdr_iovec_set_data(&iov_in, single);
+        xdr_iovec_set_len(&iov_in, sizeof(single));
+        niov_one = 4;
+
+        rc = marshall_MyMsg(&msgs[i], &iov_in, iov_one, &niov_one, NULL, 0);
+        assert(rc > 0);
+
+        len = 0;
+
+        for (int j = 0; j < niov_one; j++) {
+            memcpy(expected + total + len, xdr_iovec_data(&iov_one[j]), xdr_iovec_len(&iov_one[j]));
+            len += xdr_iovec_len(&iov_one[j]);
+        }
+
+        assert(len == rc);
+        lengths[i] = len;
+        total     += len;
+    }
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+    niov_out = 32;
+
+    rc = marshall_MyMsg_batch(msgs, NUM_MSGS, &iov_in, iov_out, &niov_out, NULL, 0, lengths_out);
+    assert(rc == total);
+
+    /* All values share one scratch region: data iovecs plus scratch runs */
+    assert(niov_out == 2 * NUM_MSGS + 1);
+
+    len = 0;
+
+    for (i = 0; i < niov_out; i++) {
+        memcpy(wire + len, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+        len += xdr_iovec_len(&iov_out[i]);
+    }
+
+    assert(len == total);
+    assert(memcmp(wire, expected, total) == 0);
+    assert(memcmp(lengths, lengths_out, sizeof(lengths)) == 0);
+
+    dbuf = xdr_dbuf_alloc(8192);
+
+    /* Decode from one contiguous buffer and from a split chain */
+    for (split = 0; split < total; split += 7) {
+        xdr_dbuf_reset(dbuf);
+        memset(out, 0, sizeof(out));
+        memset(lengths_out, 0, sizeof(lengths_out));
+
+        xdr_iovec_set_data(&iov_split[0], wire);
+
+        if (split == 0) {
+            xdr_iovec_set_len(&iov_split[0], total);
+            rc = unmarshall_MyMsg_batch(out, NUM_MSGS, iov_split, 1, NULL, dbuf, lengths_out);
+        } else {
+            xdr_iovec_set_len(&iov_split[0], split);
+            xdr_iovec_set_data(&iov_split[1], wire + split);
+            xdr_iovec_set_len(&iov_split[1], total - split);
+            rc = unmarshall_MyMsg_batch(out, NUM_MSGS, iov_split, 2, NULL, dbuf, lengths_out);
+        }
+
+        assert(rc == total);
+        assert(memcmp(lengths, lengths_out, sizeof(lengths)) == 0);
+
+        for (i = 0; i < NUM_MSGS; i++) {
+            assert(out[i].xid == 100 + i);
+            assert(out[i].name.len == strlen(names[i]));
+            assert(memcmp(out[i].name.str, names[i], out[i].name.len) == 0);
+            assert(out[i].data.length == i + 1);
+            assert(out[i].stamp.seconds == -i && out[i].stamp.nseconds == i * 7);
+        }
+    }
+
+    /* A batch with a missing tail fails */
+    xdr_iovec_set_len(&iov_split[0], total - 1);
+    rc = unmarshall_MyMsg_batch(out, NUM_MSGS, iov_split, 1, NULL, dbuf, NULL);
+    assert(rc == -1);
+
+    /* Fixed-size values, without per-value lengths */
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+    niov_out = 32;
+
+    rc = marshall_Stamp_batch(stamps, NUM_MSGS, &iov_in, iov_out, &niov_out, NULL, 0, NULL);
+    assert(rc == NUM_MSGS * XDR_WIRE_SIZE_Stamp && niov_out == 1);
+
+    rc = unmarshall_Stamp_batch(stamps_out, NUM_MSGS, iov_out, 1, NULL, dbuf, NULL);
+    assert(rc == NUM_MSGS * XDR_WIRE_SIZE_Stamp);
+
+    for (i = 0; i < NUM_MSGS; i++) {
+        assert(stamps_out[i].seconds == stamps[i].seconds);
+        assert(stamps_out[i].nseconds == stamps[i].nseconds);
+    }
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
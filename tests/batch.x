@@ -0,0 +1,24 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+struct Stamp {
+    int64_t      seconds;
+    unsigned int nseconds;
+};
+
+struct MyMsg {
+    unsigned int xid;
+    string       name<>;
+    zcopaque     data<>;
+    Stamp        stamp;
+};
+
+program BATCH_PROGRAM {
+    version BATCH_V1 {
+        MyMsg
+            BATCH_ECHO(MyMsg) = 1;
+    } = 1;
+} = 400100;
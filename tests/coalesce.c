@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "coalesce_xdr.h"
+
+static int
+marshall_msg(
+    struct MyMsg *msg,
+    uint8_t      *buffer,
+    int           size,
+    xdr_iovec    *iov_out,
+    int           coalesce)
+{
+    struct xdr_write_cursor cursor;
+    xdr_iovec               iov_in;
+    int                     rc;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, size);
+
+    xdr_write_cursor_init(&cursor, &iov_in, iov_out, 16, NULL, 0);
+    xdr_write_cursor_set_coalesce(&cursor, coalesce);
+
+    rc = marshall_MyMsg_cursor(msg, &cursor);
+
+    assert(rc == 0);
+
+    rc = xdr_write_cursor_finish(&cursor);
+
+    assert(rc == 4 + 16 + 4 + 4 + 4 + 3 + 1);
+
+    return cursor.niov;
+} /* marshall_msg */
+
+static void
+flatten(
+    xdr_iovec *iov,
+    int        niov,
+    uint8_t   *out)
+{
+    int i;
+
+    for (i = 0; i < niov; ++i) {
+        memcpy(out, xdr_iovec_data(&iov[i]), xdr_iovec_len(&iov[i]));
+        out += xdr_iovec_len(&iov[i]);
+    }
+} /* flatten */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg msg1, msg2;
+    xdr_dbuf    *dbuf;
+    uint8_t      buffer[256], data[32], plain[64], merged[64];
+    xdr_iovec    iov_plain[16], iov_merged[16], iov_data[3];
+    int          i, rc, niov_plain, niov_merged;
+
+    for (i = 0; i < 32; ++i) {
+        data[i] = i + 1;
+    }
+
+    /* first is described by two iovecs over one contiguous buffer */
+    xdr_iovec_set_data(&iov_data[0], data);
+    xdr_iovec_set_len(&iov_data[0], 5);
+    xdr_iovec_set_data(&iov_data[1], data + 5);
+    xdr_iovec_set_len(&iov_data[1], 11);
+    xdr_iovec_set_data(&iov_data[2], data + 20);
+    xdr_iovec_set_len(&iov_data[2], 3);
+
+    xdr_set_ref(&msg1, first, &iov_data[0], 2, 16);
+    xdr_set_ref(&msg1, empty, &iov_data[2], 0, 0);
+    msg1.value = 99;
+    xdr_set_ref(&msg1, last, &iov_data[2], 1, 3);
+
+    niov_plain = marshall_msg(&msg1, buffer, sizeof(buffer), iov_plain, 0);
+
+    flatten(iov_plain, niov_plain, plain);
+
+    xdr_iovec_set_data(&iov_data[0], data);
+    xdr_iovec_set_len(&iov_data[0], 5);
+    xdr_iovec_set_data(&iov_data[1], data + 5);
+    xdr_iovec_set_len(&iov_data[1], 11);
+
+    niov_merged = marshall_msg(&msg1, buffer + 128, 128, iov_merged, 1);
+
+    flatten(iov_merged, niov_merged, merged);
+
+    assert(memcmp(plain, merged, 36) == 0);
+
+    /*
+     * The two halves of first merge, the runs around the empty payload
+     * merge, and the trailing pad points at the shared zero buffer.
+     */
+    assert(niov_plain == 7);
+    assert(niov_merged == 5);
+    assert(xdr_iovec_data(&iov_merged[1]) == data);
+    assert(xdr_iovec_len(&iov_merged[1]) == 16);
+    assert(xdr_iovec_len(&iov_merged[4]) == 1);
+    assert((uint8_t *) xdr_iovec_data(&iov_merged[4]) < buffer ||
+           (uint8_t *) xdr_iovec_data(&iov_merged[4]) >= buffer + sizeof(buffer));
+
+    dbuf = xdr_dbuf_alloc(1024);
+
+    rc = unmarshall_MyMsg(&msg2, iov_merged, niov_merged, NULL, dbuf);
+
+    assert(rc == 36);
+    assert(msg2.value == 99);
+    assert(msg2.first.length == 16);
+    assert(msg2.empty.length == 0);
+    assert(msg2.last.length == 3);
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+#include <string.h>
+#include <vector>
+
+#include "cxx_xdr.h"
+
+/* Traits are usable in constant expressions */
+static_assert(xdr::wire_size_v<Point> == 8, "Point is 8 bytes");
+static_assert(xdr::has_wire_size<Point>::value, "Point has a constant size");
+static_assert(!xdr::has_wire_size<MyMsg>::value, "MyMsg has no constant size");
+static_assert(xdr::limits<Point>::max_wire_size == 8, "Point is at most 8 bytes");
+static_assert(xdr::limits<Point>::max_dbuf(4) == 0, "Point needs no dbuf");
+static_assert(xdr::limits<MyMsg>::max_wire_size == XDR_UNBOUNDED, "MyMsg is unbounded");
+static_assert(xdr::limits<Body>::max_iov == XDR_MAX_IOV_Body, "limits match the C constants");
+
+static int
+flatten(
+    const xdr_iovec *iov,
+    int              niov,
+    uint8_t         *out)
+{
+    int i, len = 0;
+
+    for (i = 0; i < niov; ++i) {
+        memcpy(out + len, xdr_iovec_data(&iov[i]), xdr_iovec_len(&iov[i]));
+        len += xdr_iovec_len(&iov[i]);
+    }
+
+    return len;
+} /* flatten */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg msg, out;
+    struct Point points[2] = { { 1, -2 }, { 3, 4 } }, origin = { 7, 8 };
+    struct Node  nodes[2];
+    int32_t      words[3] = { 5, 6, 7 };
+    xdr_dbuf    *dbuf;
+    xdr_iovec    iov_in, iov_out[8], iov[2], payload;
+    uint8_t      buffer[1024], wire[1024], wire_c[1024], bytes[40];
+    int          i, rc, len, split, niov_out;
+
+    for (i = 0; i < (int) sizeof(bytes); ++i) {
+        bytes[i] = i;
+    }
+
+    xdr_iovec_set_data(&payload, bytes);
+    xdr_iovec_set_len(&payload, sizeof(bytes));
+
+    memset(&msg, 0, sizeof(msg));
+    msg.kind = KIND_NUM;
+    xdr_set_str_static(&msg, name, "hello", 5);
+    msg.blob.data = (void *) "blob";
+    msg.blob.len  = 4;
+    xdr_set_ref(&msg, data, &payload, 1, sizeof(bytes));
+    msg.num_words  = 3;
+    msg.words      = words;
+    msg.num_points = 2;
+    msg.points     = points;
+    msg.origin     = &origin;
+
+    for (i = 0; i < 2; ++i) {
+        xdr_set_str_static(&nodes[i], label, i ? "tail" : "head", 4);
+        nodes[i].next = i ? NULL : &nodes[1];
+    }
+
+    msg.list      = nodes;
+    msg.body.kind = KIND_TEXT;
+    xdr_set_str_static(&msg.body, text, "text", 4);
+
+    /* The inlined C++ encoder produces exactly what marshall_MyMsg() does */
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+    niov_out = 8;
+    rc       = xdr::encode(msg, &iov_in, iov_out, &niov_out);
+    assert(rc > 0);
+    assert(rc == xdr::length(msg));
+    assert(rc == marshall_length_MyMsg(&msg));
+    len = flatten(iov_out, niov_out, wire);
+    assert(len == rc);
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+    niov_out = 8;
+    assert(marshall_MyMsg(&msg, &iov_in, iov_out, &niov_out, NULL, 0) == len);
+    assert(flatten(iov_out, niov_out, wire_c) == len);
+    assert(memcmp(wire, wire_c, len) == 0);
+
+    /* Trailing arguments follow marshall_MyMsg(): rdma_chunk, then out_offset */
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+    niov_out = 8;
+    rc       = xdr::encode(msg, &iov_in, iov_out, &niov_out, nullptr, 8);
+    assert(rc == len + 8);
+    assert(flatten(iov_out, niov_out, wire_c) == rc);
+    assert(memcmp(wire, wire_c + 8, len) == 0);
+
+    assert(xdr::length(origin) == 8);
+
+    dbuf = xdr_dbuf_alloc(64 * 1024);
+
+    /* Contiguous input takes the contig decoder, split input the vector one */
+    for (split = 0; split < len; split++) {
+        xdr_dbuf_reset(dbuf);
+        memset(&out, 0, sizeof(out));
+
+        xdr_iovec_set_data(&iov[0], wire);
+
+        if (split == 0) {
+            xdr_iovec_set_len(&iov[0], len);
+            rc = xdr::decode(out, iov, 1, dbuf);
+        } else {
+            xdr_iovec_set_len(&iov[0], split);
+            xdr_iovec_set_data(&iov[1], wire + split);
+            xdr_iovec_set_len(&iov[1], len - split);
+            rc = xdr::decode(out, iov, 2, dbuf);
+        }
+
+        assert(rc == len);
+        assert(out.kind == KIND_NUM);
+        assert(xdr::view(out.name) == "hello");
+        assert(out.data.length == sizeof(bytes));
+        assert(out.num_points == 2 && out.points[0].y == -2 && out.points[1].x == 3);
+        assert(out.origin && out.origin->x == 7 && out.origin->y == 8);
+        assert(out.list && out.list->next && !out.list->next->next);
+        assert(xdr::view(out.list->next->label) == "tail");
+        assert(out.body.kind == KIND_TEXT && xdr::view(out.body.text) == "text");
+
+#ifdef XDR_HAVE_SPAN
+        assert(xdr::view(out.blob).size() == 4 && xdr::view(out.blob)[3] == 'b');
+        assert(xdr::view(out.words, out.num_words)[2] == 7);
+        assert(xdr::view(out.data).size() == (size_t) out.data.niov);
+#endif /* ifdef XDR_HAVE_SPAN */
+    }
+
+    /* Decoders can also be picked explicitly on a caller's cursor */
+    {
+        struct xdr_read_cursor cursor;
+
+        xdr_dbuf_reset(dbuf);
+        xdr_iovec_set_data(&iov[0], wire);
+        xdr_iovec_set_len(&iov[0], len);
+        xdr_read_cursor_contig_init(&cursor, iov, NULL);
+        assert(xdr::decode<xdr::contig_cursor>(out, &cursor, dbuf) == len);
+
+        xdr_read_cursor_vector_init(&cursor, iov, 1, NULL);
+        assert(xdr::decode<xdr::vector_cursor>(out, &cursor, dbuf) == len);
+        assert(xdr::view(out.name) == "hello");
+    }
+
+    /* Truncated input fails as with unmarshall_MyMsg() */
+    xdr_iovec_set_len(&iov[0], len - 4);
+    assert(xdr::decode(out, iov, 1, dbuf) == -1);
+
+    /* pmr containers allocate from the dbuf, within its quota */
+    {
+        xdr::dbuf_resource   resource(dbuf);
+        std::pmr::vector<int> v(&resource);
+        int                   used, threw = 0;
+
+        xdr_dbuf_reset(dbuf);
+        v.reserve(16);
+        v.push_back(42);
+        assert(dbuf->used >= 16 * (int) sizeof(int));
+        assert(resource.dbuf() == dbuf);
+
+        used = dbuf->used;
+        xdr_dbuf_set_quota(dbuf, 64);
+
+        try {
+            std::pmr::vector<int> big(1024, 0, &resource);
+        } catch (const std::bad_alloc &) {
+            threw = 1;
+        }
+
+        assert(threw);
+        assert(dbuf->used == used);
+        xdr_dbuf_set_quota(dbuf, 0);
+    }
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
@@ -0,0 +1,39 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+enum Kind {
+    KIND_TEXT = 1,
+    KIND_NUM  = 2
+};
+
+struct Point {
+    int          x;
+    int          y;
+};
+
+struct Node {
+    string       label<>;
+    Node        *next;
+};
+
+union Body switch (Kind kind) {
+ case KIND_TEXT:
+    string text<>;
+ case KIND_NUM:
+    uint64_t num;
+};
+
+struct MyMsg {
+    Kind         kind;
+    string       name<16>;
+    opaque       blob<>;
+    zcopaque     data<>;
+    int          words<8>;
+    Point        points<>;
+    Point       *origin;
+    Node        *list;
+    Body         body;
+};
@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "dbuf_chain_xdr.h"
+
+#define NUM_ENTRIES 50
+#define NUM_VALUES  300
+
+static int chunk_allocs, chunk_frees;
+
+static void *
+test_chunk_alloc(
+    int   bytes,
+    void *private_data)
+{
+    assert(private_data == &chunk_allocs);
+    chunk_allocs++;
+    return malloc(bytes);
+} /* test_chunk_alloc */
+
+static void
+test_chunk_free(
+    void *chunk,
+    int   bytes,
+    void *private_data)
+{
+    assert(private_data == &chunk_allocs);
+    chunk_frees++;
+    free(chunk);
+} /* test_chunk_free */
+
+static void
+check_msg(const struct MyMsg *msg)
+{
+    int i;
+
+    assert(msg->num_entries == NUM_ENTRIES);
+    assert(msg->num_values == NUM_VALUES);
+
+    for (i = 0; i < NUM_ENTRIES; ++i) {
+        assert(msg->entries[i].id == i);
+        assert(msg->entries[i].name.len == 4);
+        assert(memcmp(msg->entries[i].name.str, "name", 4) == 0);
+    }
+
+    for (i = 0; i < NUM_VALUES; ++i) {
+        assert(msg->values[i] == (uint64_t) i << 32);
+    }
+} /* check_msg */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg   msg1, msg2;
+    struct MyEntry entries[NUM_ENTRIES];
+    uint64_t       values[NUM_VALUES];
+    xdr_dbuf      *dbuf;
+    uint8_t        buffer[8192];
+    xdr_iovec      iov_in, iov_out;
+    void          *first;
+    int            i, rc, len, one = 1;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    for (i = 0; i < NUM_ENTRIES; ++i) {
+        entries[i].id = i;
+        xdr_set_str_static(&entries[i], name, "name", 4);
+    }
+
+    for (i = 0; i < NUM_VALUES; ++i) {
+        values[i] = (uint64_t) i << 32;
+    }
+
+    msg1.num_entries = NUM_ENTRIES;
+    msg1.entries     = entries;
+    msg1.num_values  = NUM_VALUES;
+    msg1.values      = values;
+
+    len = marshall_MyMsg(&msg1, &iov_in, &iov_out, &one, NULL, 0);
+
+    assert(len > 0);
+
+    /* Without chaining an undersized dbuf fails as before */
+    dbuf = xdr_dbuf_alloc(256);
+
+    rc = unmarshall_MyMsg(&msg2, &iov_out, one, NULL, dbuf);
+
+    assert(rc < 0);
+
+    xdr_dbuf_reset(dbuf);
+
+    first = dbuf->buffer;
+
+    xdr_dbuf_set_chunk_allocator(dbuf, 512, test_chunk_alloc, test_chunk_free, &chunk_allocs);
+
+    /* A chunk too large to size with its header is refused before allocating */
+    assert(xdr_dbuf_alloc_space(INT32_MAX - 4, dbuf) == NULL);
+    assert(chunk_allocs == 0);
+
+    rc = unmarshall_MyMsg(&msg2, &iov_out, one, NULL, dbuf);
+
+    assert(rc == len);
+    assert(chunk_allocs > 1);
+    assert(chunk_frees == 0);
+
+    check_msg(&msg2);
+
+    /* Reset keeps the first buffer and returns the rest */
+    xdr_dbuf_reset(dbuf);
+
+    assert(chunk_frees == chunk_allocs);
+    assert(dbuf->buffer == first);
+    assert(dbuf->used == 0);
+
+    rc = unmarshall_MyMsg(&msg2, &iov_out, one, NULL, dbuf);
+
+    assert(rc == len);
+
+    check_msg(&msg2);
+
+    xdr_dbuf_free(dbuf);
+
+    assert(chunk_frees == chunk_allocs);
+
+    return 0;
+} /* main */
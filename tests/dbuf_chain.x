@@ -0,0 +1,15 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+struct MyEntry {
+    unsigned int id;
+    string       name;
+};
+
+struct MyMsg {
+    MyEntry      entries<>;
+    uint64_t     values<>;
+};
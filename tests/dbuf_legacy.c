@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "dbuf_legacy_xdr.h"
+
+#if XDR_DBUF_EXTENDED
+#error "a dbuf without XDR_DBUF_LAYOUT must get the single arena helpers"
+#endif /* if XDR_DBUF_EXTENDED */
+
+#define NUM_ENTRIES 50
+#define NUM_VALUES  300
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg   msg1, msg2;
+    struct MyEntry entries[NUM_ENTRIES];
+    uint64_t       values[NUM_VALUES];
+    xdr_dbuf       dbuf;
+    uint8_t        buffer[8192];
+    xdr_iovec      iov_in, iov_out;
+    int            i, rc, len, one = 1;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    for (i = 0; i < NUM_ENTRIES; ++i) {
+        entries[i].id = i;
+        xdr_set_str_static(&entries[i], name, "name", 4);
+    }
+
+    for (i = 0; i < NUM_VALUES; ++i) {
+        values[i] = (uint64_t) i << 32;
+    }
+
+    msg1.num_entries = NUM_ENTRIES;
+    msg1.entries     = entries;
+    msg1.num_values  = NUM_VALUES;
+    msg1.values      = values;
+
+    len = marshall_MyMsg(&msg1, &iov_in, &iov_out, &one, NULL, 0);
+
+    assert(len > 0);
+
+    /* Fields of the application's own are left alone */
+    dbuf.tag = 42;
+
+    /* An undersized dbuf fails, there is nothing to chain */
+    xdr_dbuf_init(&dbuf, 256);
+
+    rc = unmarshall_MyMsg(&msg2, &iov_out, one, NULL, &dbuf);
+
+    assert(rc < 0);
+
+    xdr_dbuf_destroy(&dbuf);
+
+    xdr_dbuf_init(&dbuf, 16384);
+
+    rc = unmarshall_MyMsg(&msg2, &iov_out, one, NULL, &dbuf);
+
+    assert(rc == len);
+    assert(dbuf.used > 0);
+    assert(msg2.num_entries == NUM_ENTRIES);
+    assert(msg2.num_values == NUM_VALUES);
+
+    for (i = 0; i < NUM_ENTRIES; ++i) {
+        assert(msg2.entries[i].id == i);
+        assert(memcmp(msg2.entries[i].name.str, "name", 4) == 0);
+    }
+
+    for (i = 0; i < NUM_VALUES; ++i) {
+        assert(msg2.values[i] == (uint64_t) i << 32);
+    }
+
+    xdr_dbuf_reset(&dbuf);
+
+    assert(dbuf.used == 0);
+    assert(dbuf.tag == 42);
+
+    xdr_dbuf_destroy(&dbuf);
+
+    return 0;
+} /* main */
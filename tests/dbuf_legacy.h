@@ -0,0 +1,19 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#pragma once
+
+/*
+ * An application supplied dbuf with only the original single arena
+ * fields, force included ahead of every source file of the dbuf_legacy
+ * test so the generated source sees the same definition.
+ */
+#define XDR_DBUF_DEFINED
+struct xdr_dbuf {
+    int   tag;
+    void *buffer;
+    int   size;
+    int   used;
+};
+typedef struct xdr_dbuf xdr_dbuf;
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+#include <pthread.h>
+
+#include "dbuf_pool_xdr.h"
+
+#define NUM_DBUFS 64
+
+static xdr_dbuf *handoff[NUM_DBUFS];
+
+static void *
+remote_release(void *arg)
+{
+    struct xdr_dbuf_cache *cache;
+    int                    i;
+
+    /* The releasing thread has a cache of its own */
+    cache = xdr_dbuf_cache_create(4);
+
+    for (i = 0; i < NUM_DBUFS; ++i) {
+        xdr_dbuf_cache_put(cache, handoff[i]);
+    }
+
+    xdr_dbuf_cache_destroy(cache);
+
+    return NULL;
+} /* remote_release */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct xdr_dbuf_cache *cache;
+    struct MyMsg           msg1, msg2;
+    uint32_t               values[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    xdr_dbuf              *dbuf, *big;
+    uint8_t                buffer[256];
+    xdr_iovec              iov_in, iov_out;
+    pthread_t              thread;
+    int                    i, j, rc, found, one = 1;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    xdr_set_str_static(&msg1, name, "pooled", 6);
+    msg1.num_values = 8;
+    msg1.values     = values;
+
+    rc = marshall_MyMsg(&msg1, &iov_in, &iov_out, &one, NULL, 0);
+
+    assert(rc > 0);
+
+    cache = xdr_dbuf_cache_create(NUM_DBUFS);
+
+    /* Local get/put recycles the same dbuf */
+    dbuf = xdr_dbuf_cache_get(cache, 1000);
+
+    assert(dbuf && dbuf->size >= 1000);
+
+    rc = unmarshall_MyMsg(&msg2, &iov_out, one, NULL, dbuf);
+
+    assert(rc > 0);
+    assert(msg2.num_values == 8 && msg2.values[7] == 8);
+
+    xdr_dbuf_cache_put(cache, dbuf);
+
+    assert(xdr_dbuf_cache_get(cache, 1000) == dbuf);
+    assert(dbuf->used == 0);
+
+    /* Chunk allocator and quota do not survive a trip through the pool */
+    xdr_dbuf_set_chunk_allocator(dbuf, 4096, NULL, NULL, &one);
+    xdr_dbuf_set_quota(dbuf, 16);
+
+    xdr_dbuf_cache_put(cache, dbuf);
+
+    assert(xdr_dbuf_cache_get(cache, 1000) == dbuf);
+    assert(dbuf->chunk_alloc == NULL && dbuf->chunk_private == NULL);
+    assert(dbuf->chunk_size == 0 && dbuf->quota == 0);
+
+    rc = unmarshall_MyMsg(&msg2, &iov_out, one, NULL, dbuf);
+
+    assert(rc > 0);
+
+    xdr_dbuf_cache_put(cache, dbuf);
+
+    /* Oversized requests bypass the pool */
+    big = xdr_dbuf_cache_get(cache, 64 * 1024 * 1024);
+
+    assert(big && big->size >= 64 * 1024 * 1024);
+
+    xdr_dbuf_cache_put(cache, big);
+
+    /* dbufs released on another thread return to the owner */
+    for (i = 0; i < NUM_DBUFS; ++i) {
+        handoff[i] = xdr_dbuf_cache_get(cache, 8192);
+        assert(handoff[i]);
+    }
+
+    rc = pthread_create(&thread, NULL, remote_release, NULL);
+
+    assert(rc == 0);
+
+    pthread_join(thread, NULL);
+
+    for (i = 0; i < NUM_DBUFS; ++i) {
+        dbuf  = xdr_dbuf_cache_get(cache, 8192);
+        found = 0;
+
+        for (j = 0; j < NUM_DBUFS; ++j) {
+            if (handoff[j] == dbuf) {
+                handoff[j] = NULL;
+                found      = 1;
+            }
+        }
+
+        assert(found);
+
+        handoff[i] = dbuf;
+    }
+
+    /* Outstanding dbufs may be returned after the owner is gone */
+    xdr_dbuf_cache_destroy(cache);
+
+    rc = pthread_create(&thread, NULL, remote_release, NULL);
+
+    assert(rc == 0);
+
+    pthread_join(thread, NULL);
+
+    return 0;
+} /* main */
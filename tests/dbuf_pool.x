@@ -0,0 +1,10 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+struct MyMsg {
+    string       name;
+    unsigned int values<>;
+};
@@ -0,0 +1,205 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "digest_xdr.h"
+
+/* Bit at a time, to check the table and instruction kernels against */
+static uint32_t
+crc32c_reference(
+    const uint8_t *p,
+    size_t         len)
+{
+    uint32_t crc = ~0U;
+    int      k;
+
+    for (; len; len--) {
+        crc ^= *p++;
+
+        for (k = 0; k < 8; k++) {
+            crc = crc & 1 ? (crc >> 1) ^ XDR_CRC32C_POLY : crc >> 1;
+        }
+    }
+
+    return ~crc;
+} /* crc32c_reference */
+
+/* Every length up to a few words at every alignment */
+static void
+check_crc32c(void)
+{
+    uint8_t buf[300];
+    size_t  off, len;
+
+    for (off = 0; off < sizeof(buf); off++) {
+        buf[off] = off * 37 + 11;
+    }
+
+    for (off = 0; off < 8; off++) {
+        for (len = 0; len + off <= sizeof(buf); len += len < 64 ? 1 : 29) {
+            assert(xdr_crc32c(0, buf + off, len) == crc32c_reference(buf + off, len));
+        }
+    }
+} /* check_crc32c */
+
+static void
+check_msg(const struct MyMsg *msg)
+{
+    assert(msg->xid == 7);
+    assert(msg->name.len == 6 && memcmp(msg->name.str, "digest", 6) == 0);
+    assert(msg->data.length == 13 && msg->data.niov >= 1);
+    assert(msg->body.kind == KIND_PAYLOAD);
+    assert(msg->body.payload.id == 9);
+    assert(msg->body.payload.data.length == 21);
+    assert(msg->trailer == 0x0102030405060708ULL);
+} /* check_msg */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg            msg, msg_out;
+    struct xdr_write_cursor wcursor;
+    struct xdr_read_cursor  rcursor;
+    xdr_dbuf               *dbuf;
+    xdr_iovec               iov_in, iov_out[16], iov_data, iov_payload, iov_split[512];
+    uint8_t                 buffer[1024], wire[1024], stream[2048];
+    uint8_t                 data[13], payload[21];
+    uint32_t                crc, digest, expected;
+    int                     i, rc, len, slen, split, niov, niov_out;
+
+    /* Reference values */
+    assert(xdr_crc32c(0, "123456789", 9) == 0xe3069283);
+    assert(xdr_crc32c(xdr_crc32c(0, "1234", 4), "56789", 5) == 0xe3069283);
+    assert(xdr_crc32c(0, "", 0) == 0);
+
+    check_crc32c();
+
+#ifdef XDR_CRC32C_SOFT
+    /* Also the slicing-by-8 table, which a CPU with SSE4.2 would not use */
+    xdr_crc32c_impl = XDR_CRC32C_UNKNOWN;
+    assert(xdr_crc32c_build_table() == XDR_CRC32C_TABLE);
+    check_crc32c();
+    xdr_crc32c_impl = XDR_CRC32C_UNKNOWN;
+#endif /* ifdef XDR_CRC32C_SOFT */
+
+    dbuf = xdr_dbuf_alloc(8192);
+
+    for (i = 0; i < (int) sizeof(data); i++) {
+        data[i] = 3 * i;
+    }
+
+    for (i = 0; i < (int) sizeof(payload); i++) {
+        payload[i] = 0xa0 + i;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+
+    msg.xid = 7;
+    xdr_set_str_static(&msg, name, "digest", 6);
+    xdr_iovec_set_data(&iov_data, data);
+    xdr_iovec_set_len(&iov_data, sizeof(data));
+    xdr_set_ref(&msg, data, &iov_data, 1, sizeof(data));
+
+    /* The body length is back-patched after its payload was emitted */
+    msg.body.kind           = KIND_PAYLOAD;
+    msg.body.payload.id     = 9;
+    xdr_iovec_set_data(&iov_payload, payload);
+    xdr_iovec_set_len(&iov_payload, sizeof(payload));
+    xdr_set_ref(&msg.body.payload, data, &iov_payload, 1, sizeof(payload));
+    msg.trailer = 0x0102030405060708ULL;
+
+    /* Bytes reserved with out_offset are not part of the digest */
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+    memset(buffer, 0x55, 8);
+    niov_out = 16;
+
+    rc = marshall_MyMsg_digest(&msg, &iov_in, iov_out, &niov_out, NULL, 8, &digest);
+    assert(rc > 0);
+
+    len = 0;
+
+    for (i = 0; i < niov_out; ++i) {
+        memcpy(wire + len, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+        len += xdr_iovec_len(&iov_out[i]);
+    }
+
+    assert(len == rc);
+    len -= 8;
+    memmove(wire, wire + 8, len);
+
+    expected = xdr_crc32c(0, wire, len);
+    assert(digest == expected);
+
+    /* Coalesced output, where pads may reference static memory */
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    xdr_write_cursor_init(&wcursor, &iov_in, iov_out, 16, NULL, 0);
+    xdr_write_cursor_set_coalesce(&wcursor, 1);
+    xdr_write_cursor_set_digest(&wcursor, 1);
+
+    rc = marshall_MyMsg_cursor(&msg, &wcursor);
+    assert(rc == 0);
+
+    rc = xdr_write_cursor_finish(&wcursor);
+    assert(rc == len);
+    assert(xdr_write_cursor_digest(&wcursor) == expected);
+
+    /* The reader folds in the same bytes however they are split */
+    for (split = 1; split <= len; split++) {
+        for (niov = 0; niov * split < len; niov++) {
+            xdr_iovec_set_data(&iov_split[niov], wire + niov * split);
+            xdr_iovec_set_len(&iov_split[niov], len - niov * split < split ? len - niov * split : split);
+        }
+
+        xdr_dbuf_reset(dbuf);
+
+        rc = unmarshall_MyMsg_digest(&msg_out, iov_split, niov, NULL, dbuf, &crc);
+        assert(rc == len);
+        assert(crc == expected);
+        check_msg(&msg_out);
+    }
+
+    /* Record marked input, with headers excluded */
+    slen = 0;
+
+    for (i = 0; i < len; i += 10) {
+        uint32_t frag = len - i < 10 ? len - i : 10;
+
+        if (i + frag == (uint32_t) len) {
+            frag |= 0x80000000;
+        }
+
+        stream[slen++] = frag >> 24;
+        stream[slen++] = frag >> 16;
+        stream[slen++] = frag >> 8;
+        stream[slen++] = frag;
+
+        memcpy(stream + slen, wire + i, frag & 0x7fffffff);
+        slen += frag & 0x7fffffff;
+    }
+
+    xdr_iovec_set_data(&iov_split[0], stream);
+    xdr_iovec_set_len(&iov_split[0], slen);
+
+    xdr_dbuf_reset(dbuf);
+
+    rc = xdr_read_cursor_record_init(&rcursor, iov_split, 1, NULL);
+    assert(rc == 0);
+
+    xdr_read_cursor_set_digest(&rcursor, 1);
+
+    rc = unmarshall_MyMsg_cursor(&msg_out, &rcursor, dbuf);
+    assert(rc == len);
+    assert(xdr_read_cursor_digest(&rcursor) == expected);
+    check_msg(&msg_out);
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
@@ -0,0 +1,32 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+enum Kind {
+    KIND_PAYLOAD = 1,
+    KIND_NAME    = 2
+};
+
+struct Payload {
+    unsigned int id;
+    zcopaque     data<>;
+};
+
+opaque_union Body switch (Kind kind) {
+ case KIND_PAYLOAD:
+    Payload payload;
+ case KIND_NAME:
+    string name<>;
+ default:
+    void;
+};
+
+struct MyMsg {
+    unsigned int xid;
+    string       name<>;
+    zcopaque     data<>;
+    Body         body;
+    uint64_t     trailer;
+};
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "fixed_run_xdr.h"
+
+_Static_assert(XDR_WIRE_SIZE_Stamp == 12, "Stamp wire size");
+_Static_assert(XDR_WIRE_SIZE_Fixed == 4 + 6 + 12 + 4 + 4 + 4 + 8 + 8 + 24, "Fixed wire size");
+
+static void
+check_mixed(const struct Mixed *msg)
+{
+    assert(msg->a == 1);
+    assert(msg->b == 0x1122334455667788ULL);
+    assert(msg->name.len == 5 && memcmp(msg->name.str, "mixed", 5) == 0);
+    assert(msg->fixed.seqid == 7);
+    assert(memcmp(msg->fixed.tag, "tag6xx", 6) == 0);
+    assert(msg->fixed.stamp.seconds == -5 && msg->fixed.stamp.nseconds == 999);
+    assert(msg->fixed.color == GREEN);
+    assert(msg->fixed.flag == 1);
+    assert(msg->fixed.ratio == 0.5f);
+    assert(msg->fixed.scale == 2.25);
+    assert(msg->fixed.verf[0] == 0xdeadbeef && msg->fixed.verf[1] == 0xfeedface);
+    assert(msg->fixed.stamps[1].seconds == 42 && msg->fixed.stamps[1].nseconds == 43);
+    assert(msg->tail == 0xabcdef01);
+} /* check_mixed */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct Mixed msg, out;
+    xdr_dbuf    *dbuf;
+    xdr_iovec    iov_in, iov_out[4], iov_split[2];
+    uint8_t      buffer[256], wire[256];
+    int          rc, len, niov_out, split;
+
+    memset(&msg, 0, sizeof(msg));
+
+    msg.a = 1;
+    msg.b = 0x1122334455667788ULL;
+    xdr_set_str_static(&msg, name, "mixed", 5);
+    msg.fixed.seqid = 7;
+    memcpy(msg.fixed.tag, "tag6xx", 6);
+    msg.fixed.stamp.seconds    = -5;
+    msg.fixed.stamp.nseconds   = 999;
+    msg.fixed.color            = GREEN;
+    msg.fixed.flag             = 1;
+    msg.fixed.ratio            = 0.5f;
+    msg.fixed.scale            = 2.25;
+    msg.fixed.verf[0]          = 0xdeadbeef;
+    msg.fixed.verf[1]          = 0xfeedface;
+    msg.fixed.stamps[1].seconds  = 42;
+    msg.fixed.stamps[1].nseconds = 43;
+    msg.tail                     = 0xabcdef01;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+    niov_out = 4;
+
+    rc = marshall_Mixed(&msg, &iov_in, iov_out, &niov_out, NULL, 0);
+    assert(rc > 0 && niov_out == 1);
+
+    len = rc;
+    assert(len == 4 + 8 + 4 + 8 + XDR_WIRE_SIZE_Fixed + 4);
+    assert(marshall_length_Mixed(&msg) == len);
+
+    memcpy(wire, buffer, len);
+
+    dbuf = xdr_dbuf_alloc(4096);
+
+    rc = unmarshall_Mixed(&out, iov_out, 1, NULL, dbuf);
+    assert(rc == len);
+    check_mixed(&out);
+
+    /* Split at every position so runs straddle iovec boundaries */
+    for (split = 1; split < len; split++) {
+        xdr_dbuf_reset(dbuf);
+        memset(&out, 0, sizeof(out));
+
+        xdr_iovec_set_data(&iov_split[0], wire);
+        xdr_iovec_set_len(&iov_split[0], split);
+        xdr_iovec_set_data(&iov_split[1], wire + split);
+        xdr_iovec_set_len(&iov_split[1], len - split);
+
+        rc = unmarshall_Mixed(&out, iov_split, 2, NULL, dbuf);
+        assert(rc == len);
+        check_mixed(&out);
+    }
+
+    /* Every truncation is rejected, contiguous or not */
+    for (split = 0; split < len; split++) {
+        xdr_dbuf_reset(dbuf);
+
+        xdr_iovec_set_data(&iov_split[0], wire);
+        xdr_iovec_set_len(&iov_split[0], split);
+
+        rc = unmarshall_Mixed(&out, iov_split, 1, NULL, dbuf);
+        assert(rc == -1);
+
+        if (split > 1) {
+            xdr_iovec_set_len(&iov_split[0], split / 2);
+            xdr_iovec_set_data(&iov_split[1], wire + split / 2);
+            xdr_iovec_set_len(&iov_split[1], split - split / 2);
+
+            rc = unmarshall_Mixed(&out, iov_split, 2, NULL, dbuf);
+            assert(rc == -1);
+        }
+    }
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
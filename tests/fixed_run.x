@@ -0,0 +1,37 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+const TAG_SIZE = 6;
+
+enum Color {
+    RED   = 1,
+    GREEN = 2
+};
+
+struct Stamp {
+    int64_t      seconds;
+    unsigned int nseconds;
+};
+
+struct Fixed {
+    unsigned int seqid;
+    opaque       tag[TAG_SIZE];
+    Stamp        stamp;
+    Color        color;
+    bool         flag;
+    float        ratio;
+    double       scale;
+    unsigned int verf[2];
+    Stamp        stamps[2];
+};
+
+struct Mixed {
+    unsigned int a;
+    uint64_t     b;
+    string       name<>;
+    Fixed        fixed;
+    unsigned int tail;
+};
@@ -0,0 +1,217 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "footprint_xdr.h"
+
+/* Marshall msg and check marshall_requirements_MyMsg() matches what it used */
+static int
+encode(
+    struct MyMsg *msg,
+    uint8_t      *wire,
+    int           out_offset)
+{
+    xdr_iovec iov_in, iov_out[32];
+    uint8_t   buffer[1024];
+    int       i, rc, len, scratch, niov, niov_out = 32;
+
+    scratch = marshall_requirements_MyMsg(msg, out_offset, NULL, &niov);
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    rc = marshall_MyMsg(msg, &iov_in, iov_out, &niov_out, NULL, out_offset);
+    assert(rc > 0);
+    assert(scratch == (int) xdr_iovec_len(&iov_in));
+    assert(niov == niov_out);
+
+    len = 0;
+
+    for (i = 0; i < niov_out; ++i) {
+        if (i == 0) {
+            memcpy(wire, (uint8_t *) xdr_iovec_data(&iov_out[i]) + out_offset,
+                   xdr_iovec_len(&iov_out[i]) - out_offset);
+            len += xdr_iovec_len(&iov_out[i]) - out_offset;
+        } else {
+            memcpy(wire + len, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+            len += xdr_iovec_len(&iov_out[i]);
+        }
+    }
+
+    assert(len == rc - out_offset);
+
+    return len;
+} /* encode */
+
+/* As encode(), through a cursor with a non-default threshold or coalescing */
+static void
+encode_cursor(
+    struct MyMsg *msg,
+    int           out_offset,
+    uint32_t      threshold,
+    int           coalesce)
+{
+    struct xdr_write_cursor    cursor;
+    struct xdr_marshall_config config;
+    xdr_iovec                  iov_in, iov_out[32];
+    uint8_t                    buffer[1024];
+    int                        rc, scratch, niov;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    xdr_marshall_config_init(&config);
+    config.zc_inline_threshold = threshold;
+    config.coalesce            = coalesce;
+
+    scratch = marshall_requirements_MyMsg(msg, out_offset, &config, &niov);
+
+    xdr_write_cursor_init(&cursor, &iov_in, iov_out, 32, NULL, out_offset);
+    xdr_write_cursor_set_zc_inline(&cursor, threshold);
+    xdr_write_cursor_set_coalesce(&cursor, coalesce);
+
+    rc = marshall_MyMsg_cursor(msg, &cursor);
+    assert(rc == 0);
+    assert(xdr_write_cursor_finish(&cursor) > 0);
+
+    assert(scratch == (int) xdr_iovec_len(&iov_in));
+    assert(niov == cursor.niov);
+} /* encode_cursor */
+
+/* The footprint matches the dbuf usage for contig input and every split */
+static void
+check_footprint(
+    uint8_t  *wire,
+    int       len,
+    xdr_dbuf *dbuf)
+{
+    struct MyMsg out;
+    xdr_iovec    iov[2];
+    int          split, niov, footprint;
+
+    for (split = 0; split < len; split++) {
+        xdr_iovec_set_data(&iov[0], wire);
+
+        if (split == 0) {
+            xdr_iovec_set_len(&iov[0], len);
+            niov = 1;
+        } else {
+            xdr_iovec_set_len(&iov[0], split);
+            xdr_iovec_set_data(&iov[1], wire + split);
+            xdr_iovec_set_len(&iov[1], len - split);
+            niov = 2;
+        }
+
+        footprint = unmarshall_footprint_MyMsg(iov, niov, NULL);
+        assert(footprint >= 0);
+
+        xdr_dbuf_reset(dbuf);
+        assert(unmarshall_MyMsg(&out, iov, niov, NULL, dbuf) == len);
+        assert(footprint == dbuf->used);
+
+        /* A quota of exactly the footprint is enough */
+        xdr_dbuf_set_quota(dbuf, footprint ? footprint : 1);
+        assert(unmarshall_MyMsg(&out, iov, niov, NULL, dbuf) == len);
+        xdr_dbuf_set_quota(dbuf, 0);
+    }
+
+    /* Truncated input has no footprint */
+    xdr_iovec_set_data(&iov[0], wire);
+    xdr_iovec_set_len(&iov[0], len - 4);
+    assert(unmarshall_footprint_MyMsg(iov, 1, NULL) == -1);
+} /* check_footprint */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg msg;
+    struct Chunk chunks[2], extra;
+    struct Node  nodes[2];
+    struct Body  bodies[2];
+    int32_t      words[3] = { 1, 2, 3 };
+    xdr_dbuf    *dbuf;
+    xdr_iovec    payload[3], single;
+    uint8_t      wire[1024], bytes[64];
+    uint32_t     threshold;
+    int          i, len, out_offset;
+
+    for (i = 0; i < (int) sizeof(bytes); ++i) {
+        bytes[i] = i;
+    }
+
+    /* A 23 byte payload spread over three iovecs */
+    xdr_iovec_set_data(&payload[0], bytes);
+    xdr_iovec_set_len(&payload[0], 5);
+    xdr_iovec_set_data(&payload[1], bytes + 5);
+    xdr_iovec_set_len(&payload[1], 11);
+    xdr_iovec_set_data(&payload[2], bytes + 16);
+    xdr_iovec_set_len(&payload[2], 7);
+    xdr_iovec_set_data(&single, bytes + 32);
+    xdr_iovec_set_len(&single, 9);
+
+    dbuf = xdr_dbuf_alloc(64 * 1024);
+
+    /* Mostly empty: nothing but scalars and empty vectors */
+    memset(&msg, 0, sizeof(msg));
+    xdr_set_str_static(&msg, name, "", 0);
+    msg.body.kind = KIND_NUM;
+    msg.body.num  = 42;
+
+    for (out_offset = 0; out_offset <= 16; out_offset += 16) {
+        len = encode(&msg, wire, out_offset);
+        check_footprint(wire, len, dbuf);
+    }
+
+    /* Everything populated, with payloads landing between scratch runs */
+    xdr_set_str_static(&msg, name, "footprint", 9);
+    msg.blob.data = "blob";
+    msg.blob.len  = 4;
+    memcpy(msg.tag, "tagtag", 6);
+    xdr_set_ref(&msg, data, payload, 3, 23);
+    msg.num_words = 3;
+    msg.words     = words;
+
+    for (i = 0; i < 2; ++i) {
+        chunks[i].id = i;
+        xdr_set_ref(&chunks[i], data, i ? &single : payload, i ? 1 : 3, i ? 9 : 23);
+        xdr_set_str_static(&nodes[i], label, i ? "tail" : "head", 4);
+        nodes[i].next = i ? NULL : &nodes[1];
+    }
+
+    msg.num_chunks = 2;
+    msg.chunks     = chunks;
+    extra.id       = 9;
+    xdr_set_ref(&extra, data, &single, 1, 4);
+    msg.extra = &extra;
+    msg.list  = nodes;
+
+    msg.body.kind  = KIND_CHUNK;
+    msg.body.chunk = chunks[0];
+
+    bodies[0].kind = KIND_TEXT;
+    xdr_set_str_static(&bodies[0], text, "text", 4);
+    bodies[1].kind  = KIND_CHUNK;
+    bodies[1].chunk = chunks[1];
+
+    msg.num_bodies = 2;
+    msg.bodies     = bodies;
+
+    for (out_offset = 0; out_offset <= 16; out_offset += 16) {
+        len = encode(&msg, wire, out_offset);
+        check_footprint(wire, len, dbuf);
+
+        /* Thresholds inlining none, some and all of the payloads */
+        for (threshold = 0; threshold <= 32; threshold += 8) {
+            encode_cursor(&msg, out_offset, threshold, 0);
+            encode_cursor(&msg, out_offset, threshold, 1);
+        }
+    }
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
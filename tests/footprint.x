@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+enum Kind {
+    KIND_TEXT  = 1,
+    KIND_CHUNK = 2,
+    KIND_NUM   = 3
+};
+
+struct Chunk {
+    unsigned int id;
+    zcopaque     data<>;
+};
+
+struct Node {
+    string       label<>;
+    Node        *next;
+};
+
+opaque_union Body switch (Kind kind) {
+ case KIND_TEXT:
+    string text<>;
+ case KIND_CHUNK:
+    Chunk chunk;
+ case KIND_NUM:
+    uint64_t num;
+};
+
+struct MyMsg {
+    string       name<>;
+    opaque       blob<16>;
+    opaque       tag[6];
+    zcopaque     data<>;
+    int          words<8>;
+    Chunk        chunks<>;
+    Chunk       *extra;
+    Node        *list;
+    Body         body;
+    Body         bodies<>;
+};
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "hash_xdr.h"
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct Entry entry, out;
+    xdr_dbuf    *dbuf;
+    xdr_iovec    iov_in, iov_out[4], iov_split[2];
+    uint8_t      buffer[512], wire[512], handle[40];
+    const char  *name = "a_directory_entry", *owner = "nobody";
+    int          i, rc, len, split, niov_out = 4;
+
+    for (i = 0; i < (int) sizeof(handle); i++) {
+        handle[i] = i * 3;
+    }
+
+    memset(&entry, 0, sizeof(entry));
+    entry.cookie = 0x1122334455667788ULL;
+    xdr_set_str_static(&entry, name, name, strlen(name));
+    entry.handle.len  = sizeof(handle);
+    entry.handle.data = handle;
+    xdr_set_str_static(&entry, owner, owner, strlen(owner));
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    rc = marshall_Entry(&entry, &iov_in, iov_out, &niov_out, NULL, 0);
+    assert(rc > 0);
+
+    len = 0;
+
+    for (i = 0; i < niov_out; i++) {
+        memcpy(wire + len, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+        len += xdr_iovec_len(&iov_out[i]);
+    }
+
+    assert(len == rc);
+
+    /* Equal keys hash equally, and every byte contributes */
+    assert(xdr_hash(name, strlen(name)) == xdr_hash("a_directory_entry", 17));
+    assert(xdr_hash(name, strlen(name)) != xdr_hash("a_directory_entrz", 17));
+    assert(xdr_hash(name, 8) != xdr_hash(name, 9));
+    assert(xdr_hash("", 0) != xdr_hash("\0", 1));
+
+    dbuf = xdr_dbuf_alloc(8192);
+
+    /* Hashes are stored on the contiguous path and across every split */
+    for (split = 0; split < len; split++) {
+        xdr_dbuf_reset(dbuf);
+        memset(&out, 0, sizeof(out));
+
+        xdr_iovec_set_data(&iov_split[0], wire);
+
+        if (split == 0) {
+            xdr_iovec_set_len(&iov_split[0], len);
+            rc = unmarshall_Entry(&out, iov_split, 1, NULL, dbuf);
+        } else {
+            xdr_iovec_set_len(&iov_split[0], split);
+            xdr_iovec_set_data(&iov_split[1], wire + split);
+            xdr_iovec_set_len(&iov_split[1], len - split);
+            rc = unmarshall_Entry(&out, iov_split, 2, NULL, dbuf);
+        }
+
+        assert(rc == len);
+        assert(out.cookie == entry.cookie);
+        assert(out.name.len == strlen(name));
+        assert(memcmp(out.name.str, name, out.name.len) == 0);
+        assert(out.name_hash == xdr_hash(name, strlen(name)));
+        assert(out.handle.len == sizeof(handle));
+        assert(memcmp(out.handle.data, handle, sizeof(handle)) == 0);
+        assert(out.handle_hash == xdr_hash(handle, sizeof(handle)));
+        assert(out.owner.len == strlen(owner));
+    }
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
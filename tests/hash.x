@@ -0,0 +1,17 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+typedef string component4<>;
+typedef opaque fhandle4<>;
+
+struct Entry {
+    uint64_t       cookie;
+%xdrzcc hash
+    component4     name;
+%xdrzcc hash
+    fhandle4       handle;
+    string         owner<>;
+};
@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "max_size_xdr.h"
+
+_Static_assert(XDR_MAX_WIRE_SIZE_Stamp == XDR_WIRE_SIZE_Stamp, "fixed size");
+_Static_assert(XDR_MAX_IOV_Stamp == 1, "one scratch run");
+_Static_assert(XDR_MAX_WIRE_SIZE_Item == 4 + 4 + MAX_NAME, "Item wire size");
+_Static_assert(XDR_MAX_WIRE_SIZE_Choice == 4 + XDR_MAX_WIRE_SIZE_Item, "Choice wire size");
+_Static_assert(XDR_MAX_WIRE_SIZE_MyMsg == 20 + 6 + 12 + 4 + 3 * 24 + 4 + 8 + 28 + 4 + 4 * 4, "MyMsg wire size");
+_Static_assert(XDR_MAX_IOV_MyMsg == 1 + 1 + 8, "MyMsg iovecs");
+_Static_assert(XDR_MAX_WIRE_SIZE_Node == XDR_UNBOUNDED, "list");
+_Static_assert(XDR_MAX_WIRE_SIZE_Open == XDR_UNBOUNDED, "unbounded string");
+_Static_assert(XDR_MAX_IOV_WithList == XDR_UNBOUNDED, "list member");
+_Static_assert(XDR_MAX_DBUF_Open(1) == XDR_UNBOUNDED, "unbounded dbuf");
+
+/* Usable to size buffers at compile time */
+#if XDR_MAX_WIRE_SIZE_MyMsg > 0
+static uint8_t wire[XDR_MAX_WIRE_SIZE_MyMsg];
+#endif /* if XDR_MAX_WIRE_SIZE_MyMsg > 0 */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg msg, out;
+    struct Item  items[3];
+    struct Stamp stamp = { 1, 2 };
+    int32_t      words[4] = { 1, 2, 3, 4 };
+    xdr_dbuf    *dbuf;
+    xdr_iovec    iov_in, iov_out[XDR_MAX_IOV_MyMsg], payload[8], split[XDR_MAX_WIRE_SIZE_MyMsg];
+    uint8_t      buffer[512], bytes[8] = "payload";
+    int          i, rc, len, niov_out = XDR_MAX_IOV_MyMsg;
+
+    /* Every length at its bound, with the payload in single byte iovecs */
+    memset(&msg, 0, sizeof(msg));
+    xdr_set_str_static(&msg, name, "0123456789abcdef", MAX_NAME);
+    memcpy(msg.tag, "tagtag", 6);
+
+    for (i = 0; i < 8; ++i) {
+        xdr_iovec_set_data(&payload[i], bytes + i);
+        xdr_iovec_set_len(&payload[i], 1);
+    }
+
+    xdr_set_ref(&msg, data, payload, 8, 8);
+
+    for (i = 0; i < 3; ++i) {
+        items[i].id = i;
+        xdr_set_str_static(&items[i], label, "fedcba9876543210", MAX_NAME);
+    }
+
+    msg.num_items        = 3;
+    msg.items            = items;
+    msg.stamp            = &stamp;
+    msg.choice.kind      = KIND_ITEM;
+    msg.choice.item      = items[0];
+    msg.num_words        = 4;
+    msg.words            = words;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    rc = marshall_MyMsg(&msg, &iov_in, iov_out, &niov_out, NULL, 0);
+    assert(rc == XDR_MAX_WIRE_SIZE_MyMsg);
+    assert(niov_out == XDR_MAX_IOV_MyMsg);
+
+    len = 0;
+
+    for (i = 0; i < niov_out; ++i) {
+        memcpy(wire + len, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+        len += xdr_iovec_len(&iov_out[i]);
+    }
+
+    dbuf = xdr_dbuf_alloc(64 * 1024);
+
+    /* One iovec per byte is the worst case for the dbuf */
+    for (i = 0; i < len; ++i) {
+        xdr_iovec_set_data(&split[i], wire + i);
+        xdr_iovec_set_len(&split[i], 1);
+    }
+
+    rc = unmarshall_MyMsg(&out, split, len, NULL, dbuf);
+    assert(rc == len);
+    assert(dbuf->used > 0 && dbuf->used <= XDR_MAX_DBUF_MyMsg(len));
+
+    xdr_dbuf_reset(dbuf);
+    rc = unmarshall_MyMsg(&out, split, 1, NULL, dbuf);
+    assert(rc == -1);
+
+    xdr_dbuf_reset(dbuf);
+    xdr_iovec_set_data(&split[0], wire);
+    xdr_iovec_set_len(&split[0], len);
+    rc = unmarshall_MyMsg(&out, split, 1, NULL, dbuf);
+    assert(rc == len);
+    assert(dbuf->used <= XDR_MAX_DBUF_MyMsg(1));
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
@@ -0,0 +1,52 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+const MAX_NAME = 16;
+
+enum Kind {
+    KIND_VALUE = 1,
+    KIND_ITEM  = 2
+};
+
+struct Stamp {
+    unsigned int sec;
+    unsigned int nsec;
+};
+
+struct Item {
+    unsigned int id;
+    string       label<MAX_NAME>;
+};
+
+union Choice switch (Kind kind) {
+ case KIND_VALUE:
+    unsigned int value;
+ case KIND_ITEM:
+    Item item;
+};
+
+struct MyMsg {
+    string       name<MAX_NAME>;
+    opaque       tag[6];
+    zcopaque     data<8>;
+    Item         items<3>;
+    Stamp       *stamp;
+    Choice       choice;
+    int          words<4>;
+};
+
+struct Node {
+    unsigned int value;
+    Node        *next;
+};
+
+struct Open {
+    string       name<>;
+};
+
+struct WithList {
+    Node        *list;
+};
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+#include <stddef.h>
+#include <unistd.h>
+
+#include "native_iovec_xdr.h"
+
+_Static_assert(sizeof(xdr_iovec) == sizeof(struct iovec), "xdr_iovec is not a struct iovec");
+_Static_assert(offsetof(xdr_iovec, iov_base) == offsetof(struct iovec, iov_base), "iov_base offset");
+_Static_assert(offsetof(xdr_iovec, iov_len) == offsetof(struct iovec, iov_len), "iov_len offset");
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg msg, msg_out;
+    int64_t      values[3] = { -1, 0, INT64_MAX };
+    xdr_dbuf    *dbuf;
+    xdr_iovec    iov_in, iov_out[8], iov_data, iov_wire;
+    uint8_t      buffer[256], wire[256], data[11];
+    int          i, rc, len, niov_out = 8, fds[2];
+
+    dbuf = xdr_dbuf_alloc(4096);
+
+    for (i = 0; i < (int) sizeof(data); ++i) {
+        data[i] = i;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+
+    msg.xid = 42;
+    xdr_set_str_static(&msg, name, "native", 6);
+    xdr_iovec_set_data(&iov_data, data);
+    xdr_iovec_set_len(&iov_data, sizeof(data));
+    xdr_set_ref(&msg, data, &iov_data, 1, sizeof(data));
+    msg.num_values = 3;
+    msg.values     = values;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    len = marshall_MyMsg(&msg, &iov_in, iov_out, &niov_out, NULL, 0);
+    assert(len > 0);
+
+    /* Output goes to the kernel as is */
+    rc = pipe(fds);
+    assert(rc == 0);
+
+    rc = writev(fds[1], iov_out, niov_out);
+    assert(rc == len);
+
+    rc = read(fds[0], wire, sizeof(wire));
+    assert(rc == len);
+
+    close(fds[0]);
+    close(fds[1]);
+
+    xdr_iovec_set_data(&iov_wire, wire);
+    xdr_iovec_set_len(&iov_wire, len);
+
+    rc = unmarshall_MyMsg(&msg_out, &iov_wire, 1, NULL, dbuf);
+    assert(rc == len);
+
+    assert(msg_out.xid == 42);
+    assert(msg_out.name.len == 6 && memcmp(msg_out.name.str, "native", 6) == 0);
+    assert(msg_out.data.length == sizeof(data));
+    assert(msg_out.data.niov == 1);
+    assert(xdr_iovec_len(&msg_out.data.iov[0]) == sizeof(data));
+    assert(memcmp(xdr_iovec_data(&msg_out.data.iov[0]), data, sizeof(data)) == 0);
+    assert(msg_out.num_values == 3);
+    assert(memcmp(msg_out.values, values, sizeof(values)) == 0);
+
+    /* Lengths beyond 32 bits are clamped, not truncated */
+    xdr_iovec_set_len(&iov_wire, ((size_t) 1 << 32) + 4);
+
+    xdr_dbuf_reset(dbuf);
+
+    rc = unmarshall_MyMsg(&msg_out, &iov_wire, 1, NULL, dbuf);
+    assert(rc == len);
+    assert(msg_out.num_values == 3);
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
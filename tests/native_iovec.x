@@ -0,0 +1,12 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+struct MyMsg {
+    unsigned int xid;
+    string       name<>;
+    zcopaque     data<>;
+    int64_t      values<>;
+};
@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "opaque_union_xdr.h"
+
+#define SCRATCH 8
+
+struct refill_state {
+    uint8_t   scratch[64][SCRATCH];
+    xdr_iovec scratch_iov[64];
+    int       nscratch;
+};
+
+static int
+test_refill(
+    struct xdr_write_cursor *cursor,
+    unsigned int             bytes,
+    int                      iovs,
+    void                    *private_data)
+{
+    struct refill_state *state = private_data;
+    xdr_iovec           *iov;
+
+    if (bytes > SCRATCH || state->nscratch == 64) {
+        return -1;
+    }
+
+    iov = &state->scratch_iov[state->nscratch];
+
+    xdr_iovec_set_data(iov, state->scratch[state->nscratch]);
+    xdr_iovec_set_len(iov, SCRATCH);
+
+    state->nscratch++;
+
+    return xdr_write_cursor_set_scratch(cursor, iov);
+} /* test_refill */
+
+static void
+set_arm(
+    struct Arm *arm,
+    int         op)
+{
+    memset(arm, 0, sizeof(*arm));
+
+    arm->op = op;
+
+    switch (op) {
+        case OP_INNER:
+            arm->inner.a = 7;
+            xdr_set_str_static(&arm->inner, s, "abcde", 5);
+            break;
+        case OP_RAW:
+            arm->raw.data = "xyz";
+            arm->raw.len  = 3;
+            break;
+        case OP_ALIAS:
+        case OP_VALUE:
+            arm->value = 55;
+            break;
+        case OP_HYPER:
+            arm->big = 0x0102030405060708ULL;
+            break;
+        case OP_NESTED:
+            arm->nested.op      = OP_INNER;
+            arm->nested.inner.a = 9;
+            xdr_set_str_static(&arm->nested.inner, s, "nested", 6);
+            break;
+        case OP_BYTES:
+        case OP_DATA:
+            arm->data.data = "bytes";
+            arm->data.len  = 5;
+            break;
+    } /* switch */
+} /* set_arm */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct Outer            in, out;
+    struct refill_state     state;
+    struct xdr_write_cursor cursor;
+    xdr_dbuf               *dbuf;
+    xdr_iovec               iov_in, iov_out[64], iov_first;
+    uint8_t                 buffer[256], wire[256], first[SCRATCH];
+    uint32_t                word;
+    int                     op, i, rc, len, body;
+
+    dbuf = xdr_dbuf_alloc(4096);
+
+    for (op = OP_INNER; op <= OP_DATA; op++) {
+        memset(&in, 0, sizeof(in));
+        xdr_set_str_static(&in, name, "nm", 2);
+        set_arm(&in.arm, op);
+        in.tail = 31337;
+
+        xdr_iovec_set_data(&iov_in, buffer);
+        xdr_iovec_set_len(&iov_in, sizeof(buffer));
+        i = 64;
+
+        rc = marshall_Outer(&in, &iov_in, iov_out, &i, NULL, 0);
+        assert(rc > 0 && i == 1);
+
+        len = rc;
+        memcpy(wire, buffer, len);
+
+        /* The patched body length covers everything up to the tail */
+        if (op != OP_RAW && op != OP_BYTES && op != OP_DATA) {
+            word = (uint32_t) wire[12] << 24 | wire[13] << 16 | wire[14] << 8 | wire[15];
+            body = len - 16 - 4;
+            assert(word == body);
+        }
+
+        assert(marshall_length_Outer(&in) == len);
+
+        assert(skip_Outer(iov_out, 1) == len);
+
+        xdr_dbuf_reset(dbuf);
+        memset(&out, 0, sizeof(out));
+        rc = unmarshall_Outer(&out, iov_out, 1, NULL, dbuf);
+        assert(rc == len);
+        assert(out.arm.op == op);
+        assert(out.tail == 31337);
+
+        switch (op) {
+            case OP_INNER:
+                assert(out.arm.inner.a == 7 && out.arm.inner.s.len == 5);
+                break;
+            case OP_RAW:
+                assert(out.arm.raw.len == 3 && memcmp(out.arm.raw.data, "xyz", 3) == 0);
+                break;
+            case OP_ALIAS:
+            case OP_VALUE:
+                assert(out.arm.value == 55);
+                break;
+            case OP_HYPER:
+                assert(out.arm.big == 0x0102030405060708ULL);
+                break;
+            case OP_NESTED:
+                assert(out.arm.nested.op == OP_INNER && out.arm.nested.inner.a == 9);
+                break;
+            case OP_BYTES:
+            case OP_DATA:
+                assert(out.arm.data.len == 5 && memcmp(out.arm.data.data, "bytes", 5) == 0);
+                break;
+        } /* switch */
+
+        /* Encode again through tiny scratch runs so bodies span several */
+        memset(&state, 0, sizeof(state));
+
+        xdr_iovec_set_data(&iov_first, first);
+        xdr_iovec_set_len(&iov_first, sizeof(first));
+
+        xdr_write_cursor_init(&cursor, &iov_first, iov_out, 64, NULL, 0);
+        xdr_write_cursor_set_refill(&cursor, test_refill, &state);
+
+        rc = marshall_Outer_cursor(&in, &cursor);
+        assert(rc == 0);
+        rc = xdr_write_cursor_finish(&cursor);
+        assert(rc == len);
+        assert(cursor.niov > 2);
+
+        for (i = 0, rc = 0; i < cursor.niov; i++) {
+            assert(memcmp(wire + rc, xdr_iovec_data(&cursor.iov[i]), xdr_iovec_len(&cursor.iov[i])) == 0);
+            rc += xdr_iovec_len(&cursor.iov[i]);
+        }
+
+        assert(rc == len);
+    }
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
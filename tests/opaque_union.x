@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+enum Op {
+    OP_INNER  = 1,
+    OP_RAW    = 2,
+    OP_VOID   = 3,
+    OP_ALIAS  = 4,
+    OP_VALUE  = 5,
+    OP_HYPER  = 6,
+    OP_NESTED = 7,
+    OP_BYTES  = 8,
+    OP_DATA   = 9
+};
+
+struct Inner {
+    unsigned int a;
+    string       s<>;
+};
+
+opaque_union Nested switch (Op op) {
+ case OP_INNER:
+    Inner inner;
+ default:
+    void;
+};
+
+opaque_union Arm switch (Op op) {
+ case OP_INNER:
+    Inner inner;
+ case OP_RAW:
+    opaque raw<>;
+ case OP_VOID:
+    void;
+ case OP_ALIAS:
+ case OP_VALUE:
+    unsigned int value;
+ case OP_HYPER:
+    uint64_t big;
+ case OP_NESTED:
+    Nested nested;
+ case OP_BYTES:
+ case OP_DATA:
+    opaque data<>;
+};
+
+struct Outer {
+    string       name<>;
+    Arm          arm;
+    unsigned int tail;
+};
@@ -0,0 +1,179 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "quota_xdr.h"
+
+static void
+put32(
+    uint8_t *wire,
+    int      offset,
+    uint32_t value)
+{
+    wire[offset]     = value >> 24;
+    wire[offset + 1] = value >> 16;
+    wire[offset + 2] = value >> 8;
+    wire[offset + 3] = value;
+} /* put32 */
+
+/* Decode from one buffer, or split so the vector path runs */
+static int
+decode(
+    struct MyMsg *out,
+    uint8_t      *wire,
+    int           len,
+    int           split,
+    xdr_dbuf     *dbuf)
+{
+    xdr_iovec iov[2];
+
+    xdr_dbuf_reset(dbuf);
+
+    xdr_iovec_set_data(&iov[0], wire);
+
+    if (!split) {
+        xdr_iovec_set_len(&iov[0], len);
+        return unmarshall_MyMsg(out, iov, 1, NULL, dbuf);
+    }
+
+    xdr_iovec_set_len(&iov[0], len - 1);
+    xdr_iovec_set_data(&iov[1], wire + len - 1);
+    xdr_iovec_set_len(&iov[1], 1);
+
+    return unmarshall_MyMsg(out, iov, 2, NULL, dbuf);
+} /* decode */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg msg, out;
+    struct Item  items[3];
+    int32_t      words[2] = { 1, 2 };
+    xdr_dbuf    *dbuf;
+    xdr_iovec    iov_in, iov_out[8], iov_data;
+    uint8_t      buffer[512], wire[512], bad[512], data[7] = "zcdata";
+    int          i, rc, len, split, base, needed, niov_out = 8;
+
+    /* Offsets of each length or count word in the encoding below */
+    const int    name_at = 0, blob_at = 8, data_at = 20, words_at = 32, items_at = 44;
+
+    memset(&msg, 0, sizeof(msg));
+    xdr_set_str_static(&msg, name, "abc", 3);
+    msg.blob.data = "bytes";
+    msg.blob.len  = 5;
+    xdr_iovec_set_data(&iov_data, data);
+    xdr_iovec_set_len(&iov_data, 7);
+    xdr_set_ref(&msg, data, &iov_data, 1, 7);
+
+    msg.num_words = 2;
+    msg.words     = words;
+
+    for (i = 0; i < 3; ++i) {
+        items[i].a = i;
+        xdr_set_str_static(&items[i], label, "x", 1);
+    }
+
+    msg.num_items = 2;
+    msg.items     = items;
+    msg.num_more  = 3;
+    msg.more      = items;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    rc = marshall_MyMsg(&msg, &iov_in, iov_out, &niov_out, NULL, 0);
+    assert(rc > 0);
+
+    len = 0;
+
+    for (i = 0; i < niov_out; ++i) {
+        memcpy(wire + len, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+        len += xdr_iovec_len(&iov_out[i]);
+    }
+
+    assert(len == rc);
+
+    dbuf = xdr_dbuf_alloc(64 * 1024);
+
+    for (split = 0; split < 2; split++) {
+        rc = decode(&out, wire, len, split, dbuf);
+        assert(rc == len);
+        assert(out.num_items == 2 && out.num_more == 3);
+
+        /* Lengths and counts over their declared bounds fail before allocating */
+        memcpy(bad, wire, len);
+        put32(bad, name_at, 9);
+        assert(decode(&out, bad, len, split, dbuf) == -1);
+
+        memcpy(bad, wire, len);
+        put32(bad, blob_at, 17);
+        assert(decode(&out, bad, len, split, dbuf) == -1);
+
+        memcpy(bad, wire, len);
+        put32(bad, data_at, 33);
+        assert(decode(&out, bad, len, split, dbuf) == -1);
+
+        /* Nothing is allocated for a vector whose count is refused */
+        memcpy(bad, wire, len);
+        put32(bad, words_at, MAX_ITEMS + 1);
+        assert(decode(&out, bad, len, split, dbuf) == -1);
+        base = dbuf->used;
+
+        memcpy(bad, wire, len);
+        put32(bad, items_at, MAX_ITEMS + 1);
+        assert(decode(&out, bad, len, split, dbuf) == -1);
+        assert(dbuf->used == base + 8);
+
+        /* An unbounded count whose allocation would overflow is rejected */
+        memcpy(bad, wire, len);
+        put32(bad, len - 4 - 3 * 12, 0x40000000);
+        assert(decode(&out, bad, len, split, dbuf) == -1);
+        assert(dbuf->used == base + 8 + 2 * sizeof(struct Item));
+    }
+
+    /* The quota covers exactly what this message allocates */
+    assert(decode(&out, wire, len, 0, dbuf) == len);
+    needed = dbuf->used;
+
+    xdr_dbuf_set_quota(dbuf, needed);
+    assert(decode(&out, wire, len, 0, dbuf) == len);
+    assert(decode(&out, wire, len, 0, dbuf) == len);
+
+    xdr_dbuf_set_quota(dbuf, needed - 1);
+    assert(decode(&out, wire, len, 0, dbuf) == -1);
+
+    /* A large unbounded count fails against the quota, not the arena */
+    xdr_dbuf_set_quota(dbuf, 1024);
+    memcpy(bad, wire, len);
+    put32(bad, len - 4 - 3 * 12, 1000);
+    assert(decode(&out, bad, len, 0, dbuf) == -1);
+    assert(dbuf->used == needed - 3 * sizeof(struct Item));
+
+    xdr_dbuf_set_quota(dbuf, 0);
+    assert(decode(&out, wire, len, 0, dbuf) == len);
+
+    xdr_dbuf_free(dbuf);
+
+    /* The quota is charged the same when the message spans chained chunks */
+    dbuf = xdr_dbuf_alloc(32);
+    xdr_dbuf_set_chunk_allocator(dbuf, 32, NULL, NULL, NULL);
+
+    xdr_dbuf_set_quota(dbuf, needed);
+    assert(decode(&out, wire, len, 0, dbuf) == len);
+    assert(dbuf->chunks != NULL);
+    assert(decode(&out, wire, len, 0, dbuf) == len);
+
+    xdr_dbuf_set_quota(dbuf, needed - 1);
+    assert(decode(&out, wire, len, 0, dbuf) == -1);
+
+    xdr_dbuf_set_quota(dbuf, 0);
+    assert(decode(&out, wire, len, 0, dbuf) == len);
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
@@ -0,0 +1,21 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+const MAX_ITEMS = 4;
+
+struct Item {
+    unsigned int a;
+    string       label<>;
+};
+
+struct MyMsg {
+    string   name<8>;
+    opaque   blob<16>;
+    zcopaque data<32>;
+    int      words<MAX_ITEMS>;
+    Item     items<MAX_ITEMS>;
+    Item     more<>;
+};
@@ -0,0 +1,198 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "record_xdr.h"
+
+static int
+frame(
+    uint8_t       *stream,
+    const uint8_t *wire,
+    int            len,
+    int            fragment)
+{
+    int      pos = 0, off = 0, chunk;
+    uint32_t header;
+
+    do {
+        chunk = len - off < fragment ? len - off : fragment;
+
+        header = chunk;
+
+        if (off + chunk == len) {
+            header |= 0x80000000;
+        }
+
+        stream[pos++] = header >> 24;
+        stream[pos++] = header >> 16;
+        stream[pos++] = header >> 8;
+        stream[pos++] = header;
+
+        memcpy(stream + pos, wire + off, chunk);
+
+        pos += chunk;
+        off += chunk;
+    } while (off < len);
+
+    return pos;
+} /* frame */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg           msg, msg_out;
+    struct Pair            pairs[3];
+    struct xdr_read_cursor cursor;
+    int32_t                words[5] = { 1, -2, 3, -4, 5 };
+    xdr_dbuf              *dbuf;
+    xdr_iovec              iov_in, iov_out[8], iov_data, iov_split[4096];
+    uint8_t                buffer[1024], wire[1024], stream[4096], copy[64];
+    uint8_t                data[37];
+    int                    i, j, rc, len, slen, fragment, split, niov, niov_out;
+
+    dbuf = xdr_dbuf_alloc(8192);
+
+    memset(&msg, 0, sizeof(msg));
+
+    msg.xid = 0x12345678;
+    xdr_set_str_static(&msg, name, "record", 6);
+
+    for (i = 0; i < (int) sizeof(data); i++) {
+        data[i] = 0x80 + i;
+    }
+
+    xdr_iovec_set_data(&iov_data, data);
+    xdr_iovec_set_len(&iov_data, sizeof(data));
+    xdr_set_ref(&msg, data, &iov_data, 1, sizeof(data));
+
+    for (i = 0; i < 3; ++i) {
+        pairs[i].a = i;
+        pairs[i].b = 0x1000000000ULL * (i + 1);
+    }
+
+    msg.num_pairs = 3;
+    msg.pairs     = pairs;
+    msg.num_words = 5;
+    msg.words     = words;
+    msg.blob.data = "marked";
+    msg.blob.len  = 6;
+    msg.trailer   = 0xabcdef01;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+    niov_out = 8;
+
+    rc = marshall_MyMsg(&msg, &iov_in, iov_out, &niov_out, NULL, 0);
+    assert(rc > 0);
+
+    len = 0;
+
+    for (i = 0; i < niov_out; ++i) {
+        memcpy(wire + len, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+        len += xdr_iovec_len(&iov_out[i]);
+    }
+
+    assert(len == rc);
+
+    /* Every fragment size, delivered in every segment size */
+    for (fragment = 1; fragment <= len; fragment++) {
+
+        slen = frame(stream, wire, len, fragment);
+
+        /* The start of the next record must not be consumed */
+        memset(stream + slen, 0xff, 8);
+        slen += 8;
+
+        for (split = 1; split <= slen; split = split < 16 ? split + 1 : split * 2) {
+
+            for (niov = 0; niov * split < slen; niov++) {
+                xdr_iovec_set_data(&iov_split[niov], stream + niov * split);
+                xdr_iovec_set_len(&iov_split[niov], slen - niov * split < split ? slen - niov * split : split);
+            }
+
+            assert(niov <= 4096);
+
+            xdr_dbuf_reset(dbuf);
+
+            rc = xdr_read_cursor_record_init(&cursor, iov_split, niov, NULL);
+            assert(rc == 0);
+
+            rc = unmarshall_MyMsg_cursor(&msg_out, &cursor, dbuf);
+            assert(rc == len);
+            assert(cursor.offset == len);
+
+            assert(msg_out.xid == msg.xid);
+            assert(msg_out.name.len == 6 && memcmp(msg_out.name.str, "record", 6) == 0);
+            assert(msg_out.num_pairs == 3);
+
+            for (i = 0; i < 3; ++i) {
+                assert(msg_out.pairs[i].a == pairs[i].a);
+                assert(msg_out.pairs[i].b == pairs[i].b);
+            }
+
+            assert(msg_out.num_words == 5);
+            assert(memcmp(msg_out.words, words, sizeof(words)) == 0);
+            assert(msg_out.blob.len == 6 && memcmp(msg_out.blob.data, "marked", 6) == 0);
+            assert(msg_out.trailer == msg.trailer);
+
+            /* Zero-copy segments refer to payload bytes only */
+            assert(msg_out.data.length == sizeof(data));
+
+            rc = 0;
+
+            for (i = 0; i < msg_out.data.niov; ++i) {
+                const uint8_t *p = xdr_iovec_data(&msg_out.data.iov[i]);
+
+                assert(p >= stream && p + xdr_iovec_len(&msg_out.data.iov[i]) <= stream + slen);
+
+                for (j = 0; j < (int) xdr_iovec_len(&msg_out.data.iov[i]); ++j) {
+                    copy[rc++] = p[j];
+                }
+            }
+
+            assert(rc == sizeof(data));
+            assert(memcmp(copy, data, sizeof(data)) == 0);
+        }
+
+        /* A record that ends early fails rather than reading on */
+        if (fragment < len) {
+            stream[0] |= 0x80;
+
+            xdr_iovec_set_data(&iov_split[0], stream);
+            xdr_iovec_set_len(&iov_split[0], slen);
+
+            rc = xdr_read_cursor_record_init(&cursor, iov_split, 1, NULL);
+            assert(rc == 0);
+
+            rc = unmarshall_MyMsg_cursor(&msg_out, &cursor, dbuf);
+            assert(rc < 0);
+        }
+    }
+
+    /* Missing fragment header */
+    xdr_iovec_set_data(&iov_split[0], stream);
+    xdr_iovec_set_len(&iov_split[0], 3);
+
+    rc = xdr_read_cursor_record_init(&cursor, iov_split, 1, NULL);
+    assert(rc < 0);
+
+    /* Truncated final fragment */
+    slen = frame(stream, wire, len, 16);
+
+    xdr_iovec_set_data(&iov_split[0], stream);
+    xdr_iovec_set_len(&iov_split[0], slen - 1);
+
+    rc = xdr_read_cursor_record_init(&cursor, iov_split, 1, NULL);
+    assert(rc == 0);
+
+    rc = unmarshall_MyMsg_cursor(&msg_out, &cursor, dbuf);
+    assert(rc < 0);
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
@@ -0,0 +1,20 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+struct Pair {
+    unsigned int a;
+    uint64_t     b;
+};
+
+struct MyMsg {
+    unsigned int xid;
+    string       name<>;
+    zcopaque     data<>;
+    Pair         pairs<>;
+    int          words<>;
+    opaque       blob<>;
+    unsigned int trailer;
+};
@@ -0,0 +1,280 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "resume_xdr.h"
+
+static void
+check_msg(const struct MyMsg *msg)
+{
+    assert(msg->value == 1);
+    assert(msg->name.len == 6 && memcmp(msg->name.str, "resume", 6) == 0);
+    assert(msg->data.length == 7);
+    assert(memcmp(msg->fixed, "12345678", 8) == 0);
+    assert(msg->num_entries == 3);
+    assert(msg->entries[0].choice.kind == KIND_VALUE);
+    assert(msg->entries[0].choice.pair.a == 7);
+    assert(msg->entries[0].choice.pair.b == 8);
+    assert(msg->entries[1].choice.kind == KIND_NAME);
+    assert(msg->entries[1].choice.name.len == 6);
+    assert(memcmp(msg->entries[1].choice.name.str, "choice", 6) == 0);
+    assert(msg->entries[2].choice.kind == KIND_NONE);
+    assert(msg->entries[2].name.len == 5);
+    assert(memcmp(msg->entries[2].name.str, "entry", 5) == 0);
+    assert(msg->maybe && msg->maybe->a == 0 && msg->maybe->b == 0);
+    assert(msg->absent == NULL);
+    assert(msg->num_words == 3 && msg->words[1] == -2);
+    assert(msg->two[1].a == 2 && msg->two[1].b == 2000);
+    assert(msg->list && msg->list->value == 10);
+    assert(msg->list->next && msg->list->next->value == 11);
+    assert(msg->list->next->next == NULL);
+    assert(msg->wrapped.kind == KIND_VALUE);
+    assert(msg->wrapped.pair.a == 5 && msg->wrapped.pair.b == 6);
+    assert(msg->trailer == 0xabcdef01);
+} /* check_msg */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg       msg, msg2;
+    struct Entry       entries[3];
+    struct Pair        pairs[3];
+    struct Node        nodes[2];
+    struct xdr_resume *ctx;
+    xdr_dbuf          *dbuf;
+    int32_t            words[3] = { 1, -2, 3 };
+    xdr_iovec          iov_in, iov_out[9], iov_data, iov_chunk, iov_ctx[512];
+    uint8_t            buffer[1024], wire[1024], wire2[1024], data[7] = "zcdata";
+    char               long_name[101];
+    int                i, rc, len, len2, niov_out, chunk, calls, maxiov, flat;
+
+    memset(&msg, 0, sizeof(msg));
+    memset(entries, 0, sizeof(entries));
+
+    msg.value = 1;
+    xdr_set_str_static(&msg, name, "resume", 6);
+
+    xdr_iovec_set_data(&iov_data, data);
+    xdr_iovec_set_len(&iov_data, 7);
+    xdr_set_ref(&msg, data, &iov_data, 1, 7);
+
+    memcpy(msg.fixed, "12345678", 8);
+
+    for (i = 0; i < 3; ++i) {
+        pairs[i].a = i;
+        pairs[i].b = i * 1000;
+    }
+
+    entries[0].choice.kind   = KIND_VALUE;
+    entries[0].choice.pair.a = 7;
+    entries[0].choice.pair.b = 8;
+    entries[1].choice.kind   = KIND_NAME;
+    xdr_set_str_static(&entries[1].choice, name, "choice", 6);
+    entries[2].choice.kind = KIND_NONE;
+    xdr_set_str_static(&entries[2], name, "entry", 5);
+
+    msg.num_entries = 3;
+    msg.entries     = entries;
+    msg.maybe       = &pairs[0];
+    msg.num_words   = 3;
+    msg.words       = words;
+    msg.two[0]      = pairs[1];
+    msg.two[1]      = pairs[2];
+
+    nodes[0].value = 10;
+    nodes[0].next  = &nodes[1];
+    nodes[1].value = 11;
+    nodes[1].next  = NULL;
+    msg.list       = &nodes[0];
+
+    msg.wrapped.kind   = KIND_VALUE;
+    msg.wrapped.pair.a = 5;
+    msg.wrapped.pair.b = 6;
+
+    msg.trailer = 0xabcdef01;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+    niov_out = 8;
+
+    rc = marshall_MyMsg(&msg, &iov_in, iov_out, &niov_out, NULL, 0);
+    assert(rc > 0);
+
+    len = 0;
+
+    for (i = 0; i < niov_out; ++i) {
+        memcpy(wire + len, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+        len += xdr_iovec_len(&iov_out[i]);
+    }
+
+    assert(len == rc);
+
+    dbuf = xdr_dbuf_alloc(4096);
+    ctx  = malloc(sizeof(*ctx));
+
+    /* Nothing received yet */
+    xdr_resume_init(ctx, iov_ctx, 512);
+    rc = unmarshall_MyMsg_resume(&msg2, ctx, dbuf);
+    assert(rc == XDR_RESUME_MORE);
+
+    /* Feed the message in progressively larger pieces */
+    for (chunk = 1; chunk <= len; chunk = chunk * 3 + 1) {
+        xdr_dbuf_reset(dbuf);
+        memset(&msg2, 0, sizeof(msg2));
+        xdr_resume_init(ctx, iov_ctx, 512);
+        calls = 0;
+
+        for (i = 0; i < len; i += chunk) {
+            xdr_iovec_set_data(&iov_chunk, wire + i);
+            xdr_iovec_set_len(&iov_chunk, i + chunk > len ? len - i : chunk);
+
+            rc = xdr_resume_append(ctx, &iov_chunk, 1);
+            assert(rc == 0);
+
+            rc = unmarshall_MyMsg_resume(&msg2, ctx, dbuf);
+            calls++;
+
+            if (i + chunk < len) {
+                assert(rc == XDR_RESUME_MORE);
+            }
+        }
+
+        assert(rc == len);
+        assert(calls == (len + chunk - 1) / chunk);
+        check_msg(&msg2);
+    }
+
+    /*
+     * Strings and opaques are consumed as they arrive rather than waited
+     * for whole: 11 bytes stop three bytes into name, 32 halfway into fixed
+     */
+    for (i = 11; i <= 32; i += 21) {
+        xdr_dbuf_reset(dbuf);
+        memset(&msg2, 0, sizeof(msg2));
+        xdr_resume_init(ctx, iov_ctx, 512);
+
+        xdr_iovec_set_data(&iov_chunk, wire);
+        xdr_iovec_set_len(&iov_chunk, i);
+        rc = xdr_resume_append(ctx, &iov_chunk, 1);
+        assert(rc == 0);
+        rc = unmarshall_MyMsg_resume(&msg2, ctx, dbuf);
+        assert(rc == XDR_RESUME_MORE);
+        assert(ctx->offset == i);
+
+        xdr_iovec_set_data(&iov_chunk, wire + i);
+        xdr_iovec_set_len(&iov_chunk, len - i);
+        rc = xdr_resume_append(ctx, &iov_chunk, 1);
+        assert(rc == 0);
+        rc = unmarshall_MyMsg_resume(&msg2, ctx, dbuf);
+        assert(rc == len);
+        check_msg(&msg2);
+    }
+
+    /* A single resume call over the whole message decodes it directly */
+    xdr_dbuf_reset(dbuf);
+    xdr_resume_init(ctx, iov_ctx, 1);
+    xdr_iovec_set_data(&iov_chunk, wire);
+    xdr_iovec_set_len(&iov_chunk, len);
+    rc = xdr_resume_append(ctx, &iov_chunk, 1);
+    assert(rc == 0);
+    rc = xdr_resume_append(ctx, &iov_chunk, 1);
+    assert(rc == -1);
+    rc = unmarshall_MyMsg_resume(&msg2, ctx, dbuf);
+    assert(rc == len);
+    check_msg(&msg2);
+
+    /* Encode into small send buffers, continuing where each one filled */
+    for (chunk = 20; chunk <= 64; chunk += 11) {
+        for (maxiov = 3; maxiov <= 9; maxiov += 3) {
+            xdr_resume_init(ctx, NULL, 0);
+            len2 = 0;
+
+            do {
+                xdr_iovec_set_data(&iov_in, buffer);
+                xdr_iovec_set_len(&iov_in, chunk);
+                niov_out = maxiov;
+
+                rc = marshall_MyMsg_resume(&msg, ctx, &iov_in, iov_out, &niov_out, 0);
+                assert(rc == XDR_RESUME_MORE || rc > 0);
+                assert(xdr_iovec_len(&iov_in) <= chunk);
+
+                for (i = 0; i < niov_out; ++i) {
+                    memcpy(wire2 + len2, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+                    len2 += xdr_iovec_len(&iov_out[i]);
+                }
+
+                assert(len2 == ctx->offset);
+            } while (rc == XDR_RESUME_MORE);
+
+            assert(rc == len);
+            assert(len2 == len);
+            assert(memcmp(wire, wire2, len) == 0);
+        }
+    }
+
+    /* Strings and opaques larger than the send buffer are split across calls */
+    memset(long_name, 'n', sizeof(long_name));
+    xdr_set_str_static(&msg, name, long_name, sizeof(long_name));
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+    niov_out = 8;
+
+    len = marshall_MyMsg(&msg, &iov_in, iov_out, &niov_out, NULL, 0);
+    assert(len > 0);
+
+    flat = 0;
+
+    for (i = 0; i < niov_out; ++i) {
+        memcpy(wire + flat, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+        flat += xdr_iovec_len(&iov_out[i]);
+    }
+
+    assert(flat == len);
+
+    xdr_resume_init(ctx, NULL, 0);
+    len2  = 0;
+    calls = 0;
+
+    do {
+        xdr_iovec_set_data(&iov_in, buffer);
+        xdr_iovec_set_len(&iov_in, 20);
+        niov_out = 3;
+
+        rc = marshall_MyMsg_resume(&msg, ctx, &iov_in, iov_out, &niov_out, 0);
+        assert(rc == XDR_RESUME_MORE || rc > 0);
+        calls++;
+
+        for (i = 0; i < niov_out; ++i) {
+            memcpy(wire2 + len2, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+            len2 += xdr_iovec_len(&iov_out[i]);
+        }
+    } while (rc == XDR_RESUME_MORE);
+
+    assert(rc == len);
+    assert(len2 == len);
+    assert(calls > (int) sizeof(long_name) / 20);
+    assert(memcmp(wire, wire2, len) == 0);
+
+    /* A member larger than the send buffer that cannot be split makes no progress */
+    xdr_resume_init(ctx, NULL, 0);
+
+    do {
+        xdr_iovec_set_data(&iov_in, buffer);
+        xdr_iovec_set_len(&iov_in, 12);
+        niov_out = 8;
+
+        rc = marshall_MyMsg_resume(&msg, ctx, &iov_in, iov_out, &niov_out, 0);
+    } while (rc == XDR_RESUME_MORE);
+
+    assert(rc == -1);
+
+    free(ctx);
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "ring_xdr.h"
+
+#define RING_SIZE 256
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg           msg, msg_out;
+    struct xdr_read_cursor cursor;
+    uint64_t               values[4] = { 1, 2, 0x100000000ULL, UINT64_MAX };
+    xdr_dbuf              *dbuf;
+    xdr_iovec              iov_in, iov_out[8], iov_data, iov_ring;
+    uint8_t                buffer[1024], wire[1024], ring[RING_SIZE], copy[64];
+    uint8_t                data[29];
+    int                    i, j, rc, len, head, niov_out, wrapped = 0;
+
+    dbuf = xdr_dbuf_alloc(8192);
+
+    memset(&msg, 0, sizeof(msg));
+
+    msg.xid = 0x12345678;
+    xdr_set_str_static(&msg, name, "circular", 8);
+
+    for (i = 0; i < (int) sizeof(data); i++) {
+        data[i] = 0x40 + i;
+    }
+
+    xdr_iovec_set_data(&iov_data, data);
+    xdr_iovec_set_len(&iov_data, sizeof(data));
+    xdr_set_ref(&msg, data, &iov_data, 1, sizeof(data));
+
+    msg.num_values = 4;
+    msg.values     = values;
+    msg.trailer    = 0xabcdef01;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+    niov_out = 8;
+
+    rc = marshall_MyMsg(&msg, &iov_in, iov_out, &niov_out, NULL, 0);
+    assert(rc > 0);
+
+    len = 0;
+
+    for (i = 0; i < niov_out; ++i) {
+        memcpy(wire + len, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+        len += xdr_iovec_len(&iov_out[i]);
+    }
+
+    assert(len == rc);
+
+    xdr_iovec_set_data(&iov_ring, ring);
+    xdr_iovec_set_len(&iov_ring, RING_SIZE);
+
+    /* Place the message at every position of the ring */
+    for (head = 0; head < RING_SIZE; head++) {
+
+        memset(ring, 0xee, sizeof(ring));
+
+        for (i = 0; i < len; i++) {
+            ring[(head + i) % RING_SIZE] = wire[i];
+        }
+
+        xdr_dbuf_reset(dbuf);
+
+        rc = xdr_read_cursor_ring_init(&cursor, &iov_ring, head, len, NULL);
+        assert(rc == 0);
+
+        rc = unmarshall_MyMsg_cursor(&msg_out, &cursor, dbuf);
+        assert(rc == len);
+
+        assert(msg_out.xid == msg.xid);
+        assert(msg_out.name.len == 8 && memcmp(msg_out.name.str, "circular", 8) == 0);
+        assert(msg_out.num_values == 4);
+        assert(memcmp(msg_out.values, values, sizeof(values)) == 0);
+        assert(msg_out.trailer == msg.trailer);
+
+        /* A payload spanning the wrap is referenced in two segments */
+        assert(msg_out.data.length == sizeof(data));
+        assert(msg_out.data.niov >= 1 && msg_out.data.niov <= 2);
+
+        if (msg_out.data.niov == 2) {
+            assert(xdr_iovec_data(&msg_out.data.iov[1]) == ring);
+            wrapped++;
+        }
+
+        rc = 0;
+
+        for (i = 0; i < msg_out.data.niov; ++i) {
+            const uint8_t *p = xdr_iovec_data(&msg_out.data.iov[i]);
+
+            assert(p >= ring && p + xdr_iovec_len(&msg_out.data.iov[i]) <= ring + RING_SIZE);
+
+            for (j = 0; j < (int) xdr_iovec_len(&msg_out.data.iov[i]); ++j) {
+                copy[rc++] = p[j];
+            }
+        }
+
+        assert(rc == sizeof(data));
+        assert(memcmp(copy, data, sizeof(data)) == 0);
+
+        /* The ring holds less than a whole message */
+        rc = xdr_read_cursor_ring_init(&cursor, &iov_ring, head, len - 1, NULL);
+        assert(rc == 0);
+
+        rc = unmarshall_MyMsg_cursor(&msg_out, &cursor, dbuf);
+        assert(rc < 0);
+    }
+
+    assert(wrapped == (int) sizeof(data) - 1);
+
+    rc = xdr_read_cursor_ring_init(&cursor, &iov_ring, RING_SIZE, 4, NULL);
+    assert(rc < 0);
+
+    rc = xdr_read_cursor_ring_init(&cursor, &iov_ring, 0, RING_SIZE + 1, NULL);
+    assert(rc < 0);
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
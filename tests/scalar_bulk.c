@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "scalar_bulk_xdr.h"
+
+#define NUM_WORDS  1000
+#define NUM_BIG    333
+#define NUM_FLOATS 21
+
+static xdr_iovec iov_split[8192];
+
+static void
+check_msg(const struct MyMsg *msg)
+{
+    int i;
+
+    assert(msg->num_words == NUM_WORDS);
+    assert(msg->num_big == NUM_BIG);
+    assert(msg->num_floats == NUM_FLOATS);
+
+    for (i = 0; i < NUM_WORDS; ++i) {
+        assert(msg->words[i] == 0x01020304u * i);
+    }
+
+    for (i = 0; i < NUM_BIG; ++i) {
+        assert(msg->big[i] == 0x0102030405060708ull * i);
+    }
+
+    for (i = 0; i < 37; ++i) {
+        assert(msg->fixed[i] == -i * 1000);
+    }
+
+    for (i = 0; i < 9; ++i) {
+        assert(msg->reals[i] == i * 0.25);
+    }
+
+    for (i = 0; i < NUM_FLOATS; ++i) {
+        assert(msg->floats[i] == i * 1.5f);
+    }
+} /* check_msg */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg msg1, msg2;
+    xdr_dbuf    *dbuf;
+    uint8_t      buffer[16384], *wire;
+    xdr_iovec    iov_in, iov_out;
+    int          rc, i, len, niov, chunk, one = 1;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    dbuf = xdr_dbuf_alloc(64 * 1024);
+
+    msg1.num_words  = NUM_WORDS;
+    msg1.words      = xdr_dbuf_alloc_space(NUM_WORDS * sizeof(*msg1.words), dbuf);
+    msg1.num_big    = NUM_BIG;
+    msg1.big        = xdr_dbuf_alloc_space(NUM_BIG * sizeof(*msg1.big), dbuf);
+    msg1.num_floats = NUM_FLOATS;
+    msg1.floats     = xdr_dbuf_alloc_space(NUM_FLOATS * sizeof(*msg1.floats), dbuf);
+
+    assert(msg1.words && msg1.big && msg1.floats);
+
+    for (i = 0; i < NUM_WORDS; ++i) {
+        msg1.words[i] = 0x01020304u * i;
+    }
+
+    for (i = 0; i < NUM_BIG; ++i) {
+        msg1.big[i] = 0x0102030405060708ull * i;
+    }
+
+    for (i = 0; i < 37; ++i) {
+        msg1.fixed[i] = -i * 1000;
+    }
+
+    for (i = 0; i < 9; ++i) {
+        msg1.reals[i] = i * 0.25;
+    }
+
+    for (i = 0; i < NUM_FLOATS; ++i) {
+        msg1.floats[i] = i * 1.5f;
+    }
+
+    rc = marshall_MyMsg(&msg1, &iov_in, &iov_out, &one, NULL, 0);
+
+    len = 4 + NUM_WORDS * 4 + 4 + NUM_BIG * 8 + 37 * 4 + 9 * 8 + 4 + NUM_FLOATS * 4;
+
+    assert(rc == len);
+
+    /* Integers must be big endian on the wire */
+    wire = xdr_iovec_data(&iov_out);
+
+    assert(wire[4 + 4 * 1] == 0x01 && wire[4 + 4 * 1 + 3] == 0x04);
+    assert(wire[4 + NUM_WORDS * 4 + 4 + 8] == 0x01);
+    assert(wire[4 + NUM_WORDS * 4 + 4 + 8 + 7] == 0x08);
+
+    rc = unmarshall_MyMsg(&msg2, &iov_out, one, NULL, dbuf);
+
+    assert(rc == len);
+
+    check_msg(&msg2);
+
+    /* Re-split the message into small odd sized segments so that
+     * elements straddle iovec boundaries on the vector path */
+    for (chunk = 1; chunk <= 13; chunk += 3) {
+        niov = 0;
+
+        for (i = 0; i < len; i += chunk) {
+            xdr_iovec_set_data(&iov_split[niov], wire + i);
+            xdr_iovec_set_len(&iov_split[niov], (len - i) < chunk ? (len - i) : chunk);
+            niov++;
+        }
+
+        if (niov == 1) {
+            continue;
+        }
+
+        xdr_dbuf_reset(dbuf);
+
+        rc = unmarshall_MyMsg(&msg2, iov_split, niov, NULL, dbuf);
+
+        assert(rc == len);
+
+        check_msg(&msg2);
+    }
+
+    /* Truncated input must fail rather than over-read */
+    xdr_iovec_set_len(&iov_out, len - 2);
+
+    xdr_dbuf_reset(dbuf);
+
+    rc = unmarshall_MyMsg(&msg2, &iov_out, one, NULL, dbuf);
+
+    assert(rc < 0);
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
@@ -0,0 +1,13 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+struct MyMsg {
+    unsigned int  words<>;
+    uint64_t      big<>;
+    int           fixed[37];
+    double        reals[9];
+    float         floats<>;
+};
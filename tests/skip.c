@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "skip_xdr.h"
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg msg;
+    struct Pair  pairs[3], maybe;
+    struct Node  nodes[2];
+    int32_t      words[3] = { 1, -2, 3 };
+    xdr_iovec    iov_in, iov_out[8], iov_data, iov_split[256];
+    uint8_t      buffer[1024], wire[1024], data[7] = "zcdata";
+    int          i, rc, len, total, niov_out;
+
+    memset(&msg, 0, sizeof(msg));
+
+    msg.value = 1;
+    xdr_set_str_static(&msg, name, "skipme", 6);
+    msg.blob.data = "abc";
+    msg.blob.len  = 3;
+
+    xdr_iovec_set_data(&iov_data, data);
+    xdr_iovec_set_len(&iov_data, 7);
+    xdr_set_ref(&msg, data, &iov_data, 1, 7);
+
+    memcpy(msg.fixed, "12345678", 8);
+
+    for (i = 0; i < 3; ++i) {
+        pairs[i].a = i;
+        pairs[i].b = i * 1000;
+    }
+
+    msg.num_pairs = 3;
+    msg.pairs     = pairs;
+    maybe         = pairs[0];
+    msg.maybe     = &maybe;
+    msg.num_words = 3;
+    msg.words     = words;
+    msg.two[0]    = pairs[1];
+    msg.two[1]    = pairs[2];
+
+    nodes[0].value = 10;
+    nodes[0].next  = &nodes[1];
+    nodes[1].value = 11;
+    nodes[1].next  = NULL;
+    msg.list       = &nodes[0];
+
+    msg.choice.kind = KIND_NAME;
+    xdr_set_str_static(&msg.choice, name, "choice", 6);
+
+    msg.wrapped.kind   = KIND_VALUE;
+    msg.wrapped.pair.a = 5;
+    msg.wrapped.pair.b = 6;
+
+    msg.trailer = 0xabcdef01;
+
+    /* Encode two messages back to back */
+    total = 0;
+
+    for (i = 0; i < 2; ++i) {
+        xdr_iovec_set_data(&iov_in, buffer);
+        xdr_iovec_set_len(&iov_in, sizeof(buffer));
+        niov_out = 8;
+
+        rc = marshall_MyMsg(&msg, &iov_in, iov_out, &niov_out, NULL, 0);
+        assert(rc > 0);
+
+        len = 0;
+
+        for (int j = 0; j < niov_out; ++j) {
+            memcpy(wire + total + len, xdr_iovec_data(&iov_out[j]), xdr_iovec_len(&iov_out[j]));
+            len += xdr_iovec_len(&iov_out[j]);
+        }
+
+        assert(len == rc);
+        total += len;
+    }
+
+    /* Contiguous */
+    xdr_iovec_set_data(&iov_split[0], wire);
+    xdr_iovec_set_len(&iov_split[0], total);
+
+    rc = skip_MyMsg(iov_split, 1);
+    assert(rc == len);
+
+    /* Split into 4 byte segments */
+    for (i = 0; i * 4 < total; ++i) {
+        xdr_iovec_set_data(&iov_split[i], wire + i * 4);
+        xdr_iovec_set_len(&iov_split[i], 4);
+    }
+
+    rc = skip_MyMsg(iov_split, i);
+    assert(rc == len);
+
+    /* The second message starts where skipping the first stopped */
+    xdr_iovec_set_data(&iov_split[0], wire + len);
+    xdr_iovec_set_len(&iov_split[0], total - len);
+
+    rc = skip_MyMsg(iov_split, 1);
+    assert(rc == len);
+
+    /* Truncated input fails rather than running off the end */
+    xdr_iovec_set_data(&iov_split[0], wire);
+    xdr_iovec_set_len(&iov_split[0], len - 1);
+
+    rc = skip_MyMsg(iov_split, 1);
+    assert(rc < 0);
+
+    xdr_iovec_set_data(&iov_split[0], wire);
+    xdr_iovec_set_len(&iov_split[0], 24);
+    xdr_iovec_set_data(&iov_split[1], wire + 24);
+    xdr_iovec_set_len(&iov_split[1], len - 25);
+
+    rc = skip_MyMsg(iov_split, 2);
+    assert(rc < 0);
+
+    return 0;
+} /* main */
@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+enum Kind {
+    KIND_VALUE = 1,
+    KIND_NAME  = 2,
+    KIND_NONE  = 3
+};
+
+struct Node {
+    unsigned int value;
+    Node        *next;
+};
+
+struct Pair {
+    unsigned int a;
+    uint64_t     b;
+};
+
+union Choice switch (Kind kind) {
+ case KIND_VALUE:
+    unsigned int value;
+ case KIND_NAME:
+    string name<>;
+ default:
+    void;
+};
+
+opaque_union Wrapped switch (Kind kind) {
+ case KIND_VALUE:
+    Pair pair;
+ case KIND_NAME:
+    opaque raw<>;
+ default:
+    void;
+};
+
+struct MyMsg {
+    unsigned int value;
+    string       name<>;
+    opaque       blob<>;
+    zcopaque     data<>;
+    opaque       fixed[8];
+    Pair         pairs<>;
+    Pair        *maybe;
+    int          words<>;
+    Pair         two[2];
+    Node        *list;
+    Choice       choice;
+    Wrapped      wrapped;
+    unsigned int trailer;
+};
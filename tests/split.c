@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "split_xdr.h"
+
+static void
+check_inner(
+    const struct MyInner *inner,
+    int                   i)
+{
+    assert(inner->value == 100 + i);
+    assert(inner->big == 0x1122334455667788ULL + i);
+    assert(inner->name.len == 5);
+    assert(memcmp(inner->name.str, "inner", 5) == 0);
+} /* check_inner */
+
+static void
+check_msg(const struct MyMsg *msg)
+{
+    uint8_t  data[11];
+    uint32_t off = 0;
+    int      i;
+
+    assert(msg->value == 42);
+    check_inner(&msg->inner, 0);
+
+    assert(msg->blob.len == 6);
+    assert(memcmp(msg->blob.data, "blobby", 6) == 0);
+
+    assert(msg->data.length == 11);
+
+    for (i = 0; i < msg->data.niov; ++i) {
+        memcpy(data + off, xdr_iovec_data(&msg->data.iov[i]), xdr_iovec_len(&msg->data.iov[i]));
+        off += xdr_iovec_len(&msg->data.iov[i]);
+    }
+
+    assert(off == 11);
+
+    for (i = 0; i < 11; ++i) {
+        assert(data[i] == i);
+    }
+
+    assert(msg->num_list == 3);
+
+    for (i = 0; i < 3; ++i) {
+        check_inner(&msg->list[i], i);
+    }
+
+    assert(msg->real == 2.5);
+    assert(msg->num_words == 5);
+
+    for (i = 0; i < 5; ++i) {
+        assert(msg->words[i] == -i);
+    }
+} /* check_msg */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg   msg1, msg2;
+    struct MyInner list[3];
+    xdr_dbuf      *dbuf;
+    uint8_t        buffer[512], wire[512], data[11];
+    int32_t        words[5];
+    xdr_iovec      iov_in, iov_out[8], iov_data, iov_split[3];
+    int            i, rc, len, split, niov_out = 8;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    for (i = 0; i < 11; ++i) {
+        data[i] = i;
+    }
+
+    xdr_iovec_set_data(&iov_data, data);
+    xdr_iovec_set_len(&iov_data, 11);
+
+    for (i = 0; i < 3; ++i) {
+        list[i].value = 100 + i;
+        list[i].big   = 0x1122334455667788ULL + i;
+        xdr_set_str_static(&list[i], name, "inner", 5);
+    }
+
+    for (i = 0; i < 5; ++i) {
+        words[i] = -i;
+    }
+
+    msg1.value = 42;
+    msg1.inner = list[0];
+    msg1.blob.len  = 6;
+    msg1.blob.data = "blobby";
+    xdr_set_ref(&msg1, data, &iov_data, 1, 11);
+    msg1.num_list  = 3;
+    msg1.list      = list;
+    msg1.real      = 2.5;
+    msg1.num_words = 5;
+    msg1.words     = words;
+
+    rc = marshall_MyMsg(&msg1, &iov_in, iov_out, &niov_out, NULL, 0);
+
+    assert(rc > 0);
+
+    len = 0;
+
+    for (i = 0; i < niov_out; ++i) {
+        memcpy(wire + len, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+        len += xdr_iovec_len(&iov_out[i]);
+    }
+
+    assert(len == rc);
+
+    dbuf = xdr_dbuf_alloc(16 * 1024);
+
+    /* Every possible two segment split, with and without an empty
+     * segment in between, must decode to the same message */
+    for (split = 0; split <= len; ++split) {
+
+        xdr_iovec_set_data(&iov_split[0], wire);
+        xdr_iovec_set_len(&iov_split[0], split);
+        xdr_iovec_set_data(&iov_split[1], wire + split);
+        xdr_iovec_set_len(&iov_split[1], len - split);
+
+        xdr_dbuf_reset(dbuf);
+
+        rc = unmarshall_MyMsg(&msg2, iov_split, 2, NULL, dbuf);
+
+        assert(rc == len);
+
+        check_msg(&msg2);
+
+        xdr_iovec_set_data(&iov_split[2], wire + split);
+        xdr_iovec_set_len(&iov_split[2], len - split);
+        xdr_iovec_set_len(&iov_split[1], 0);
+
+        xdr_dbuf_reset(dbuf);
+
+        rc = unmarshall_MyMsg(&msg2, iov_split, 3, NULL, dbuf);
+
+        assert(rc == len);
+
+        check_msg(&msg2);
+
+        /* A message truncated by one byte must fail */
+        if (split < len) {
+            xdr_iovec_set_len(&iov_split[2], len - split - 1);
+
+            xdr_dbuf_reset(dbuf);
+
+            rc = unmarshall_MyMsg(&msg2, iov_split, 3, NULL, dbuf);
+
+            assert(rc < 0);
+        }
+    }
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
@@ -0,0 +1,21 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+struct MyInner {
+    unsigned int value;
+    uint64_t     big;
+    string       name;
+};
+
+struct MyMsg {
+    unsigned int value;
+    MyInner      inner;
+    opaque       blob<>;
+    zcopaque     data<>;
+    MyInner      list<>;
+    double       real;
+    int          words<>;
+};
@@ -0,0 +1,217 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "table_xdr.h"
+
+/* Copy a zero-copy payload out of its iovecs */
+static int
+flatten(
+    const xdr_iovec *iov,
+    int              niov,
+    uint8_t         *out)
+{
+    int i, len = 0;
+
+    for (i = 0; i < niov; ++i) {
+        memcpy(out + len, xdr_iovec_data(&iov[i]), xdr_iovec_len(&iov[i]));
+        len += xdr_iovec_len(&iov[i]);
+    }
+
+    return len;
+} /* flatten */
+
+static void
+check(
+    const struct MyMsg *msg,
+    const struct MyMsg *out)
+{
+    uint8_t a[64], b[64];
+    int     i, len;
+
+    assert(out->i32 == msg->i32);
+    assert(out->u32 == msg->u32);
+    assert(out->i64 == msg->i64);
+    assert(out->u64 == msg->u64);
+    assert(out->f == msg->f);
+    assert(out->d == msg->d);
+    assert(out->flag == msg->flag);
+    assert(out->kind == msg->kind);
+    assert(out->name.len == msg->name.len);
+    assert(memcmp(out->name.str, msg->name.str, msg->name.len) == 0);
+    assert(out->name_hash == xdr_hash(msg->name.str, msg->name.len));
+    assert(out->blob.len == msg->blob.len);
+    assert(memcmp(out->blob.data, msg->blob.data, msg->blob.len) == 0);
+    assert(memcmp(out->tag, msg->tag, sizeof(msg->tag)) == 0);
+
+    len = flatten(msg->data.iov, msg->data.niov, a);
+    assert(out->data.length == msg->data.length);
+    assert(flatten(out->data.iov, out->data.niov, b) == len);
+    assert(memcmp(a, b, len) == 0);
+
+    assert(memcmp(out->fixed, msg->fixed, sizeof(msg->fixed)) == 0);
+    assert(out->num_words == msg->num_words);
+    assert(memcmp(out->words, msg->words, msg->num_words * sizeof(*msg->words)) == 0);
+
+    assert(out->inner.id == msg->inner.id);
+    assert(out->inner.data.length == msg->inner.data.length);
+    assert(out->num_inners == msg->num_inners);
+
+    for (i = 0; i < (int) msg->num_inners; ++i) {
+        assert(out->inners[i].id == msg->inners[i].id);
+        assert(out->inners[i].data.length == msg->inners[i].data.length);
+    }
+
+    assert(!out->extra == !msg->extra);
+    assert(!msg->extra || out->extra->id == msg->extra->id);
+
+    assert(out->list && out->list->next && !out->list->next->next);
+    assert(memcmp(out->list->label.str, "head", 4) == 0);
+    assert(memcmp(out->list->next->label.str, "tail", 4) == 0);
+
+    assert(out->body.kind == msg->body.kind);
+
+    if (msg->body.kind == KIND_NUM) {
+        assert(out->body.num == msg->body.num);
+    } else {
+        assert(out->body.text.len == msg->body.text.len);
+    }
+} /* check */
+
+/* Encode msg, then decode it contiguously and across every split */
+static void
+round_trip(
+    const struct MyMsg *msg,
+    xdr_dbuf           *dbuf)
+{
+    struct MyMsg out;
+    xdr_iovec    iov_in, iov_out[16], iov[2];
+    uint8_t      buffer[1024], wire[1024];
+    int          rc, len, split, niov_out = 16;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    rc = marshall_MyMsg((struct MyMsg *) msg, &iov_in, iov_out, &niov_out, NULL, 0);
+    assert(rc > 0);
+    assert(rc == marshall_length_MyMsg(msg));
+
+    len = flatten(iov_out, niov_out, wire);
+    assert(len == rc);
+
+    for (split = 0; split < len; split++) {
+        xdr_dbuf_reset(dbuf);
+        memset(&out, 0, sizeof(out));
+
+        xdr_iovec_set_data(&iov[0], wire);
+
+        if (split == 0) {
+            xdr_iovec_set_len(&iov[0], len);
+            rc = unmarshall_MyMsg(&out, iov, 1, NULL, dbuf);
+        } else {
+            xdr_iovec_set_len(&iov[0], split);
+            xdr_iovec_set_data(&iov[1], wire + split);
+            xdr_iovec_set_len(&iov[1], len - split);
+            rc = unmarshall_MyMsg(&out, iov, 2, NULL, dbuf);
+        }
+
+        assert(rc == len);
+        check(msg, &out);
+    }
+
+    /* A name longer than its declared bound is refused */
+    wire[47] = 17;
+    xdr_iovec_set_data(&iov[0], wire);
+    xdr_iovec_set_len(&iov[0], len);
+    xdr_dbuf_reset(dbuf);
+    assert(unmarshall_MyMsg(&out, iov, 1, NULL, dbuf) == -1);
+
+    /* As is a truncated message */
+    wire[47] = msg->name.len;
+    xdr_iovec_set_len(&iov[0], len - 4);
+    xdr_dbuf_reset(dbuf);
+    assert(unmarshall_MyMsg(&out, iov, 1, NULL, dbuf) == -1);
+} /* round_trip */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg msg;
+    struct Inner inners[2], extra;
+    struct Node  nodes[2];
+    int32_t      words[3] = { -1, 2, 3 };
+    xdr_dbuf    *dbuf;
+    xdr_iovec    payload[2], small;
+    uint8_t      bytes[64];
+    int          i;
+
+    for (i = 0; i < (int) sizeof(bytes); ++i) {
+        bytes[i] = i;
+    }
+
+    xdr_iovec_set_data(&payload[0], bytes);
+    xdr_iovec_set_len(&payload[0], 40);
+    xdr_iovec_set_data(&payload[1], bytes + 40);
+    xdr_iovec_set_len(&payload[1], 7);
+    xdr_iovec_set_data(&small, bytes + 50);
+    xdr_iovec_set_len(&small, 5);
+
+    dbuf = xdr_dbuf_alloc(64 * 1024);
+
+    memset(&msg, 0, sizeof(msg));
+    msg.i32  = -42;
+    msg.u32  = 0xdeadbeef;
+    msg.i64  = -0x123456789LL;
+    msg.u64  = 0x1122334455667788ULL;
+    msg.f    = 1.5f;
+    msg.d    = -2.25;
+    msg.flag = 1;
+    msg.kind = KIND_NUM;
+    xdr_set_str_static(&msg, name, "table", 5);
+    msg.blob.data = "blob!";
+    msg.blob.len  = 5;
+    memcpy(msg.tag, "tagtag", 6);
+    xdr_set_ref(&msg, data, payload, 2, 47);
+    msg.fixed[0]  = 7;
+    msg.fixed[1]  = 8;
+    msg.fixed[2]  = 9;
+    msg.num_words = 3;
+    msg.words     = words;
+
+    msg.inner.id = 5;
+    xdr_set_ref(&msg.inner, data, &small, 1, 5);
+
+    for (i = 0; i < 2; ++i) {
+        inners[i].id = 10 + i;
+        xdr_set_ref(&inners[i], data, i ? &small : payload, i ? 1 : 2, i ? 5 : 47);
+        xdr_set_str_static(&nodes[i], label, i ? "tail" : "head", 4);
+        nodes[i].next = i ? NULL : &nodes[1];
+    }
+
+    msg.list = nodes;
+
+    msg.body.kind = KIND_NUM;
+    msg.body.num  = 99;
+
+    round_trip(&msg, dbuf);
+
+    /* Now with the optional and vector members populated */
+    msg.num_inners = 2;
+    msg.inners     = inners;
+    extra.id       = 77;
+    xdr_set_ref(&extra, data, &small, 1, 3);
+    msg.extra = &extra;
+
+    msg.body.kind = KIND_TEXT;
+    xdr_set_str_static(&msg.body, text, "text", 4);
+
+    round_trip(&msg, dbuf);
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
@@ -0,0 +1,50 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+enum Kind {
+    KIND_TEXT = 1,
+    KIND_NUM  = 2
+};
+
+struct Inner {
+    unsigned int id;
+    zcopaque     data<>;
+};
+
+struct Node {
+    string       label<>;
+    Node        *next;
+};
+
+union Body switch (Kind kind) {
+ case KIND_TEXT:
+    string text<>;
+ case KIND_NUM:
+    uint64_t num;
+};
+
+struct MyMsg {
+    int          i32;
+    unsigned int u32;
+    int64_t      i64;
+    uint64_t     u64;
+    float        f;
+    double       d;
+    bool         flag;
+    Kind         kind;
+%xdrzcc hash
+    string       name<16>;
+    opaque       blob<>;
+    opaque       tag[6];
+    zcopaque     data<>;
+    int          fixed[3];
+    int          words<8>;
+    Inner        inner;
+    Inner        inners<>;
+    Inner       *extra;
+    Node        *list;
+    Body         body;
+};
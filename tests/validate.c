@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "validate_xdr.h"
+
+#define WIRE_LEN 120
+
+static void
+put32(
+    uint8_t *wire,
+    int      offset,
+    uint32_t value)
+{
+    wire[offset]     = value >> 24;
+    wire[offset + 1] = value >> 16;
+    wire[offset + 2] = value >> 8;
+    wire[offset + 3] = value;
+} /* put32 */
+
+/* Corrupt one word and check validation fails where it was detected */
+static void
+check_reject(
+    const uint8_t *wire,
+    int            offset,
+    uint32_t       value,
+    int            error_offset)
+{
+    uint8_t   bad[WIRE_LEN];
+    xdr_iovec iov;
+    int       rc, where = -1;
+
+    memcpy(bad, wire, WIRE_LEN);
+    put32(bad, offset, value);
+
+    xdr_iovec_set_data(&iov, bad);
+    xdr_iovec_set_len(&iov, WIRE_LEN);
+
+    rc = validate_MyMsg(&iov, 1, &where);
+    assert(rc == -1);
+    assert(where == error_offset);
+} /* check_reject */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg msg, out;
+    struct Pair  pairs[2], maybe;
+    struct Node  node;
+    int32_t      words[3] = { 1, -2, 3 };
+    xdr_dbuf    *dbuf;
+    xdr_iovec    iov_in, iov_out[8], iov_split[2];
+    uint8_t      buffer[512], wire[512];
+    int          i, rc, len, split, where, niov_out = 8;
+
+    memset(&msg, 0, sizeof(msg));
+
+    msg.value = 7;
+    xdr_set_str_static(&msg, name, "hello", 5);
+
+    for (i = 0; i < 2; ++i) {
+        pairs[i].a = i;
+        pairs[i].b = i * 1000;
+    }
+
+    msg.num_pairs = 2;
+    msg.pairs     = pairs;
+    msg.num_words = 3;
+    msg.words     = words;
+    maybe         = pairs[1];
+    msg.maybe     = &maybe;
+    node.value    = 10;
+    node.next     = NULL;
+    msg.list      = &node;
+
+    msg.choice.kind  = KIND_VALUE;
+    msg.choice.value = 99;
+
+    msg.wrapped.kind = KIND_VALUE;
+    msg.wrapped.pair = pairs[0];
+
+    msg.trailer = 0xabcdef01;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    rc = marshall_MyMsg(&msg, &iov_in, iov_out, &niov_out, NULL, 0);
+    assert(rc == WIRE_LEN);
+
+    len = 0;
+
+    for (i = 0; i < niov_out; ++i) {
+        memcpy(wire + len, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+        len += xdr_iovec_len(&iov_out[i]);
+    }
+
+    assert(len == WIRE_LEN);
+
+    /* A well formed message validates to its length however it is split */
+    for (split = 0; split < len; split++) {
+        xdr_iovec_set_data(&iov_split[0], wire);
+
+        if (split == 0) {
+            xdr_iovec_set_len(&iov_split[0], len);
+            rc = validate_MyMsg(iov_split, 1, NULL);
+        } else {
+            xdr_iovec_set_len(&iov_split[0], split);
+            xdr_iovec_set_data(&iov_split[1], wire + split);
+            xdr_iovec_set_len(&iov_split[1], len - split);
+            rc = validate_MyMsg(iov_split, 2, NULL);
+        }
+
+        assert(rc == len);
+    }
+
+    /* Every truncation is rejected within the bytes present */
+    for (split = 0; split < len; split++) {
+        xdr_iovec_set_len(&iov_split[0], split);
+        where = -1;
+        rc    = validate_MyMsg(iov_split, 1, &where);
+        assert(rc == -1);
+        assert(where >= 0 && where <= split);
+    }
+
+    check_reject(wire, 4, MAX_NAME + 1, 8);   /* string over its bound */
+    check_reject(wire, 16, 5, 20);            /* vector over its bound */
+    check_reject(wire, 44, 4, 48);            /* scalar vector over its bound */
+    check_reject(wire, 60, 2, 64);            /* optional marker not a bool */
+    check_reject(wire, 84, 7, 88);            /* list marker not a bool */
+    check_reject(wire, 88, 3, 92);            /* unknown discriminant */
+    check_reject(wire, 100, 16, 116);         /* opaque union body length */
+
+    /* Validation accepts exactly what then decodes */
+    dbuf = xdr_dbuf_alloc(8192);
+
+    xdr_iovec_set_len(&iov_split[0], len);
+    rc = unmarshall_MyMsg(&out, iov_split, 1, NULL, dbuf);
+    assert(rc == len);
+    assert(out.trailer == msg.trailer);
+    assert(out.num_pairs == 2 && out.maybe->b == 1000);
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
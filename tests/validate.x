@@ -0,0 +1,48 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+const MAX_NAME = 16;
+
+enum Kind {
+    KIND_VALUE = 1,
+    KIND_NAME  = 2
+};
+
+struct Node {
+    unsigned int value;
+    Node        *next;
+};
+
+struct Pair {
+    unsigned int a;
+    uint64_t     b;
+};
+
+union Choice switch (Kind kind) {
+ case KIND_VALUE:
+    unsigned int value;
+ case KIND_NAME:
+    string name<MAX_NAME>;
+};
+
+opaque_union Wrapped switch (Kind kind) {
+ case KIND_VALUE:
+    Pair pair;
+ case KIND_NAME:
+    opaque raw<8>;
+};
+
+struct MyMsg {
+    unsigned int value;
+    string       name<MAX_NAME>;
+    Pair         pairs<4>;
+    int          words<3>;
+    Pair        *maybe;
+    Node        *list;
+    Choice       choice;
+    Wrapped      wrapped;
+    unsigned int trailer;
+};
@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "view_xdr.h"
+
+static void
+check_view(
+    xdr_iovec *iov,
+    int        niov,
+    xdr_dbuf  *dbuf)
+{
+    struct MyMsg_view view;
+    struct Stamp_view stamp_view;
+    struct Body_view  body_view;
+    struct Entry_view entry_view;
+    struct MyMsg      msg;
+    struct Stamp      stamp;
+    struct Body       body;
+    struct Entry      entry;
+    int               rc;
+
+    rc = view_MyMsg(&view, iov, niov);
+    assert(rc == 0);
+
+    /* Members after the first variable-length one, in reverse order */
+    rc = view_MyMsg_trailer(&view, &msg, dbuf);
+    assert(rc == 4);
+    assert(msg.trailer == 0xfeedf00d);
+
+    rc = view_MyMsg_blob(&view, &msg, dbuf);
+    assert(rc == 12);
+    assert(msg.blob.len == 5);
+    assert(memcmp(msg.blob.data, "bytes", 5) == 0);
+
+    rc = view_MyMsg_flags(&view, &msg, dbuf);
+    assert(rc == 12);
+    assert(msg.flags[0] == -1 && msg.flags[1] == 0 && msg.flags[2] == 1);
+
+    rc = view_MyMsg_entries(&view, &msg, dbuf);
+    assert(rc > 0);
+    assert(msg.num_entries == 2);
+    assert(msg.entries[1].id == 11);
+    assert(msg.entries[1].name.len == 6);
+    assert(memcmp(msg.entries[1].name.str, "second", 6) == 0);
+
+    /* Fixed-offset prefix */
+    rc = view_MyMsg_xid(&view, &msg, dbuf);
+    assert(rc == 4);
+    assert(msg.xid == 77);
+
+    rc = view_MyMsg_stamp_view(&view, &stamp_view);
+    assert(rc == 0);
+
+    rc = view_Stamp_nseconds(&stamp_view, &stamp, dbuf);
+    assert(rc == 4);
+    assert(stamp.nseconds == 999);
+
+    rc = view_MyMsg_tag(&view, &msg, dbuf);
+    assert(rc == 8);
+    assert(msg.tag.len == 3);
+    assert(memcmp(msg.tag.str, "tag", 3) == 0);
+
+    /* Nested union view */
+    rc = view_MyMsg_body_view(&view, &body_view);
+    assert(rc == 0);
+
+    rc = view_Body_kind(&body_view, &body, dbuf);
+    assert(rc == 4);
+    assert(body.kind == KIND_ENTRY);
+
+    rc = view_Body_stamp(&body_view, &body, dbuf);
+    assert(rc == -1);
+
+    rc = view_Body_entry_view(&body_view, &entry_view);
+    assert(rc == 0);
+
+    rc = view_Entry_id(&entry_view, &entry, dbuf);
+    assert(rc == 4);
+    assert(entry.id == 12);
+
+    rc = view_Body_entry(&body_view, &body, dbuf);
+    assert(rc > 0);
+    assert(body.entry.id == 12);
+    assert(body.entry.name.len == 4);
+    assert(memcmp(body.entry.name.str, "body", 4) == 0);
+} /* check_view */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg msg;
+    struct Entry entries[2];
+    xdr_dbuf    *dbuf;
+    uint8_t      buffer[512], wire[512];
+    xdr_iovec    iov_in, iov_out[8], iov_split[64];
+    int          i, rc, len, niov_out = 8;
+
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    msg.xid            = 77;
+    msg.stamp.seconds  = 1234567890123ULL;
+    msg.stamp.nseconds = 999;
+    xdr_set_str_static(&msg, tag, "tag", 3);
+
+    xdr_set_str_static(&entries[0], name, "first", 5);
+    entries[0].id = 10;
+    xdr_set_str_static(&entries[1], name, "second", 6);
+    entries[1].id = 11;
+
+    msg.num_entries = 2;
+    msg.entries     = entries;
+    msg.flags[0]    = -1;
+    msg.flags[1]    = 0;
+    msg.flags[2]    = 1;
+
+    msg.body.kind = KIND_ENTRY;
+    xdr_set_str_static(&msg.body.entry, name, "body", 4);
+    msg.body.entry.id = 12;
+
+    msg.blob.data = "bytes";
+    msg.blob.len  = 5;
+    msg.trailer   = 0xfeedf00d;
+
+    rc = marshall_MyMsg(&msg, &iov_in, iov_out, &niov_out, NULL, 0);
+
+    assert(rc > 0);
+
+    len = rc;
+
+    assert(niov_out == 1);
+
+    memcpy(wire, xdr_iovec_data(&iov_out[0]), len);
+
+    dbuf = xdr_dbuf_alloc(16 * 1024);
+
+    /* One contiguous buffer */
+    xdr_iovec_set_data(&iov_split[0], wire);
+    xdr_iovec_set_len(&iov_split[0], len);
+
+    check_view(iov_split, 1, dbuf);
+
+    /* Every value split across 4 byte segments */
+    for (i = 0; i * 4 < len; ++i) {
+        xdr_iovec_set_data(&iov_split[i], wire + i * 4);
+        xdr_iovec_set_len(&iov_split[i], 4);
+    }
+
+    check_view(iov_split, i, dbuf);
+
+    /* Reading past the end of a truncated message fails */
+    xdr_iovec_set_data(&iov_split[0], wire);
+    xdr_iovec_set_len(&iov_split[0], len - 4);
+
+    {
+        struct MyMsg_view view;
+
+        rc = view_MyMsg(&view, iov_split, 1);
+        assert(rc == 0);
+
+        rc = view_MyMsg_xid(&view, &msg, dbuf);
+        assert(rc == 4);
+
+        rc = view_MyMsg_trailer(&view, &msg, dbuf);
+        assert(rc < 0);
+    }
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
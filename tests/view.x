@@ -0,0 +1,41 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+enum Kind {
+    KIND_STAMP = 1,
+    KIND_ENTRY = 2,
+    KIND_NONE  = 3
+};
+
+struct Stamp {
+    uint64_t     seconds;
+    unsigned int nseconds;
+};
+
+struct Entry {
+    string       name<>;
+    unsigned int id;
+};
+
+union Body switch (Kind kind) {
+ case KIND_STAMP:
+    Stamp stamp;
+ case KIND_ENTRY:
+    Entry entry;
+ default:
+    void;
+};
+
+struct MyMsg {
+    unsigned int xid;
+    Stamp        stamp;
+    string       tag<>;
+    Entry        entries<>;
+    int          flags[3];
+    Body         body;
+    opaque       blob<>;
+    unsigned int trailer;
+};
@@ -0,0 +1,168 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "write_refill_xdr.h"
+
+#define NUM_ENTRIES 20
+#define NUM_VALUES  100
+#define SCRATCH     64
+#define MAX_SCRATCH 64
+
+struct refill_state {
+    xdr_iovec  scratch_iov[MAX_SCRATCH];
+    void      *scratch[MAX_SCRATCH];
+    int        nscratch;
+    xdr_iovec *iov;
+    int        calls;
+};
+
+static int
+test_refill(
+    struct xdr_write_cursor *cursor,
+    unsigned int             bytes,
+    int                      iovs,
+    void                    *private_data)
+{
+    struct refill_state *state = private_data;
+    xdr_iovec           *iov;
+    int                  size, maxiov;
+
+    state->calls++;
+
+    if (cursor->maxiov - cursor->niov < iovs) {
+        maxiov = (cursor->niov + iovs) * 2;
+        iov    = malloc(maxiov * sizeof(*iov));
+
+        if (xdr_write_cursor_set_iov(cursor, iov, maxiov) < 0) {
+            return -1;
+        }
+
+        free(state->iov);
+        state->iov = iov;
+    }
+
+    if (bytes) {
+        if (state->nscratch == MAX_SCRATCH) {
+            return -1;
+        }
+
+        size = bytes > SCRATCH ? bytes : SCRATCH;
+
+        state->scratch[state->nscratch] = malloc(size);
+
+        xdr_iovec_set_data(&state->scratch_iov[state->nscratch], state->scratch[state->nscratch]);
+        xdr_iovec_set_len(&state->scratch_iov[state->nscratch], size);
+
+        if (xdr_write_cursor_set_scratch(cursor, &state->scratch_iov[state->nscratch]) < 0) {
+            return -1;
+        }
+
+        state->nscratch++;
+    }
+
+    return 0;
+} /* test_refill */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg            msg;
+    struct MyEntry          entries[NUM_ENTRIES];
+    struct refill_state     state;
+    struct xdr_write_cursor cursor;
+    uint64_t                values[NUM_VALUES];
+    uint8_t                 data[100], buffer[8192], reference[8192], wire[8192], small[SCRATCH];
+    xdr_iovec               iov_in, iov_out[64], iov_data, iov_small, iov_first[2];
+    int                     i, rc, len, off, niov = 64;
+
+    for (i = 0; i < 100; ++i) {
+        data[i] = i;
+    }
+
+    xdr_iovec_set_data(&iov_data, data);
+    xdr_iovec_set_len(&iov_data, sizeof(data));
+
+    for (i = 0; i < NUM_ENTRIES; ++i) {
+        entries[i].id = i;
+        xdr_set_str_static(&entries[i], name, "entry_name", 5 + i % 6);
+        xdr_set_ref(&entries[i], data, &iov_data, 1, 1 + i * 3);
+    }
+
+    for (i = 0; i < NUM_VALUES; ++i) {
+        values[i] = i * 7;
+    }
+
+    msg.num_entries = NUM_ENTRIES;
+    msg.entries     = entries;
+    msg.num_values  = NUM_VALUES;
+    msg.values      = values;
+
+    /* Reference encoding with ample space */
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    len = marshall_MyMsg(&msg, &iov_in, iov_out, &niov, NULL, 0);
+
+    assert(len > 0);
+
+    for (i = 0, off = 0; i < niov; ++i) {
+        memcpy(reference + off, xdr_iovec_data(&iov_out[i]), xdr_iovec_len(&iov_out[i]));
+        off += xdr_iovec_len(&iov_out[i]);
+    }
+
+    assert(off == len);
+
+    /* Without a refill callback the small buffers are insufficient */
+    xdr_iovec_set_data(&iov_small, small);
+    xdr_iovec_set_len(&iov_small, sizeof(small));
+
+    niov = 2;
+    rc   = marshall_MyMsg(&msg, &iov_small, iov_first, &niov, NULL, 0);
+
+    assert(rc < 0);
+
+    /* With refill the message is produced in one pass */
+    memset(&state, 0, sizeof(state));
+
+    xdr_iovec_set_data(&iov_small, small);
+    xdr_iovec_set_len(&iov_small, sizeof(small));
+
+    xdr_write_cursor_init(&cursor, &iov_small, iov_first, 2, NULL, 0);
+    xdr_write_cursor_set_refill(&cursor, test_refill, &state);
+
+    rc = marshall_MyMsg_cursor(&msg, &cursor);
+
+    assert(rc == 0);
+
+    rc = xdr_write_cursor_finish(&cursor);
+
+    assert(rc == len);
+    assert(state.calls > 0);
+    assert(state.nscratch > 0);
+    assert(cursor.iov == state.iov);
+
+    for (i = 0, off = 0; i < cursor.niov; ++i) {
+        memcpy(wire + off, xdr_iovec_data(&cursor.iov[i]), xdr_iovec_len(&cursor.iov[i]));
+        off += xdr_iovec_len(&cursor.iov[i]);
+    }
+
+    assert(off == len);
+    assert(memcmp(wire, reference, len) == 0);
+
+    /* Each scratch iovec reports the bytes consumed from it */
+    assert(xdr_iovec_len(&iov_small) <= SCRATCH);
+
+    for (i = 0; i < state.nscratch; ++i) {
+        assert(xdr_iovec_len(&state.scratch_iov[i]) > 0);
+        free(state.scratch[i]);
+    }
+
+    free(state.iov);
+
+    return 0;
+} /* main */
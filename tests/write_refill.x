@@ -0,0 +1,16 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+struct MyEntry {
+    unsigned int id;
+    string       name;
+    zcopaque     data<>;
+};
+
+struct MyMsg {
+    MyEntry      entries<>;
+    uint64_t     values<>;
+};
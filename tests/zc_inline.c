@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+//
+// SPDX-License-Identifier: LGPL-2.1-only
+
+#include <assert.h>
+
+#include "zc_inline_xdr.h"
+
+static void
+check_opaque(
+    const xdr_iovecr *v,
+    const uint8_t    *data,
+    uint32_t          length)
+{
+    uint32_t off = 0;
+    int      i;
+
+    assert(v->length == length);
+
+    for (i = 0; i < v->niov; ++i) {
+        assert(memcmp(xdr_iovec_data(&v->iov[i]), data + off, xdr_iovec_len(&v->iov[i])) == 0);
+        off += xdr_iovec_len(&v->iov[i]);
+    }
+
+    assert(off == length);
+} /* check_opaque */
+
+int
+main(
+    int   argc,
+    char *argv[])
+{
+    struct MyMsg            msg1, msg2;
+    struct xdr_write_cursor cursor;
+    xdr_dbuf               *dbuf;
+    uint8_t                 buffer[1024], data[256];
+    xdr_iovec               iov_in, iov_out[16], iov_data[2];
+    int                     i, rc, len, niov = 16;
+
+    for (i = 0; i < 256; ++i) {
+        data[i] = i;
+    }
+
+    /* small2 spans two source iovecs */
+    xdr_iovec_set_data(&iov_data[0], data);
+    xdr_iovec_set_len(&iov_data[0], 5);
+    xdr_iovec_set_data(&iov_data[1], data + 5);
+    xdr_iovec_set_len(&iov_data[1], 251);
+
+    xdr_set_ref(&msg1, small1, &iov_data[1], 1, 3);
+    msg1.value = 7;
+    xdr_set_ref(&msg1, small2, &iov_data[0], 2, 9);
+    xdr_set_ref(&msg1, large, &iov_data[1], 1, 200);
+    xdr_set_ref(&msg1, small3, &iov_data[1], 1, 12);
+
+    len = 4 + 4 + 4 + 4 + 12 + 4 + 200 + 4 + 12;
+
+    dbuf = xdr_dbuf_alloc(16 * 1024);
+
+    /* By default every zcopaque is emitted by reference */
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    rc = marshall_MyMsg(&msg1, &iov_in, iov_out, &niov, NULL, 0);
+
+    assert(rc == len);
+    assert(niov > 3);
+
+    /* With a threshold only the large payload breaks the scratch run */
+    xdr_iovec_set_data(&iov_in, buffer);
+    xdr_iovec_set_len(&iov_in, sizeof(buffer));
+
+    xdr_write_cursor_init(&cursor, &iov_in, iov_out, 16, NULL, 0);
+    xdr_write_cursor_set_zc_inline(&cursor, 64);
+
+    rc = marshall_MyMsg_cursor(&msg1, &cursor);
+
+    assert(rc == 0);
+
+    rc = xdr_write_cursor_finish(&cursor);
+
+    assert(rc == len);
+    assert(cursor.niov == 3);
+    assert(xdr_iovec_data(&iov_out[1]) == data + 5);
+    assert(xdr_iovec_len(&iov_out[1]) == 200);
+
+    rc = unmarshall_MyMsg(&msg2, iov_out, cursor.niov, NULL, dbuf);
+
+    assert(rc == len);
+    assert(msg2.value == 7);
+
+    check_opaque(&msg2.small1, data + 5, 3);
+    check_opaque(&msg2.small2, data, 9);
+    check_opaque(&msg2.large, data + 5, 200);
+    check_opaque(&msg2.small3, data + 5, 12);
+
+    xdr_dbuf_free(dbuf);
+
+    return 0;
+} /* main */
@@ -0,0 +1,13 @@
+/*
+ * SPDX-FileCopyrightText: 2024 - 2025 Ben Jarvis
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ */
+
+struct MyMsg {
+    zcopaque     small1<>;
+    unsigned int value;
+    zcopaque     small2<>;
+    zcopaque     large<>;
+    zcopaque     small3<>;
+};